@@ -0,0 +1,181 @@
+/*
+  Micro benchmark suite
+
+  Build (native):
+  g++ -std=c++11 -O2 -I../src -I. bench*.cpp ../src/gob_*.cpp -lpthread (Except bench_task_tree.cpp)
+  or
+  pio run -e bench_native && .pio/build/bench_native/program [filter]
+
+  On device (ESP32):
+  pio run -e bench_esp32 -t upload && pio device monitor -e bench_esp32
+*/
+#include "bench.hpp"
+#include <gob_cycle_clock.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#if defined(GOBLIB_ENABLE_PROFILE)
+# include <gob_alloc_tracker.hpp>
+#endif
+#if defined(ARDUINO)
+# include <Arduino.h>
+#endif
+
+namespace
+{
+#if !defined(GOBLIB_ENABLE_PROFILE)
+std::atomic<std::uint64_t> allocCount(0), allocBytes(0);
+#endif
+
+struct Case
+{
+    const char* name;
+    bench::Function func;
+    std::size_t param;
+};
+std::vector<Case>& cases()
+{
+    static std::vector<Case> v;
+    return v;
+}
+
+#if defined(ARDUINO)
+constexpr std::uint64_t TARGET_NS = 50 * 1000 * 1000ULL;
+#else
+constexpr std::uint64_t TARGET_NS = 200 * 1000 * 1000ULL;
+#endif
+constexpr std::size_t MAX_ITERATIONS = 1U << 30;
+
+std::uint64_t nowNs()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#if !defined(GOBLIB_ENABLE_PROFILE) || defined(GOBLIB_ALLOC_TRACKER_NO_REPLACE)
+void* allocate(const std::size_t sz)
+{
+#if defined(GOBLIB_ENABLE_PROFILE)
+    goblib::profile::AllocTracker::onAllocate(sz);
+#else
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(sz, std::memory_order_relaxed);
+#endif
+    void* p = std::malloc(sz ? sz : 1);
+    if(!p) { std::abort(); }
+    return p;
+}
+void deallocate(void* p)
+{
+#if defined(GOBLIB_ENABLE_PROFILE)
+    if(p) { goblib::profile::AllocTracker::onDeallocate(); }
+#endif
+    std::free(p);
+}
+#endif
+//
+}
+
+// Count all allocations by global operator new.
+// If GOBLIB_ENABLE_PROFILE defined, gob_alloc_tracker.cpp replaces them and AllocTracker counts.
+#if !defined(GOBLIB_ENABLE_PROFILE) || defined(GOBLIB_ALLOC_TRACKER_NO_REPLACE)
+void* operator new(std::size_t sz) { return allocate(sz); }
+void* operator new[](std::size_t sz) { return allocate(sz); }
+void* operator new(std::size_t sz, const std::nothrow_t&) noexcept { return allocate(sz); }
+void* operator new[](std::size_t sz, const std::nothrow_t&) noexcept { return allocate(sz); }
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+#endif
+
+namespace bench
+{
+
+#if defined(GOBLIB_ENABLE_PROFILE)
+std::uint64_t allocations() { return goblib::profile::AllocTracker::instance().allocations(); }
+std::uint64_t allocatedBytes() { return goblib::profile::AllocTracker::instance().allocatedBytes(); }
+#else
+std::uint64_t allocations() { return allocCount.load(std::memory_order_relaxed); }
+std::uint64_t allocatedBytes() { return allocBytes.load(std::memory_order_relaxed); }
+#endif
+
+void Context::start()
+{
+    _running = true;
+    _a0 = allocations();
+    _b0 = allocatedBytes();
+    _t0 = nowNs();
+    _c0 = goblib::CycleClock::cycles();
+}
+
+void Context::stop()
+{
+    const std::uint64_t c1 = goblib::CycleClock::cycles();
+    const std::uint64_t t1 = nowNs();
+    if(!_running) { return; }
+    _cycles += c1 - _c0;
+    _ns += t1 - _t0;
+    _allocs += allocations() - _a0;
+    _allocBytes += allocatedBytes() - _b0;
+    _running = false;
+}
+
+Register::Register(const char* name, Function func, std::initializer_list<std::size_t> params)
+{
+    for(auto& p : params) { cases().push_back(Case{ name, func, p }); }
+}
+
+void run(const char* filter)
+{
+    for(auto& c : cases())
+    {
+        if(filter && *filter && !std::strstr(c.name, filter)) { continue; }
+
+        // Grow iterations until measuring time reaches the target.
+        std::size_t n = 1;
+        for(;;)
+        {
+            Context ctx(c.param, n);
+            c.func(ctx);
+            ctx.stop();
+            if(ctx._ns >= TARGET_NS || n >= MAX_ITERATIONS)
+            {
+                const double ops = static_cast<double>(n);
+                std::printf("{\"bench\":\"%s\",\"param\":%zu,\"ops\":%zu,\"ns_per_op\":%.3f,\"cycles_per_op\":%.3f,"
+                            "\"allocs_per_op\":%.4f,\"bytes_alloc_per_op\":%.2f,\"bytes_per_op\":%zu,\"hardware_cycles\":%s}\n",
+                            c.name, c.param, n, ctx._ns / ops, ctx._cycles / ops,
+                            ctx._allocs / ops, ctx._allocBytes / ops, ctx._bytes,
+                            goblib::CycleClock::hardware() ? "true" : "false");
+                std::fflush(stdout);
+                break;
+            }
+            // Estimate from elapsed time (at least double, at most x100).
+            const std::uint64_t ns = ctx._ns ? ctx._ns : 1;
+            std::uint64_t next = static_cast<std::uint64_t>(n) * TARGET_NS / ns + 1;
+            next = next < n * 2ULL ? n * 2ULL : (next > n * 100ULL ? n * 100ULL : next);
+            n = static_cast<std::size_t>(next < MAX_ITERATIONS ? next : MAX_ITERATIONS);
+        }
+    }
+}
+//
+}
+
+#if defined(ARDUINO)
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+    bench::run();
+}
+void loop() { delay(1000); }
+#else
+int main(int argc, char* argv[])
+{
+    bench::run(argc > 1 ? argv[1] : nullptr);
+    return 0;
+}
+#endif
@@ -0,0 +1,79 @@
+/*
+  Micro benchmark harness
+
+  Each case is measured by CycleClock and steady_clock, and allocations are counted by replaced global operator new.
+  Results are printed as JSON lines. (One object per case)
+  {"bench":"task_tree_pump","param":1000,"ops":...,"ns_per_op":...,"cycles_per_op":...,"allocs_per_op":...,"bytes_alloc_per_op":...,"bytes_per_op":...}
+*/
+#pragma once
+#ifndef GOBLIB_BENCH_HPP
+#define GOBLIB_BENCH_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <initializer_list>
+
+namespace bench
+{
+
+/*! @brief Measuring context passed to case */
+class Context
+{
+  public:
+    explicit Context(std::size_t param, std::size_t iterations)
+            : _param(param), _iterations(iterations), _bytes(0)
+            , _cycles(0), _ns(0), _allocs(0), _allocBytes(0), _c0(0), _t0(0), _a0(0), _b0(0), _running(false)
+    {}
+
+    /*! @brief Parameter of case (e.g. number of tasks) */
+    std::size_t param() const { return _param; }
+    /*! @brief Number of operations to run between start() and stop() */
+    std::size_t iterations() const { return _iterations; }
+    /*! @brief Bytes processed per operation (For throughput) */
+    void setBytesPerOp(std::size_t b) { _bytes = b; }
+
+    /// @name Measuring region (Setup outside is not measured)
+    /// @{
+    void start();
+    void stop();
+    /// @}
+
+  private:
+    friend void run(const char* filter);
+    std::size_t _param, _iterations, _bytes;
+    std::uint64_t _cycles, _ns, _allocs, _allocBytes;
+    std::uint64_t _c0, _t0, _a0, _b0;
+    bool _running;
+};
+
+using Function = void(*)(Context&);
+
+/*! @brief Register case (Use static instance) */
+struct Register
+{
+    Register(const char* name, Function func, std::initializer_list<std::size_t> params = { 0 });
+};
+
+/*! @brief Prevent value from being optimized away */
+template<typename T> inline void doNotOptimize(const T& v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ volatile("" : : "g"(&v) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &v;
+#endif
+}
+
+/*! @brief Run cases whose name contains filter (nullptr: all) */
+void run(const char* filter = nullptr);
+
+/// @name Allocation counter
+/// @{
+std::uint64_t allocations();
+std::uint64_t allocatedBytes();
+/// @}
+//
+}
+#endif
@@ -0,0 +1,63 @@
+/*
+  Benchmark of animation
+*/
+#include "bench.hpp"
+#include <gob_animation.hpp>
+#include <vector>
+#include <memory>
+
+namespace
+{
+using goblib::graph::Sequence;
+
+const Sequence program[] =
+{
+    Sequence(Sequence::LoopS, std::uint8_t(3)),
+    Sequence(Sequence::Draw, std::uint8_t(0), std::uint8_t(4)),
+    Sequence(Sequence::Offset, std::int16_t(1), std::int16_t(-1)),
+    Sequence(Sequence::Draw, std::uint8_t(1), std::uint8_t(4), std::uint8_t(1)),
+    Sequence(Sequence::LoopE),
+    Sequence(Sequence::Draw, std::uint8_t(2), std::uint8_t(8)),
+    Sequence(Sequence::Goto, std::uint8_t(0)),
+};
+
+// op: One pump of one sequencer
+void sequencer(bench::Context& c)
+{
+    std::vector<std::unique_ptr<goblib::graph::AnimationSequencer>> v;
+    for(std::size_t i = 0; i < c.param(); ++i)
+    {
+        v.emplace_back(new goblib::graph::AnimationSequencer(program, sizeof(program) / sizeof(program[0])));
+    }
+    std::uint32_t sum = 0;
+
+    c.start();
+    for(std::size_t it = 0; it < c.iterations();)
+    {
+        for(auto& s : v) { s->pump(); sum += s->cell(); }
+        it += v.size();
+    }
+    c.stop();
+    bench::doNotOptimize(sum);
+}
+
+// op: One pump of one instance in AnimationSet
+void set(bench::Context& c)
+{
+    goblib::graph::AnimationSequencer seq(program, sizeof(program) / sizeof(program[0]));
+    goblib::graph::AnimationTimeline tl(seq);
+    goblib::graph::AnimationSet as(&tl, c.param());
+
+    c.start();
+    for(std::size_t it = 0; it < c.iterations();)
+    {
+        as.pump();
+        it += c.param();
+    }
+    c.stop();
+}
+
+bench::Register r0("animation_sequencer_pump", sequencer, { 1, 256 });
+bench::Register r1("animation_set_pump", set, { 256 });
+//
+}
@@ -0,0 +1,79 @@
+/*
+  Benchmark of FixedPointNumber and easing
+*/
+#include "bench.hpp"
+#include <gob_fixed_point_number.hpp>
+#include <gob_easing.hpp>
+#include <vector>
+
+namespace
+{
+using Fixed = goblib::FixedPointNumber<std::int32_t, 16>;
+
+// op: a = a * b + c, a / b of one element
+template<typename T> void arithmetic(bench::Context& c)
+{
+    const std::size_t n = c.param();
+    std::vector<T> a(n), b(n), d(n);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        a[i] = T(0.5f + static_cast<float>(i % 7) * 0.125f);
+        b[i] = T(1.0f + static_cast<float>(i % 5) * 0.25f);
+        d[i] = T(0.0f);
+    }
+    const T k(0.75f);
+
+    c.start();
+    for(std::size_t it = 0; it < c.iterations();)
+    {
+        for(std::size_t i = 0; i < n; ++i) { d[i] = a[i] * b[i] + k - a[i] / b[i]; }
+        bench::doNotOptimize(d.front());
+        it += n;
+    }
+    c.stop();
+}
+
+// op: One evaluation of easing function
+template<class F> void easing(bench::Context& c)
+{
+    const F f{};
+    float sum = 0.0f;
+    const float step = 1.0f / 1024.0f;
+    float t = 0.0f;
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i)
+    {
+        sum += f(t);
+        t += step;
+        if(t > 1.0f) { t = 0.0f; }
+    }
+    c.stop();
+    bench::doNotOptimize(sum);
+}
+
+// op: One pump of Easing
+void easingPump(bench::Context& c)
+{
+    goblib::easing::Easing<float, goblib::easing::easing_cubic_inout> e;
+    float sum = 0.0f;
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i)
+    {
+        if(!e.busy()) { e.start(0.0f, 100.0f, 60); }
+        e.pump();
+        sum += e.value();
+    }
+    c.stop();
+    bench::doNotOptimize(sum);
+}
+
+bench::Register r0("arithmetic_float", arithmetic<float>, { 1024 });
+bench::Register r1("arithmetic_fixed_q16", arithmetic<Fixed>, { 1024 });
+bench::Register r2("easing_cubic_inout", easing<goblib::easing::easing_cubic_inout>);
+bench::Register r3("easing_elastic_out", easing<goblib::easing::easing_elastic_out>);
+bench::Register r4("easing_table_elastic_out", easing<goblib::easing::EasingTable<goblib::easing::easing_elastic_out>>);
+bench::Register r5("easing_pump", easingPump);
+//
+}
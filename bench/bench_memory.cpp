@@ -0,0 +1,71 @@
+/*
+  Benchmark of ObjectPool and RingBuffer
+*/
+#include "bench.hpp"
+#include <gob_object_pool.hpp>
+#include <gob_ring_buffer.hpp>
+#include <vector>
+
+namespace
+{
+struct Particle
+{
+    Particle(float x, float y) : px(x), py(y), vx(0), vy(0) {}
+    float px, py, vx, vy;
+};
+
+// op: construct and destruct of one object (param objects alive at once)
+void objectPool(bench::Context& c)
+{
+    goblib::ObjectPool<Particle> pool(c.param());
+    std::vector<Particle*> v(c.param(), nullptr);
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations();)
+    {
+        for(auto& p : v) { p = pool.construct(1.0f, 2.0f); }
+        for(auto& p : v) { pool.destruct(p); }
+        i += v.size();
+    }
+    c.stop();
+    bench::doNotOptimize(v.front());
+}
+
+// op: push_back and pop_front of one element
+void ringBufferPushPop(bench::Context& c)
+{
+    goblib::RingBuffer<std::uint32_t, 256> rb;
+    std::uint32_t sum = 0;
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i)
+    {
+        rb.push_back(static_cast<std::uint32_t>(i));
+        if(rb.size() > 128) { sum += rb.front(); rb.pop_front(); }
+    }
+    c.stop();
+    bench::doNotOptimize(sum);
+}
+
+// op: write and read of param elements
+void ringBufferBulk(bench::Context& c)
+{
+    goblib::RingBuffer<std::int16_t, 4096> rb;
+    std::vector<std::int16_t> in(c.param(), 1), out(c.param());
+    c.setBytesPerOp(c.param() * sizeof(std::int16_t));
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i)
+    {
+        rb.write(in.data(), in.size());
+        rb.read(out.data(), out.size());
+    }
+    c.stop();
+    bench::doNotOptimize(out.front());
+}
+
+bench::Register r0("object_pool_construct_destruct", objectPool, { 64, 1024 });
+bench::Register r1("ring_buffer_push_pop", ringBufferPushPop);
+bench::Register r2("ring_buffer_write_read", ringBufferBulk, { 256, 2048 });
+//
+}
@@ -0,0 +1,86 @@
+/*
+  Benchmark of PcmStream
+*/
+#include "bench.hpp"
+#include <gob_pcm_stream.hpp>
+#include <gob_memory_stream.hpp>
+#include <vector>
+#include <cstring>
+
+namespace
+{
+template<typename T> void put(std::vector<std::uint8_t>& v, const T x)
+{
+    const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(&x);
+    v.insert(v.end(), p, p + sizeof(T));
+}
+
+// 16bit stereo 44.1kHz
+std::vector<std::uint8_t> makeWave(const std::uint32_t dataSize)
+{
+    std::vector<std::uint8_t> v;
+    put<std::uint32_t>(v, 0x46464952); // "RIFF"
+    put<std::uint32_t>(v, 4 + 8 + 16 + 8 + dataSize);
+    put<std::uint32_t>(v, 0x45564157); // "WAVE"
+    put<std::uint32_t>(v, 0x20746d66); // "fmt "
+    put<std::uint32_t>(v, 16);
+    put<std::uint16_t>(v, 1);
+    put<std::uint16_t>(v, 2);
+    put<std::uint32_t>(v, 44100);
+    put<std::uint32_t>(v, 44100 * 4);
+    put<std::uint16_t>(v, 4);
+    put<std::uint16_t>(v, 16);
+    put<std::uint32_t>(v, 0x61746164); // "data"
+    put<std::uint32_t>(v, dataSize);
+    for(std::uint32_t i = 0; i < dataSize; ++i) { v.push_back(static_cast<std::uint8_t>(i * 7)); }
+    return v;
+}
+
+// op: One block read (param: block size)
+void read(bench::Context& c)
+{
+    const std::vector<std::uint8_t> wav = makeWave(64 * 1024);
+    goblib::MemoryStream ms(wav.data(), wav.size());
+    goblib::PcmStream pcm(&ms);
+    if(!pcm.valid()) { return; }
+    std::vector<std::uint8_t> buf(c.param());
+    std::size_t total = 0;
+    c.setBytesPerOp(c.param());
+
+    pcm.rewind();
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i)
+    {
+        if(pcm.is_tail()) { pcm.rewind(); }
+        total += pcm.read(buf.data(), buf.size());
+    }
+    c.stop();
+    bench::doNotOptimize(total);
+}
+
+// op: One zero-copy block view (param: block size)
+void view(bench::Context& c)
+{
+    const std::vector<std::uint8_t> wav = makeWave(64 * 1024);
+    goblib::MemoryStream ms(wav.data(), wav.size());
+    goblib::PcmStream pcm(&ms);
+    if(!pcm.valid()) { return; }
+    std::uint32_t sum = 0;
+    c.setBytesPerOp(c.param());
+
+    pcm.rewind();
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i)
+    {
+        if(pcm.is_tail()) { pcm.rewind(); }
+        auto v = pcm.view(c.param());
+        sum += v.size ? v.data[0] : 0;
+    }
+    c.stop();
+    bench::doNotOptimize(sum);
+}
+
+bench::Register r0("pcm_stream_read", read, { 512, 4096 });
+bench::Register r1("pcm_stream_view", view, { 512, 4096 });
+//
+}
@@ -0,0 +1,67 @@
+/*
+  Benchmark of Renderer2D
+*/
+#include "bench.hpp"
+#include <gob_renderer.hpp>
+#include <vector>
+#include <random>
+#include <memory>
+
+namespace
+{
+class Sprite : public goblib::graph::RenderObj2D
+{
+  public:
+    explicit Sprite(OrderType z) : goblib::graph::RenderObj2D(z), drawn(0) {}
+    virtual void render(void* /*arg*/) override { ++drawn; }
+    std::uint32_t drawn;
+};
+
+struct Scene
+{
+    explicit Scene(const std::size_t n) : renderer(n), sprites()
+    {
+        std::mt19937 rng(52);
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            sprites.emplace_back(new Sprite(rng() % 64));
+            renderer.insert(sprites.back().get());
+        }
+    }
+    goblib::graph::Renderer2D renderer;
+    std::vector<std::unique_ptr<Sprite>> sprites;
+};
+
+// op: Change zorder of 1/16 objects and zsort (force)
+void zsort(bench::Context& c)
+{
+    Scene s(c.param());
+    std::mt19937 rng(1);
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i)
+    {
+        for(std::size_t k = 0; k < s.sprites.size() / 16 + 1; ++k)
+        {
+            s.renderer.changeZorder(s.sprites[rng() % s.sprites.size()].get(), rng() % 64);
+        }
+        s.renderer.zsort(true);
+    }
+    c.stop();
+}
+
+// op: One render of all objects
+void render(bench::Context& c)
+{
+    Scene s(c.param());
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i) { s.renderer.render(nullptr); }
+    c.stop();
+    bench::doNotOptimize(s.sprites.front()->drawn);
+}
+
+bench::Register r0("renderer2d_zsort", zsort, { 64, 1024 });
+bench::Register r1("renderer2d_render", render, { 64, 1024 });
+//
+}
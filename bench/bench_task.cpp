@@ -0,0 +1,76 @@
+/*
+  Benchmark of TaskTree and FamilyTree
+*/
+#include "bench.hpp"
+#include <gob_task.hpp>
+#include <gob_flat_task.hpp>
+#include <random>
+#include <vector>
+#include <memory>
+
+namespace
+{
+class BenchTask : public goblib::Task
+{
+  public:
+    explicit BenchTask(PriorityType pri) : goblib::Task(pri, "bench"), counter(0) {}
+    std::uint32_t counter;
+  protected:
+    virtual void onExecute(const float /*delta*/) override { ++counter; }
+};
+
+// 1/8 are children of root, others are children of earlier task.
+template<class Tree> void build(Tree& tree, std::vector<std::unique_ptr<BenchTask>>& tasks, const std::size_t num)
+{
+    std::mt19937 rng(52);
+    tasks.clear();
+    for(std::size_t i = 0; i < num; ++i)
+    {
+        tasks.emplace_back(new BenchTask(static_cast<goblib::Task::PriorityType>(rng() % 16)));
+        BenchTask* parent = (i < 8 || (rng() & 7) == 0) ? nullptr : tasks[rng() % (tasks.size() - 1)].get();
+        tree.insertNode(tasks.back().get(), parent);
+    }
+}
+
+// op: One pump of whole tree
+template<class Tree> void pump(bench::Context& c)
+{
+    Tree tree;
+    std::vector<std::unique_ptr<BenchTask>> tasks;
+    build(tree, tasks, c.param());
+    tree.pump(); // Initialize
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i) { tree.pump(); }
+    c.stop();
+    bench::doNotOptimize(tasks.front()->counter);
+    tree.clear();
+}
+
+// op: Insert param nodes and remove them (wave of spawn and despawn)
+void insertRemove(bench::Context& c)
+{
+    goblib::TaskTree<goblib::Task> tree;
+    std::vector<std::unique_ptr<BenchTask>> resident, wave;
+    build(tree, resident, 64);
+    std::mt19937 rng(1);
+    for(std::size_t i = 0; i < c.param(); ++i) { wave.emplace_back(new BenchTask(static_cast<goblib::Task::PriorityType>(rng() % 16))); }
+
+    c.start();
+    for(std::size_t i = 0; i < c.iterations(); ++i)
+    {
+        for(auto& t : wave) { tree.reserveInsertNode(t.get(), resident[rng() % resident.size()].get()); }
+        tree.insertReservedNodes();
+        for(auto& t : wave) { t->kill(); }
+        tree.remove_if([](const goblib::Task* t) { return t->isKill(); });
+        for(auto& t : wave) { t->initialize(); }
+    }
+    c.stop();
+    tree.clear();
+}
+
+bench::Register r0("task_tree_pump", pump<goblib::TaskTree<goblib::Task>>, { 100, 1000, 10000 });
+bench::Register r1("flat_task_tree_pump", pump<goblib::FlatTaskTree<goblib::Task>>, { 100, 1000, 10000 });
+bench::Register r2("family_tree_insert_remove_wave", insertRemove, { 16, 256 });
+//
+}
@@ -0,0 +1,72 @@
+/*
+  Benchmark TaskTree vs FlatTaskTree
+
+  Build (native):
+  g++ -std=c++11 -O2 -I../src bench_task_tree.cpp ../src/gob_tree.cpp ../src/gob_task.cpp
+*/
+#include <gob_task.hpp>
+#include <gob_flat_task.hpp>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <cstdio>
+
+namespace
+{
+class BenchTask : public goblib::Task
+{
+  public:
+    BenchTask(PriorityType pri, std::uint32_t& counter) : goblib::Task(pri, "bench"), _counter(counter) {}
+  protected:
+    virtual void onExecute(const float /*delta*/) override { ++_counter; }
+  private:
+    std::uint32_t& _counter;
+};
+
+// Tasks are allocated in random order, with some padding between them, to scatter them on heap.
+template<class Tree> double bench(const std::size_t num, const std::size_t frames, std::uint32_t& counter)
+{
+    Tree tree;
+    std::vector<BenchTask*> tasks;
+    std::vector<std::uint8_t*> padding;
+    std::mt19937 rng(52);
+
+    tasks.reserve(num);
+    for(std::size_t i = 0; i < num; ++i)
+    {
+        padding.push_back(new std::uint8_t[rng() % 256 + 16]);
+        auto t = new BenchTask(static_cast<goblib::Task::PriorityType>(rng() % 16), counter);
+        // 1/8 are children of root, others are children of earlier task.
+        BenchTask* parent = (i < 8 || (rng() & 7) == 0) ? nullptr : tasks[rng() % tasks.size()];
+        tree.insertNode(t, parent);
+        tasks.push_back(t);
+    }
+    tree.pump(); // Initialize
+
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t f = 0; f < frames; ++f) { tree.pump(); }
+    auto end = std::chrono::steady_clock::now();
+
+    tree.clear();
+    for(auto& t : tasks) { delete t; }
+    for(auto& p : padding) { delete[] p; }
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / frames;
+}
+//
+}
+
+int main()
+{
+    const std::size_t nums[] = { 100, 1000, 10000 };
+    printf("%8s %16s %16s %8s\n", "tasks", "TaskTree(us)", "FlatTaskTree(us)", "ratio");
+    for(auto& n : nums)
+    {
+        std::size_t frames = 1000000 / n;
+        std::uint32_t c0 = 0, c1 = 0;
+        double t0 = bench<goblib::TaskTree<goblib::Task>>(n, frames, c0);
+        double t1 = bench<goblib::FlatTaskTree<goblib::Task>>(n, frames, c1);
+        printf("%8zu %16.3f %16.3f %8.2f%s\n", n, t0, t1, t0 / t1, (c0 == c1) ? "" : " (MISMATCH)");
+    }
+    return 0;
+}
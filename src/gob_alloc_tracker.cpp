@@ -0,0 +1,112 @@
+/*!
+  Goblin Library
+
+  @file   gob_alloc_tracker.cpp
+  @brief  Heap allocation counter and no-allocation guard.
+*/
+#if defined(GOBLIB_ENABLE_PROFILE)
+
+#include "gob_alloc_tracker.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace goblib { namespace profile {
+
+namespace
+{
+// Name of the innermost effective NoAllocScope of this thread (nullptr if not guarded)
+thread_local const char* guarded = nullptr;
+//
+}
+
+AllocTracker& AllocTracker::instance()
+{
+    static AllocTracker t;
+    return t;
+}
+
+void AllocTracker::onAllocate(const std::size_t size)
+{
+    AllocTracker& t = instance();
+    t._count.fetch_add(1, std::memory_order_relaxed);
+    t._bytes.fetch_add(size, std::memory_order_relaxed);
+    if(guarded) { t.violate(size, guarded); }
+}
+
+void AllocTracker::onDeallocate()
+{
+    instance()._freed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocTracker::violate(const std::size_t size, const char* scope)
+{
+    _violations.fetch_add(1, std::memory_order_relaxed);
+    const Violation v = violation();
+    if(v == Violation::Ignore) { return; }
+
+    // Unguard while reporting, because output may allocate.
+    guarded = nullptr;
+    std::fprintf(stderr, "[goblib] Allocation of %zu bytes in no-alloc scope \"%s\"\n", size, scope);
+    if(v == Violation::Trap) { std::abort(); }
+    guarded = scope;
+}
+
+NoAllocScope::NoAllocScope(const char* name, const bool enable) : _prev(guarded), _enable(enable)
+{
+    if(enable) { guarded = name ? name : ""; }
+}
+
+NoAllocScope::~NoAllocScope()
+{
+    if(_enable) { guarded = _prev; }
+}
+
+//
+}}
+
+#if !defined(GOBLIB_ALLOC_TRACKER_NO_REPLACE)
+namespace
+{
+void* allocate(const std::size_t sz)
+{
+    goblib::profile::AllocTracker::onAllocate(sz);
+    return std::malloc(sz ? sz : 1);
+}
+void deallocate(void* p)
+{
+    if(p)
+    {
+        goblib::profile::AllocTracker::onDeallocate();
+        std::free(p);
+    }
+}
+//
+}
+
+// Replace global operator new/delete to count allocations.
+void* operator new(std::size_t sz)
+{
+    void* p = allocate(sz);
+    if(!p) { throw std::bad_alloc(); }
+    return p;
+}
+void* operator new[](std::size_t sz)
+{
+    void* p = allocate(sz);
+    if(!p) { throw std::bad_alloc(); }
+    return p;
+}
+void* operator new(std::size_t sz, const std::nothrow_t&) noexcept { return allocate(sz); }
+void* operator new[](std::size_t sz, const std::nothrow_t&) noexcept { return allocate(sz); }
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+#endif
+#endif // !defined(GOBLIB_ALLOC_TRACKER_NO_REPLACE)
+
+#endif // defined(GOBLIB_ENABLE_PROFILE)
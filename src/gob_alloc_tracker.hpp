@@ -0,0 +1,136 @@
+/*!
+  Goblin Library
+
+  @file   gob_alloc_tracker.hpp
+  @brief  Heap allocation counter and no-allocation guard.
+  @details Global operator new/delete are replaced in gob_alloc_tracker.cpp to count allocations.<br>
+  Define GOBLIB_ALLOC_TRACKER_NO_REPLACE if the application replaces them itself,
+  and call AllocTracker::onAllocate / onDeallocate from them.
+  @note Over-aligned new (C++17 std::align_val_t) is not replaced, so it is not counted.
+  @attention To use them, you need to define GOBLIB_ENABLE_PROFILE.
+*/
+#pragma once
+#ifndef GOBLIB_ALLOC_TRACKER_HPP
+#define GOBLIB_ALLOC_TRACKER_HPP
+
+#if defined(GOBLIB_ENABLE_PROFILE)
+
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+namespace goblib { namespace profile {
+
+/*! @brief Number and bytes of allocations */
+struct AllocStatistics
+{
+    std::uint64_t count;
+    std::uint64_t bytes;
+
+    GOBLIB_INLINE AllocStatistics operator-(const AllocStatistics& o) const
+    {
+        return AllocStatistics{ count - o.count, bytes - o.bytes };
+    }
+};
+
+/*!
+  @brief Counts heap allocations of all threads.
+  @details Counting is lock-free (relaxed atomics), so the counter is cheap enough to be always on in profile builds.<br>
+  Allocations in a region are the difference of statistics() at both ends.
+  @attention To use them, you need to define GOBLIB_ENABLE_PROFILE.
+*/
+class AllocTracker
+{
+  public:
+    /*!
+      @enum Violation
+      @brief Action on allocation inside NoAllocScope.
+    */
+    enum class Violation : std::uint8_t
+    {
+        Ignore, //!< Count only.
+        Report, //!< Count and print size and name of scope to stderr.
+        Trap,   //!< Report and abort. (Default)
+    };
+
+    static AllocTracker& instance();
+
+    /// @name Property
+    /// @{
+    /*! @brief Total allocations since start */
+    GOBLIB_INLINE AllocStatistics statistics() const
+    {
+        return AllocStatistics{ _count.load(std::memory_order_relaxed), _bytes.load(std::memory_order_relaxed) };
+    }
+    GOBLIB_INLINE std::uint64_t allocations() const { return _count.load(std::memory_order_relaxed); }
+    GOBLIB_INLINE std::uint64_t deallocations() const { return _freed.load(std::memory_order_relaxed); }
+    GOBLIB_INLINE std::uint64_t allocatedBytes() const { return _bytes.load(std::memory_order_relaxed); }
+    /*! @brief Number of allocations inside NoAllocScope */
+    GOBLIB_INLINE std::uint64_t violations() const { return _violations.load(std::memory_order_relaxed); }
+    GOBLIB_INLINE Violation violation() const { return _violation.load(std::memory_order_relaxed); }
+    /// @}
+
+    GOBLIB_INLINE void setViolation(const Violation v) { _violation.store(v, std::memory_order_relaxed); }
+
+    /// @name Hook
+    /// @note Called from replaced operator new/delete.
+    /// @{
+    static void onAllocate(const std::size_t size);
+    static void onDeallocate();
+    /// @}
+
+  private:
+    AllocTracker() : _count(0), _bytes(0), _freed(0), _violations(0), _violation(Violation::Trap) {}
+    AllocTracker(const AllocTracker&) = delete;
+    AllocTracker& operator=(const AllocTracker&) = delete;
+
+    void violate(const std::size_t size, const char* scope);
+
+  private:
+    friend class NoAllocScope;
+
+    std::atomic<std::uint64_t> _count, _bytes, _freed, _violations;
+    std::atomic<Violation> _violation;
+};
+
+/*!
+  @brief Heap allocation in this thread while alive is a violation. (See also AllocTracker::Violation)
+  @details Scopes can be nested. Allocations of other threads are not checked.
+  @attention To use them, you need to define GOBLIB_ENABLE_PROFILE.
+*/
+class NoAllocScope
+{
+  public:
+    /*!
+      @param name Name of scope for report (Must be alive while scope is alive)
+      @param enable Guard is effective if true
+    */
+    explicit NoAllocScope(const char* name, const bool enable = true);
+    ~NoAllocScope();
+
+  private:
+    NoAllocScope(const NoAllocScope&) = delete;
+    NoAllocScope& operator=(const NoAllocScope&) = delete;
+
+    friend class AllocTracker;
+
+    const char* _prev; // Name of outer scope
+    bool _enable;
+};
+
+/*! Guard against heap allocation in scope. name is const char* */
+#define GOBLIB_NO_ALLOC_SCOPE(name) goblib::profile::NoAllocScope GOBLIB_CONCAT(na_,__LINE__)((name))
+/*! Guard against heap allocation in scope if cond is true. name is const char* */
+#define GOBLIB_NO_ALLOC_SCOPE_IF(name, cond) goblib::profile::NoAllocScope GOBLIB_CONCAT(na_,__LINE__)((name), (cond))
+
+//
+}}
+
+#else // defined(GOBLIB_ENABLE_PROFILE)
+
+#define GOBLIB_NO_ALLOC_SCOPE(name) /* Nop */
+#define GOBLIB_NO_ALLOC_SCOPE_IF(name, cond) /* Nop */
+
+#endif // defined(GOBLIB_ENABLE_PROFILE)
+#endif
@@ -0,0 +1,170 @@
+/*!
+  Goblin Library
+
+  @file  gob_allocator.cpp
+  @brief Slab allocator and frame arena.
+*/
+#include "gob_allocator.hpp"
+#include <algorithm>
+
+namespace goblib
+{
+
+constexpr std::size_t SlabAllocator::DEFAULT_PAGE_SIZE;
+constexpr std::size_t SlabAllocator::MIN_CLASS_SIZE;
+constexpr std::size_t SlabAllocator::MAX_ALIGN;
+constexpr std::size_t SlabAllocator::MAX_CLASSES;
+
+SlabAllocator::SlabAllocator(std::size_t pages, std::size_t growPages, std::size_t pageSize)
+        : _pageSize(pageSize), _growPages(growPages), _classes(0)
+        , _classSize(), _classFirst(), _classBlocks(), _partial(), _free(nullptr), _chunks()
+        , _pages(0), _freePages(0), _allocated(0), _failed(0)
+{
+    assert(pageSize >= 4096 && (pageSize & (pageSize - 1)) == 0 && "pageSize must be power of 2 and 4096 or more");
+
+    // Size classes up to 1/8 of page.
+    for(std::size_t sz = MIN_CLASS_SIZE; sz <= _pageSize / 8 && _classes < MAX_CLASSES; sz <<= 1)
+    {
+        std::size_t align = sz < MAX_ALIGN ? sz : MAX_ALIGN;
+        std::size_t first = (sizeof(Page) + align - 1) & ~(align - 1);
+        _classSize[_classes] = sz;
+        _classFirst[_classes] = static_cast<std::uint32_t>(first);
+        _classBlocks[_classes] = static_cast<std::uint32_t>((_pageSize - first) / sz);
+        _partial[_classes] = nullptr;
+        ++_classes;
+    }
+    if(pages) { grow(pages); }
+}
+
+SlabAllocator::~SlabAllocator()
+{
+    for(auto& c : _chunks) { ::operator delete(c.raw); }
+}
+
+void* SlabAllocator::allocate(const std::size_t size, const std::size_t align)
+{
+    assert(align && (align & (align - 1)) == 0 && "align must be power of 2");
+    std::size_t need = size > align ? size : align;
+    std::size_t k = 0;
+    while(k < _classes && _classSize[k] < need) { ++k; }
+    if(k >= _classes || align > MAX_ALIGN) { ++_failed; return nullptr; }
+
+    Page* pg = _partial[k] ? _partial[k] : takePage(k);
+    if(!pg) { ++_failed; return nullptr; }
+
+    void* p;
+    if(pg->free)
+    {
+        p = pg->free;
+        pg->free = *static_cast<void**>(p);
+    }
+    else
+    {
+        // Carve lazily, so untouched part of page is not written.
+        p = reinterpret_cast<std::uint8_t*>(pg) + pg->carve;
+        pg->carve += static_cast<std::uint32_t>(_classSize[k]);
+    }
+    if(++pg->used == _classBlocks[k]) { unlink(_partial[k], pg); } // Full
+    ++_allocated;
+    return p;
+}
+
+void SlabAllocator::deallocate(void* p)
+{
+    if(!p) { return; }
+    assert(owns(p) && "Not allocated by this allocator");
+
+    Page* pg = pageOf(p);
+    std::size_t k = pg->klass;
+
+    // Start of block that contains p.
+    std::uintptr_t top = reinterpret_cast<std::uintptr_t>(pg) + _classFirst[k];
+    std::uintptr_t off = (reinterpret_cast<std::uintptr_t>(p) - top) & ~(static_cast<std::uintptr_t>(_classSize[k]) - 1);
+    void* block = reinterpret_cast<void*>(top + off);
+
+    bool wasFull = pg->used == _classBlocks[k];
+    *static_cast<void**>(block) = pg->free;
+    pg->free = block;
+    --_allocated;
+
+    if(wasFull) { pushFront(_partial[k], pg); }
+    if(--pg->used == 0)
+    {
+        // Return to shared page list.
+        unlink(_partial[k], pg);
+        pushFront(_free, pg);
+        ++_freePages;
+    }
+}
+
+bool SlabAllocator::owns(const void* p) const
+{
+    std::uintptr_t a = reinterpret_cast<std::uintptr_t>(p);
+    auto it = std::upper_bound(_chunks.begin(), _chunks.end(), a, [](std::uintptr_t v, const Chunk& c) { return v < c.begin; });
+    if(it == _chunks.begin()) { return false; }
+    --it;
+    return a < it->end;
+}
+
+bool SlabAllocator::grow(const std::size_t pages)
+{
+    void* raw = ::operator new(pages * _pageSize + _pageSize - 1, std::nothrow);
+    if(!raw) { return false; }
+
+    std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(raw) + _pageSize - 1) & ~(static_cast<std::uintptr_t>(_pageSize) - 1);
+    Chunk c = { raw, begin, begin + pages * _pageSize };
+    _chunks.insert(std::upper_bound(_chunks.begin(), _chunks.end(), begin, [](std::uintptr_t v, const Chunk& e) { return v < e.begin; }), c);
+
+    for(std::size_t i = pages; i > 0; --i)
+    {
+        pushFront(_free, reinterpret_cast<Page*>(begin + (i - 1) * _pageSize));
+    }
+    _pages += pages;
+    _freePages += pages;
+    return true;
+}
+
+SlabAllocator::Page* SlabAllocator::takePage(const std::size_t klass)
+{
+    if(!_free && !(_growPages && grow(_growPages))) { return nullptr; }
+
+    Page* pg = _free;
+    unlink(_free, pg);
+    --_freePages;
+
+    pg->free = nullptr;
+    pg->carve = _classFirst[klass];
+    pg->used = 0;
+    pg->klass = static_cast<std::uint32_t>(klass);
+    pushFront(_partial[klass], pg);
+    return pg;
+}
+
+void SlabAllocator::unlink(Page*& head, Page* pg)
+{
+    if(pg->prev) { pg->prev->next = pg->next; }
+    else         { head = pg->next; }
+    if(pg->next) { pg->next->prev = pg->prev; }
+    pg->prev = pg->next = nullptr;
+}
+
+void SlabAllocator::pushFront(Page*& head, Page* pg)
+{
+    pg->prev = nullptr;
+    pg->next = head;
+    if(head) { head->prev = pg; }
+    head = pg;
+}
+
+FrameArena::FrameArena(std::size_t capacity)
+        : _buffer(static_cast<std::uint8_t*>(::operator new(capacity)))
+        , _capacity(capacity), _offset(0), _highWater(0), _failed(0)
+{}
+
+FrameArena::~FrameArena()
+{
+    ::operator delete(_buffer);
+}
+
+//
+}
@@ -0,0 +1,194 @@
+/*!
+  Goblin Library
+
+  @file  gob_allocator.hpp
+  @brief Slab allocator and frame arena.
+  @warning This is NOT THREAD.
+*/
+#pragma once
+#ifndef GOBLIB_ALLOCATOR_HPP
+#define GOBLIB_ALLOCATOR_HPP
+
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cassert>
+
+namespace goblib
+{
+
+/*!
+  @brief Slab allocator with size classes.
+  @details Memory is reserved as pages aligned by page size. Each page is assigned to a size class (power of 2)
+  and carved into blocks. Page of an address is found by masking, so deallocate() needs no size,
+  and accepts any address inside the block (e.g. pointer to base class).<br>
+  Empty pages return to the shared page list and can be reused by other size classes.<br>
+  If growable, new pages are reserved by growPages at once when all pages are used. Reserved pages are never reallocated.
+  @note Block alignment is min(size class, MAX_ALIGN).
+*/
+class SlabAllocator
+{
+  public:
+    constexpr static std::size_t DEFAULT_PAGE_SIZE = 16 * 1024;
+    constexpr static std::size_t MIN_CLASS_SIZE = 16;          //!< Smallest size class.
+    constexpr static std::size_t MAX_ALIGN = 64;                //!< Max alignment of block.
+    constexpr static std::size_t MAX_CLASSES = 16;
+
+    /*!
+      @param pages Number of pages reserved at construction.
+      @param growPages Number of pages reserved when all pages are used. Zero means not growable.
+      @param pageSize Size of page. (Power of 2, 4096 or more)
+    */
+    explicit SlabAllocator(std::size_t pages, std::size_t growPages = 0, std::size_t pageSize = DEFAULT_PAGE_SIZE);
+    ~SlabAllocator();
+
+    /// @name Allocate
+    /// @{
+    /*!
+      @brief Allocate memory
+      @retval != nullptr Allocated address.
+      @retval == nullptr Too large, too aligned or no page available.
+    */
+    void* allocate(const std::size_t size, const std::size_t align = alignof(std::max_align_t));
+    /*! @brief Deallocate memory allocated by this */
+    void deallocate(void* p);
+    /*! @brief Is address in pages of this? */
+    bool owns(const void* p) const;
+
+    /*! @brief Allocate and construct U */
+    template<class U, class... Args> GOBLIB_NODISCARD U* create(Args&&... args)
+    {
+        static_assert(alignof(U) <= MAX_ALIGN, "Alignment of U is too large");
+        void* p = allocate(sizeof(U), alignof(U));
+        return p ? new (p) U(std::forward<Args>(args)...) : nullptr;
+    }
+    /*! @brief Destruct and deallocate. p may be the pointer to base class (Destructor must be virtual) */
+    template<class U> void destroy(U* p)
+    {
+        if(!p) { return; }
+        assert(owns(p) && "Not allocated by this allocator");
+        p->~U();
+        deallocate(p);
+    }
+    /// @}
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE std::size_t pageSize() const { return _pageSize; }
+    /*! @brief Largest size that can be allocated */
+    GOBLIB_INLINE std::size_t maxSize() const { return _classSize[_classes - 1]; }
+    /*! @brief Number of reserved pages */
+    GOBLIB_INLINE std::size_t pages() const { return _pages; }
+    /*! @brief Number of pages not assigned to size class */
+    GOBLIB_INLINE std::size_t freePages() const { return _freePages; }
+    /*! @brief Number of allocated blocks */
+    GOBLIB_INLINE std::size_t allocated() const { return _allocated; }
+    /*! @brief Number of failed allocate() */
+    GOBLIB_INLINE std::size_t failed() const { return _failed; }
+    /// @}
+
+  private:
+    struct Page
+    {
+        Page* prev;             // Doubly-linked list of partial pages of class (or free pages)
+        Page* next;
+        void* free;             // Free blocks (intrusive)
+        std::uint32_t carve;    // Offset of block not carved yet.
+        std::uint32_t used;     // Number of allocated blocks
+        std::uint32_t klass;    // Size class
+    };
+    struct Chunk { void* raw; std::uintptr_t begin, end; };
+
+    GOBLIB_INLINE Page* pageOf(const void* p) const
+    { return reinterpret_cast<Page*>(reinterpret_cast<std::uintptr_t>(p) & ~(static_cast<std::uintptr_t>(_pageSize) - 1)); }
+
+    bool grow(const std::size_t pages);
+    Page* takePage(const std::size_t klass);
+    void unlink(Page*& head, Page* pg);
+    void pushFront(Page*& head, Page* pg);
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+  private:
+    const std::size_t _pageSize, _growPages;
+    std::size_t _classes;
+    std::size_t _classSize[MAX_CLASSES];    // Size of block
+    std::uint32_t _classFirst[MAX_CLASSES]; // Offset of first block in page
+    std::uint32_t _classBlocks[MAX_CLASSES];// Number of blocks in page
+    Page* _partial[MAX_CLASSES];            // Pages that have free blocks
+    Page* _free;                            // Pages not assigned
+    std::vector<Chunk> _chunks;             // Sorted by address
+    std::size_t _pages, _freePages, _allocated, _failed;
+};
+
+/*!
+  @brief Bump allocator for transient data in a frame.
+  @details allocate() moves offset only. reset() releases all at once in O(1).
+*/
+class FrameArena
+{
+  public:
+    /*! @param capacity Size of buffer */
+    explicit FrameArena(std::size_t capacity);
+    ~FrameArena();
+
+    /*!
+      @brief Allocate memory
+      @retval != nullptr Allocated address.
+      @retval == nullptr Not enough space.
+    */
+    void* allocate(const std::size_t size, const std::size_t align = alignof(std::max_align_t))
+    {
+        assert(align && (align & (align - 1)) == 0 && "align must be power of 2");
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(_buffer);
+        std::uintptr_t p = (base + _offset + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+        if(p + size > base + _capacity) { ++_failed; return nullptr; }
+        _offset = p + size - base;
+        if(_offset > _highWater) { _highWater = _offset; }
+        return reinterpret_cast<void*>(p);
+    }
+    /*! @brief Allocate and construct U (Destructor is not called, so U must be trivially destructible) */
+    template<class U, class... Args> GOBLIB_NODISCARD U* create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible<U>::value, "U must be trivially destructible");
+        void* p = allocate(sizeof(U), alignof(U));
+        return p ? new (p) U(std::forward<Args>(args)...) : nullptr;
+    }
+    /*! @brief Allocate array of U (Uninitialized) */
+    template<class U> GOBLIB_NODISCARD U* allocateArray(const std::size_t n)
+    {
+        static_assert(std::is_trivially_destructible<U>::value, "U must be trivially destructible");
+        return static_cast<U*>(allocate(sizeof(U) * n, alignof(U)));
+    }
+
+    /*! @brief Release all */
+    GOBLIB_INLINE void reset() { _offset = 0; }
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE std::size_t capacity() const { return _capacity; }
+    GOBLIB_INLINE std::size_t used() const { return _offset; }
+    /*! @brief Maximum used size since construct */
+    GOBLIB_INLINE std::size_t highWaterMark() const { return _highWater; }
+    /*! @brief Number of failed allocate() */
+    GOBLIB_INLINE std::size_t failed() const { return _failed; }
+    /// @}
+
+  private:
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+  private:
+    std::uint8_t* _buffer;
+    const std::size_t _capacity;
+    std::size_t _offset, _highWater, _failed;
+};
+
+//
+}
+#endif
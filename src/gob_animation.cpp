@@ -5,6 +5,8 @@
   @brief  Animation sequence.
 */
 #include "gob_animation.hpp"
+#include <algorithm>
+#include <utility>
 
 namespace goblib { namespace graph {
 
@@ -60,7 +62,7 @@ bool AnimationSequencer::pump()
             break;
         }
 
-        if(_prev != _current && _sequences.size())
+        if(_prev != _current && _current < _sequences.size())
         {
             _cs = _sequences[_current];
             _prev = _current;
@@ -71,5 +73,122 @@ bool AnimationSequencer::pump()
     return isFinish();
 }
 
+namespace
+{
+struct Recorder
+{
+    std::vector<AnimationTimeline::Event>* events;
+    std::uint16_t step;
+};
+
+void record(void* arg, std::uint8_t index)
+{
+    auto r = static_cast<Recorder*>(arg);
+    r->events->push_back({ r->step, index });
+}
+
+// Interpreter state at pump start.
+struct Snapshot
+{
+    std::uint8_t current, prev, cell;
+    bool flipH, flipV;
+    std::int16_t ox, oy;
+    Sequence cs;
+    std::vector<Sequence> stack;
+};
+
+bool equal(const Sequence& a, const Sequence& b)
+{
+    return a.command == b.command && a.u32[0] == b.u32[0];
+}
+
+bool equal(const Snapshot& a, const Snapshot& b)
+{
+    return a.current == b.current && a.prev == b.prev && a.cell == b.cell &&
+            a.flipH == b.flipH && a.flipV == b.flipV && a.ox == b.ox && a.oy == b.oy &&
+            equal(a.cs, b.cs) &&
+            a.stack.size() == b.stack.size() &&
+            std::equal(a.stack.begin(), a.stack.end(), b.stack.begin(),
+                       [](const Sequence& x, const Sequence& y) { return equal(x, y); });
+}
+//
+}
+
+bool AnimationTimeline::build(const AnimationSequencer& src)
+{
+    _steps.assign(1, Step{0, 0, 0, 0, 0});
+    _events.clear();
+    _loop = npos;
+
+    AnimationSequencer seq(src);
+    seq.reset();
+    seq.pause(false);
+    Recorder rec{ &_events, 0 };
+    seq.setCallback(record, &rec);
+
+    auto snapshot = [&seq]()
+    {
+        Snapshot s{ seq._current, seq._prev, seq._cell, seq._flipH, seq._flipV, seq._ox, seq._oy, seq._cs, {} };
+        AnimationSequencer::Stack st(seq._stack);
+        s.stack.reserve(st.size());
+        while(!st.empty()) { s.stack.push_back(st.top()); st.pop(); }
+        return s;
+    };
+
+    if(seq.size() == 0 || seq.isFinish()) { _steps[0].flags = Step::Finish; return true; }
+
+    std::vector<Snapshot> snaps;
+    std::vector<std::vector<std::uint32_t> > byIndex(AnimationSequencer::SEQUENCE_MAX + 1);
+    for(;;)
+    {
+        // Same state as the start of a previous pump? loop back to the step it made.
+        Snapshot ss = snapshot();
+        auto& cand = byIndex[ss.current];
+        auto it = std::find_if(cand.begin(), cand.end(), [&](std::uint32_t i) { return equal(snaps[i], ss); });
+        if(it != cand.end()) { _loop = *it + 1; break; }
+        if(_steps.size() > STEP_MAX || _events.size() > STEP_MAX)
+        {
+            *this = AnimationTimeline();
+            return false;
+        }
+        cand.push_back(static_cast<std::uint32_t>(snaps.size()));
+        snaps.push_back(std::move(ss));
+
+        rec.step = static_cast<std::uint16_t>(_steps.size());
+        auto ecnt = _events.size();
+        bool fin = seq.pump();
+        _steps.push_back(Step{ seq.offsetX(), seq.offsetY(), seq.cell(),
+                        static_cast<std::uint8_t>((seq.isFlipH() ? Step::FlipH : 0) |
+                                                  (seq.isFlipV() ? Step::FlipV : 0) |
+                                                  (_events.size() != ecnt ? Step::Callback : 0) |
+                                                  (fin ? Step::Finish : 0)),
+                        static_cast<std::uint16_t>(ecnt) });
+        if(fin) { break; }
+    }
+    return true;
+}
+
+std::size_t AnimationSet::pump()
+{
+    assert(_timeline && "Timeline not set");
+    std::size_t finished = 0;
+    const std::size_t sz = _cursors.size();
+    for(std::size_t i = 0; i < sz; ++i)
+    {
+        std::uint32_t c = _cursors[i];
+        if(_timeline->step(c).flags & AnimationTimeline::Step::Finish) { ++finished; continue; }
+        if(_pause[i]) { continue; }
+
+        c = _cursors[i] = _timeline->next(c);
+        const std::uint8_t flags = _timeline->step(c).flags;
+        if((flags & AnimationTimeline::Step::Callback) && _callback)
+        {
+            _timeline->forEachEvent(c, [this, i](std::uint8_t index) { _callback(_arg, i, index); });
+        }
+        finished += (flags & AnimationTimeline::Step::Finish) != 0;
+    }
+    return finished;
+}
+
 //
 }}
@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <vector>
+#include <algorithm>
 #include <stack>
 #include <initializer_list>
 #include <cassert>
@@ -216,6 +217,7 @@ class AnimationSequencer
   private:
     AnimationSequencer(AnimationSequencer&&) = delete;
     AnimationSequencer& operator=(AnimationSequencer&&) = delete;
+    friend class AnimationTimeline;
     
   private:
     std::vector<Sequence> _sequences; 
@@ -234,6 +236,240 @@ class AnimationSequencer
     void* _arg;
 };
 
+
+/*!
+  @brief Flat timeline compiled from AnimationSequencer.
+  @details Loops and gotos are resolved ahead of time into one step per pump.
+  Immutable after build, so one timeline can be shared by many AnimationPlayer.
+  @note Step 0 is the state before first pump.
+*/
+class AnimationTimeline
+{
+  public:
+    using Callback = AnimationSequencer::Callback;
+    constexpr static std::size_t STEP_MAX = 65535;
+    constexpr static std::uint32_t npos = ~0U;
+
+    /*! @brief State after a pump */
+    struct Step
+    {
+        enum : std::uint8_t
+        {
+            FlipH = 0x01,
+            FlipV = 0x02,
+            Callback = 0x04, //!< Has callback event(s)
+            Finish = 0x08,   //!< Sequence finished on this step
+        };
+        std::int16_t ox, oy;
+        std::uint8_t cell;
+        std::uint8_t flags;
+        std::uint16_t event; //!< First index of events
+    };
+    /*! @brief Callback event */
+    struct Event
+    {
+        std::uint16_t step;  //!< Fired on this step
+        std::uint8_t index;  //!< Index of sequence (Argument for Callback)
+    };
+
+    AnimationTimeline() : _steps(1, Step{0, 0, 0, Step::Finish, 0}), _events(), _loop(npos) {}
+    explicit AnimationTimeline(const AnimationSequencer& seq) : AnimationTimeline() { build(seq); }
+
+    /*!
+      @brief Build from sequencer.
+      @param seq Source (Not changed, simulated on a copy)
+      @retval true Success
+      @retval false Too many steps. (Timeline will be empty)
+      @warning Infinite loop without Draw in source is not detected, as well as AnimationSequencer::pump.
+    */
+    bool build(const AnimationSequencer& seq);
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE std::size_t size() const { return _steps.size(); }
+    /*! @brief No steps except initial state? */
+    GOBLIB_INLINE bool empty() const { return _steps.size() <= 1; }
+    GOBLIB_INLINE bool isLoop() const { return _loop != npos; }
+    /*! @brief Step index of loop back (npos if not loop) */
+    GOBLIB_INLINE std::uint32_t loopIndex() const { return _loop; }
+    GOBLIB_INLINE const Step& step(const std::size_t i) const { return _steps[i]; }
+    GOBLIB_INLINE const std::vector<Event>& events() const { return _events; }
+    /// @}
+
+    /*! @brief Next step index of cursor */
+    GOBLIB_INLINE std::uint32_t next(const std::uint32_t cursor) const
+    {
+        return (cursor + 1 < _steps.size()) ? cursor + 1 : (isLoop() ? _loop : cursor);
+    }
+    /*! @brief Call function(index of sequence) for each events of step */
+    template<typename F> void forEachEvent(const std::uint32_t cursor, F f) const
+    {
+        if(!(_steps[cursor].flags & Step::Callback)) { return; }
+        for(std::size_t i = _steps[cursor].event; i < _events.size() && _events[i].step == cursor; ++i)
+        {
+            f(_events[i].index);
+        }
+    }
+    /*! @brief Call callback for events of step */
+    void fire(const std::uint32_t cursor, Callback f, void* arg) const
+    {
+        if(f) { forEachEvent(cursor, [f, arg](std::uint8_t index) { f(arg, index); }); }
+    }
+
+  private:
+    std::vector<Step> _steps;
+    std::vector<Event> _events;
+    std::uint32_t _loop;
+};
+
+/*!
+  @brief Playback AnimationTimeline.
+  @details Keeps only cursor for shared timeline. Same behavior as AnimationSequencer.
+  @warning Timeline must be set before use.
+*/
+class AnimationPlayer
+{
+  public:
+    using Callback = AnimationSequencer::Callback;
+
+    explicit AnimationPlayer(const AnimationTimeline* tl = nullptr)
+            : _timeline(tl), _cursor(0), _pause(false), _callback(nullptr), _arg(nullptr)
+    {}
+
+    GOBLIB_INLINE void setTimeline(const AnimationTimeline* tl) { _timeline = tl; reset(); }
+    GOBLIB_INLINE const AnimationTimeline* timeline() const { return _timeline; }
+    GOBLIB_INLINE void setCallback(Callback f, void* arg)
+    {
+        _callback = f;
+        _arg = arg;
+    }
+
+    /// @name Propery
+    /// @{
+    GOBLIB_INLINE std::uint8_t cell() const { return current().cell;  }
+    GOBLIB_INLINE std::int16_t offsetX() const { return current().ox; }
+    GOBLIB_INLINE std::int16_t offsetY() const { return current().oy; }
+    GOBLIB_INLINE std::uint32_t cursor() const { return _cursor; }
+    GOBLIB_INLINE bool isFlipH() const { return current().flags & AnimationTimeline::Step::FlipH; }
+    GOBLIB_INLINE bool isFlipV() const { return current().flags & AnimationTimeline::Step::FlipV; }
+    GOBLIB_INLINE bool isFinish() const { return current().flags & AnimationTimeline::Step::Finish; }
+    GOBLIB_INLINE bool isPause() const  { return _pause; }
+    /// @}
+
+    GOBLIB_INLINE void reset() { _cursor = 0; }
+    GOBLIB_INLINE void pause(bool b) { _pause = b; }
+
+    /*! @retval true Finished */
+    bool pump()
+    {
+        assert(_timeline && "Timeline not set");
+        if(isFinish()) { return true; }
+        if(isPause()) { return false; }
+        _cursor = _timeline->next(_cursor);
+        _timeline->fire(_cursor, _callback, _arg);
+        return isFinish();
+    }
+
+  private:
+    GOBLIB_INLINE const AnimationTimeline::Step& current() const { return _timeline->step(_cursor); }
+
+    const AnimationTimeline* _timeline;
+    std::uint32_t _cursor;
+    bool _pause;
+    Callback _callback;
+    void* _arg;
+};
+
+/*!
+  @brief Playback many instances of a shared AnimationTimeline.
+  @details Per instance state is only cursor and pause flag, and pump() advances all instances in one loop.
+  @warning Timeline must be set before use.
+*/
+class AnimationSet
+{
+  public:
+    /*! @brief Callback(arg, instance, index of sequence) */
+    using Callback = void(*)(void*, std::size_t, std::uint8_t);
+
+    explicit AnimationSet(const AnimationTimeline* tl = nullptr, const std::size_t n = 0)
+            : _timeline(tl), _cursors(n, 0), _pause(n, 0), _callback(nullptr), _arg(nullptr)
+    {}
+
+    /*! @brief Change timeline and reset all instances */
+    void setTimeline(const AnimationTimeline* tl)
+    {
+        _timeline = tl;
+        std::fill(_cursors.begin(), _cursors.end(), 0);
+    }
+    GOBLIB_INLINE const AnimationTimeline* timeline() const { return _timeline; }
+    GOBLIB_INLINE void setCallback(Callback f, void* arg)
+    {
+        _callback = f;
+        _arg = arg;
+    }
+
+    /// @name Instance
+    /// @{
+    /*! @brief Add instance. @return Index of instance. */
+    std::size_t add()
+    {
+        _cursors.push_back(0);
+        _pause.push_back(0);
+        return _cursors.size() - 1;
+    }
+    void resize(const std::size_t n)
+    {
+        _cursors.resize(n, 0);
+        _pause.resize(n, 0);
+    }
+    void reserve(const std::size_t n)
+    {
+        _cursors.reserve(n);
+        _pause.reserve(n);
+    }
+    void clear()
+    {
+        _cursors.clear();
+        _pause.clear();
+    }
+    GOBLIB_INLINE std::size_t size() const { return _cursors.size(); }
+    /*! @brief Reset instance. (Can start from other step to vary the phase) */
+    GOBLIB_INLINE void reset(const std::size_t i, const std::uint32_t cursor = 0)
+    {
+        assert(cursor < _timeline->size() && "Out of range");
+        _cursors[i] = cursor;
+    }
+    GOBLIB_INLINE void pause(const std::size_t i, bool b) { _pause[i] = b; }
+    /// @}
+
+    /// @name Propery
+    /// @{
+    GOBLIB_INLINE std::uint8_t cell(const std::size_t i) const { return current(i).cell;  }
+    GOBLIB_INLINE std::int16_t offsetX(const std::size_t i) const { return current(i).ox; }
+    GOBLIB_INLINE std::int16_t offsetY(const std::size_t i) const { return current(i).oy; }
+    GOBLIB_INLINE std::uint32_t cursor(const std::size_t i) const { return _cursors[i]; }
+    GOBLIB_INLINE bool isFlipH(const std::size_t i) const { return current(i).flags & AnimationTimeline::Step::FlipH; }
+    GOBLIB_INLINE bool isFlipV(const std::size_t i) const { return current(i).flags & AnimationTimeline::Step::FlipV; }
+    GOBLIB_INLINE bool isFinish(const std::size_t i) const { return current(i).flags & AnimationTimeline::Step::Finish; }
+    GOBLIB_INLINE bool isPause(const std::size_t i) const  { return _pause[i]; }
+    /// @}
+
+    /*!
+      @brief Advance all instances
+      @return Number of finished instances
+    */
+    std::size_t pump();
+
+  private:
+    GOBLIB_INLINE const AnimationTimeline::Step& current(const std::size_t i) const { return _timeline->step(_cursors[i]); }
+
+    const AnimationTimeline* _timeline;
+    std::vector<std::uint32_t> _cursors;
+    std::vector<std::uint8_t> _pause;
+    Callback _callback;
+    void* _arg;
+};
+
 //
 }}
 #endif
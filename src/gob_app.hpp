@@ -11,27 +11,120 @@
 #include <cassert>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <ratio>
+#include <cmath>
+#include <array>
+#include <algorithm>
+#include <cstdint>
 #include "gob_utility.hpp"
 #if defined(GOBLIB_CPP17_OR_EARLIER)
 #include "gob_template_helper.hpp"
 #endif
 #include "gob_macro.hpp"
+#include "gob_alloc_tracker.hpp"
 
 namespace goblib
 {
+/*!
+  @brief Frame-time histogram.
+  @details Frame time is counted in buckets of BUCKET_US microseconds. The last bucket also holds longer frames.
+*/
+class FrameStatistics
+{
+  public:
+    constexpr static std::size_t BUCKETS = 128;
+    constexpr static std::uint32_t BUCKET_US = 250;
+
+    FrameStatistics() { clear(); }
+
+    void clear()
+    {
+        _histogram.fill(0);
+        _count = _late = _catchUp = _maxFixed = _max = 0;
+        _min = ~0U;
+        _total = 0;
+    }
+
+    /*!
+      @brief Add frame
+      @param us Frame time (microseconds)
+      @param late Woke up late?
+      @param catchUp Number of fixedUpdate calls over the nominal per frame
+      @param fixedUpdates Number of fixedUpdate calls
+    */
+    void add(const std::uint32_t us, const bool late, const std::uint32_t catchUp, const std::uint32_t fixedUpdates)
+    {
+        ++_histogram[std::min<std::size_t>(us / BUCKET_US, BUCKETS - 1)];
+        ++_count;
+        _total += us;
+        _min = std::min(_min, us);
+        _max = std::max(_max, us);
+        _late += late;
+        _catchUp += catchUp;
+        _maxFixed = std::max(_maxFixed, fixedUpdates);
+    }
+
+    /// @name Property
+    /// @note Times are microseconds.
+    /// @{
+    GOBLIB_INLINE std::uint32_t count() const { return _count; }
+    GOBLIB_INLINE std::uint32_t min() const { return _count ? _min : 0; }
+    GOBLIB_INLINE std::uint32_t max() const { return _max; }
+    GOBLIB_INLINE float average() const { return _count ? static_cast<float>(_total) / _count : 0.0f; }
+    /*! @brief Number of frames woke up late */
+    GOBLIB_INLINE std::uint32_t lateFrames() const { return _late; }
+    /*! @brief Total of fixedUpdate calls over the nominal */
+    GOBLIB_INLINE std::uint32_t catchUpIterations() const { return _catchUp; }
+    /*! @brief Maximum fixedUpdate calls in a frame */
+    GOBLIB_INLINE std::uint32_t maxFixedUpdates() const { return _maxFixed; }
+    GOBLIB_INLINE const std::array<std::uint32_t, BUCKETS>& histogram() const { return _histogram; }
+    /*!
+      @brief Percentile
+      @param p [0.0 - 1.0]
+      @return Upper bound of the bucket (Not greater than max())
+    */
+    std::uint32_t percentile(const float p) const
+    {
+        if(!_count) { return 0; }
+        const std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(goblib::clamp(p, 0.0f, 1.0f) * _count));
+        std::uint64_t acc = 0;
+        for(std::size_t i = 0; i < BUCKETS; ++i)
+        {
+            acc += _histogram[i];
+            if(acc >= rank && acc) { return std::min<std::uint32_t>((i + 1) * BUCKET_US, _max); }
+        }
+        return _max;
+    }
+    GOBLIB_INLINE std::uint32_t p95() const { return percentile(0.95f); }
+    GOBLIB_INLINE std::uint32_t p99() const { return percentile(0.99f); }
+    /// @}
+
+  private:
+    std::array<std::uint32_t, BUCKETS> _histogram;
+    std::uint32_t _count, _min, _max, _late, _catchUp, _maxFixed;
+    std::uint64_t _total;
+};
+
 /*!
   App
   @brief Application base class to run at a fixed FPS.
-  @tparam Clock using std::chrono clock. (steady_clock as default)
+  @tparam Clock using std::chrono clock. (steady_clock as default, CycleClock is also available)
   @tparam UFPS Number of update() calls per second. (It will be called every frame) 30 as default.
   @tparam FFPS Number of fixedUpdate() calls per second. (Frame-rate independant) 30 as default.
+  @note In pipelined mode (setPipelined), render() of frame N runs on a render thread while update of frame N+1.
+  Call stop() before destruction of the pipelined app. (Asserted in destructor)
+  @note If GOBLIB_ENABLE_PROFILE defined, heap allocations in each pump are counted (frameAllocations),
+  and fixedUpdate(), update() and render() can be guarded against allocation (setNoAllocFrame).
 */
 template<class Clock = std::chrono::steady_clock, std::uint32_t UFPS = 30, std::uint32_t FFPS = 30>
 class App
 {
 #if defined(GOBLIB_CPP20_OR_LATER)
-    static_assert(std::is_clock<Clock>::value, "Clock must satisfies the Clock requirements");
+    static_assert(std::chrono::is_clock<Clock>::value, "Clock must satisfies the Clock requirements");
 #else
     static_assert(goblib::template_helper::is_clock<Clock>::value, "Clock must satisfies the Clock requirements");
 #endif
@@ -43,11 +136,43 @@ class App
     using FixedUpdateDuration = std::chrono::duration<float, std::ratio<1, FFPS> >;
     
   public:
+    /*!
+      @enum Pacing
+      @brief How to wait for the next frame.
+    */
+    enum class Pacing : std::uint8_t
+    {
+        Sleep,  //!< sleep_until(). (Default)
+        Hybrid, //!< sleep_until() short of the deadline by the calibrated slack, then spin_until().
+        Spin,   //!< spin_until() only.
+    };
+
+    /*! @brief Time of each stage in the last pump */
+    struct StageTimes
+    {
+        Duration fixedUpdate; //!< Total of fixedUpdate() calls
+        Duration update;
+        Duration render;      //!< render() of previous frame on render thread if pipelined
+        Duration stall;       //!< Waiting for render thread at the frame barrier (Pipelined only)
+    };
+
     App() : _updateTick(1), _fixedUpdateTick(1), _deltaTime(1), _last(Clock::now()),
-            _accumulationTime(FFPS >= UFPS ? (float)FFPS/UFPS : 1.0f), _delta(1.0f), _fps(0), _frames(0)
-         
+            _accumulationTime(FFPS >= UFPS ? (float)FFPS/UFPS : 1.0f), _delta(1.0f), _rawDelta(1.0f), _fps(0), _frames(0),
+            _slack(std::chrono::duration_cast<Duration>(std::chrono::milliseconds(2))), _pacing(Pacing::Sleep), _stats(), _stage(), _noAllocFrame(false),
+#if defined(GOBLIB_ENABLE_PROFILE)
+            _frameAllocs{0, 0},
+#endif
+            _pipeline()
     {}
-    virtual ~App(){}
+    /*!
+      @attention If pipelined, stop() must be called before destruction,
+      because render() of the derived class may be running on render thread.
+    */
+    virtual ~App()
+    {
+        assert(!_pipeline && "stop() must be called before destruction if pipelined");
+        _pipeline.reset();
+    }
 
     /// @name Property
     /// @{
@@ -55,28 +180,113 @@ class App
     GOBLIB_INLINE std::uint32_t frames() const { return _frames; }
     GOBLIB_INLINE float delta() const { return _delta; }
     GOBLIB_INLINE Duration deltaTime() const { return _deltaTime; }
+    /*! @brief Delta before clamp to [MIN_DELTA, MAX_DELTA] */
+    GOBLIB_INLINE float rawDelta() const { return _rawDelta; }
+    GOBLIB_INLINE Pacing pacing() const { return _pacing; }
+    /*! @brief Calibrated oversleep of sleep_until() (Used by Pacing::Hybrid) */
+    GOBLIB_INLINE Duration slack() const { return _slack; }
+    GOBLIB_INLINE const FrameStatistics& frameStatistics() const { return _stats; }
+    GOBLIB_INLINE const StageTimes& stageTimes() const { return _stage; }
+    GOBLIB_INLINE bool isPipelined() const { return static_cast<bool>(_pipeline); }
+    GOBLIB_INLINE bool isNoAllocFrame() const { return _noAllocFrame.load(std::memory_order_relaxed); }
+#if defined(GOBLIB_ENABLE_PROFILE)
+    /*!
+      @brief Heap allocations of all threads in the last pump
+      @note Includes render() of the previous frame running on render thread if pipelined.
+    */
+    GOBLIB_INLINE const profile::AllocStatistics& frameAllocations() const { return _frameAllocs; }
+#endif
     /// @}
 
+    GOBLIB_INLINE void setPacing(const Pacing p) { _pacing = p; }
+    GOBLIB_INLINE void resetFrameStatistics() { _stats.clear(); }
+    /*!
+      @brief Guard fixedUpdate(), update() and render() by NoAllocScope
+      @note Effective only if GOBLIB_ENABLE_PROFILE defined. See also profile::AllocTracker::setViolation.
+      @note May be changed while pipelined. The render thread picks it up on its next frame.
+    */
+    GOBLIB_INLINE void setNoAllocFrame(const bool b) { _noAllocFrame.store(b, std::memory_order_relaxed); }
+    /*!
+      @brief Enable/disable pipelined mode
+      @details If enabled, render() runs on a render thread and overlaps with fixedUpdate() and update() of the next frame.
+      swapRenderState() is called at the frame barrier while render thread is idle.<br>
+      If disabled, waits for render thread and returns to serial.
+      @attention Call stop() before destruction if enabled.
+    */
+    void setPipelined(const bool b)
+    {
+        if(b && !_pipeline)  { _pipeline.reset(new Pipeline(this)); }
+        if(!b && _pipeline)  { _pipeline.reset(); }
+    }
+    /*!
+      @brief Wait for render() on render thread and return to serial
+      @details After this, no function of the derived class is called from other threads.
+      Call at end of application loop. (Before destruction of the derived class)
+    */
+    GOBLIB_INLINE void stop() { setPipelined(false); }
+
     /*! Call in application loop */
     void pump()
     {
+#if defined(GOBLIB_ENABLE_PROFILE)
+        const auto allocs = profile::AllocTracker::instance().statistics();
+#endif
+        std::uint32_t fixedUpdates = 0;
+        auto t0 = Clock::now();
         while(_accumulationTime >= _fixedUpdateTick.count())
         {
+            GOBLIB_NO_ALLOC_SCOPE_IF("fixedUpdate", isNoAllocFrame());
             fixedUpdate();
             _accumulationTime -= _fixedUpdateTick.count();
+            ++fixedUpdates;
+        }
+        auto t1 = Clock::now();
+        {
+            GOBLIB_NO_ALLOC_SCOPE_IF("update", isNoAllocFrame());
+            update(_delta);
+        }
+        auto t2 = Clock::now();
+        if(_pipeline)
+        {
+            // Frame barrier
+            _stage.render = _pipeline->sync();
+            auto t3 = Clock::now();
+            swapRenderState();
+            _pipeline->kick();
+            _stage.stall = t3 - t2;
         }
-        update(_delta);
-        render();
-        sleep_until(_last + _updateTick);
+        else
+        {
+            swapRenderState();
+            {
+                GOBLIB_NO_ALLOC_SCOPE_IF("render", isNoAllocFrame());
+                render();
+            }
+            _stage.render = Clock::now() - t2;
+            _stage.stall = Duration(0);
+        }
+        _stage.fixedUpdate = t1 - t0;
+        _stage.update = t2 - t1;
+        wait(absTime());
 
+        auto deadline = absTime();
         auto now = Clock::now();
         _deltaTime = now - _last;
         _last = now;
         _accumulationTime += std::chrono::duration_cast<FixedUpdateDuration>(_deltaTime).count();
         auto ud = std::chrono::duration_cast<UpdateDuration>(_deltaTime).count();
+        _rawDelta = ud;
         _delta = goblib::clamp(ud, MIN_DELTA, MAX_DELTA);
         _fps = UFPS / ud;
         ++_frames;
+
+        constexpr std::uint32_t nominal = (FFPS + UFPS - 1) / UFPS;
+        _stats.add(static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(_deltaTime).count()),
+                   now - deadline > std::chrono::duration_cast<Duration>(_updateTick * LATE_RATIO),
+                   fixedUpdates > nominal ? fixedUpdates - nominal : 0, fixedUpdates);
+#if defined(GOBLIB_ENABLE_PROFILE)
+        _frameAllocs = profile::AllocTracker::instance().statistics() - allocs;
+#endif
     }
 
   protected:
@@ -96,6 +306,12 @@ class App
     /*! Function called once after fixedUpdate() and update() in pump() (It will be called every frame) */
     virtual void render() = 0;
 
+    /*!
+      Function called before render() starts. (At the frame barrier in pipelined mode, render thread is idle)
+      @details Swap double-buffered render state here. (e.g. RenderCommandBuffer2D::swap)
+    */
+    virtual void swapRenderState() {}
+
     /*! Thread sleep 
       @warning Override as needed, as different hardware has different accuracies and wait times.
     */
@@ -103,24 +319,132 @@ class App
     {
         std::this_thread::sleep_until(abs_time);
     }
+    /*! Busy wait (Used by Pacing::Hybrid and Pacing::Spin)
+      @warning Override as needed. (e.g. Without yield on single core)
+    */
+    GOBLIB_INLINE virtual void spin_until(const std::chrono::time_point<Clock, UpdateDuration>& abs_time)
+    {
+        while(Clock::now() < abs_time) { std::this_thread::yield(); }
+    }
     /// @}
 
     GOBLIB_INLINE std::chrono::time_point<Clock, UpdateDuration> absTime() const { return _last + _updateTick; }
     
   private:
+    // Render thread for pipelined mode.
+    class Pipeline
+    {
+      public:
+        explicit Pipeline(App* app)
+                : _app(app), _mutex(), _cv(), _request(false), _stop(false), _time(0), _thread(&Pipeline::run, this)
+        {}
+        ~Pipeline()
+        {
+            sync();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _cv.notify_all();
+            _thread.join();
+        }
+        void kick()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _request = true;
+            }
+            _cv.notify_all();
+        }
+        // Wait for render. Returns time of render().
+        Duration sync()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this]() { return !_request; });
+            return _time;
+        }
+
+      private:
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for(;;)
+            {
+                _cv.wait(lock, [this]() { return _request || _stop; });
+                if(!_request) { return; }
+                lock.unlock();
+                auto start = Clock::now();
+                {
+                    GOBLIB_NO_ALLOC_SCOPE_IF("render", _app->isNoAllocFrame());
+                    _app->render();
+                }
+                auto t = Clock::now() - start;
+                lock.lock();
+                _time = t;
+                _request = false;
+                _cv.notify_all();
+            }
+        }
+
+        App* _app;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        bool _request, _stop;
+        Duration _time;
+        std::thread _thread; // Must be last. (Starts in constructor)
+    };
+
+    void wait(const std::chrono::time_point<Clock, UpdateDuration>& deadline)
+    {
+        switch(_pacing)
+        {
+        case Pacing::Hybrid:
+            {
+                auto coarse = std::chrono::time_point_cast<UpdateDuration>(deadline - _slack);
+                if(Clock::now() < coarse)
+                {
+                    sleep_until(coarse);
+                    // Calibrate slack. Rises immediately, falls slowly.
+                    Duration over = std::chrono::duration_cast<Duration>(Clock::now() - coarse);
+                    over += over / 4; // margin
+                    _slack = (over > _slack) ? over : _slack - (_slack - over) / 16;
+                }
+                spin_until(deadline);
+            }
+            break;
+        case Pacing::Spin:
+            spin_until(deadline);
+            break;
+        default:
+            sleep_until(deadline);
+            break;
+        }
+    }
+
     const UpdateDuration _updateTick;
     const UpdateDuration _fixedUpdateTick;
     Duration _deltaTime;
     TimePoint  _last;
-    float _accumulationTime, _delta,_fps;
+    float _accumulationTime, _delta, _rawDelta, _fps;
     std::uint32_t _frames;
+    Duration _slack;
+    Pacing _pacing;
+    FrameStatistics _stats;
+    StageTimes _stage;
+    std::atomic<bool> _noAllocFrame; // Read by render thread
+#if defined(GOBLIB_ENABLE_PROFILE)
+    profile::AllocStatistics _frameAllocs;
+#endif
+    std::unique_ptr<Pipeline> _pipeline;
     
     constexpr static float MIN_DELTA = 1.0f;
     constexpr static float MAX_DELTA = 4.0f;
+    constexpr static float LATE_RATIO = 0.1f; // Late if woke up after deadline + tick * LATE_RATIO
 };
 
 template<class Clock, std::uint32_t UFPS, std::uint32_t FFPS> constexpr float App<Clock, UFPS, FFPS>::MIN_DELTA;
 template<class Clock, std::uint32_t UFPS, std::uint32_t FFPS> constexpr float App<Clock, UFPS, FFPS>::MAX_DELTA;
+template<class Clock, std::uint32_t UFPS, std::uint32_t FFPS> constexpr float App<Clock, UFPS, FFPS>::LATE_RATIO;
 
 //
 }
@@ -0,0 +1,406 @@
+/*!
+  Goblin Library
+
+  @file   gob_asset_pack.cpp
+  @brief  Indexed asset pack archive over Stream.
+*/
+#include "gob_asset_pack.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+#include <limits>
+
+namespace goblib
+{
+
+namespace
+{
+using Order = endian::Order;
+
+constexpr std::size_t HASH_BITS = 12;
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t LAST_LITERALS = 5;  // Last 5 bytes must be literals.
+constexpr std::size_t MATCH_LIMIT = 12;   // Last match must start 12 bytes before the end.
+constexpr std::size_t MAX_OFFSET = 65535;
+
+GOBLIB_INLINE std::uint32_t load32(const std::uint8_t* p)
+{
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+void putLength(std::vector<std::uint8_t>& out, std::size_t len)
+{
+    while(len >= 255) { out.push_back(255); len -= 255; }
+    out.push_back(static_cast<std::uint8_t>(len));
+}
+
+bool getLength(const std::uint8_t* src, const std::size_t ssize, std::size_t& s, std::size_t& len)
+{
+    std::uint8_t b;
+    do
+    {
+        if(s >= ssize) { return false; }
+        b = src[s++];
+        len += b;
+    }
+    while(b == 255);
+    return true;
+}
+
+void emit(std::vector<std::uint8_t>& out, const std::uint8_t* lit, const std::size_t litLen, const std::size_t offset, const std::size_t matchLen)
+{
+    const std::size_t ml = matchLen ? matchLen - MIN_MATCH : 0;
+    out.push_back(static_cast<std::uint8_t>((std::min<std::size_t>(litLen, 15) << 4) | std::min<std::size_t>(ml, 15)));
+    if(litLen >= 15) { putLength(out, litLen - 15); }
+    out.insert(out.end(), lit, lit + litLen);
+    if(!matchLen) { return; }
+    out.push_back(static_cast<std::uint8_t>(offset));
+    out.push_back(static_cast<std::uint8_t>(offset >> 8));
+    if(ml >= 15) { putLength(out, ml - 15); }
+}
+
+template<typename T> void put(std::vector<std::uint8_t>& out, const std::size_t pos, const T v)
+{
+    const T le = endian::convert<Order::Little>(v);
+    std::memcpy(out.data() + pos, &le, sizeof(T));
+}
+//
+}
+
+namespace pack
+{
+std::uint32_t hash(const char* s, std::size_t len)
+{
+    std::uint32_t h = 2166136261U;
+    while(len--) { h = (h ^ static_cast<std::uint8_t>(*s++)) * 16777619U; }
+    return h;
+}
+
+std::size_t decompressLZ4(const std::uint8_t* src, const std::size_t ssize, std::uint8_t* dst, const std::size_t dsize)
+{
+    std::size_t s = 0, d = 0;
+    while(s < ssize)
+    {
+        const std::uint8_t token = src[s++];
+        std::size_t lit = token >> 4;
+        if(lit == 15 && !getLength(src, ssize, s, lit)) { return 0; }
+        if(lit > ssize - s || lit > dsize - d) { return 0; }
+        std::memcpy(dst + d, src + s, lit);
+        s += lit;
+        d += lit;
+        if(s == ssize) { break; } // Last sequence has literals only.
+
+        if(ssize - s < 2) { return 0; }
+        const std::size_t offset = src[s] | (static_cast<std::size_t>(src[s + 1]) << 8);
+        s += 2;
+        if(offset == 0 || offset > d) { return 0; }
+        std::size_t ml = token & 0x0F;
+        if(ml == 15 && !getLength(src, ssize, s, ml)) { return 0; }
+        ml += MIN_MATCH;
+        if(ml > dsize - d) { return 0; }
+        const std::uint8_t* m = dst + d - offset;
+        if(offset >= ml) { std::memcpy(dst + d, m, ml); }
+        else { for(std::size_t i = 0; i < ml; ++i) { dst[d + i] = m[i]; } } // Overlapped
+        d += ml;
+    }
+    return d;
+}
+
+std::vector<std::uint8_t> compressLZ4(const std::uint8_t* src, const std::size_t ssize)
+{
+    std::vector<std::uint8_t> out;
+    if(!ssize) { return out; }
+    out.reserve(ssize + ssize / 255 + 16);
+
+    std::vector<std::size_t> table(1U << HASH_BITS, 0); // Position + 1 (0: empty)
+    const std::size_t mflimit = ssize > MATCH_LIMIT ? ssize - MATCH_LIMIT : 0;
+    const std::size_t mlimit = ssize - std::min(ssize, LAST_LITERALS);
+    std::size_t anchor = 0, i = 0;
+    while(i < mflimit)
+    {
+        const std::uint32_t seq = load32(src + i);
+        const std::size_t h = (seq * 2654435761U) >> (32 - HASH_BITS);
+        const std::size_t ref = table[h];
+        table[h] = i + 1;
+        if(ref && i - (ref - 1) <= MAX_OFFSET && load32(src + ref - 1) == seq)
+        {
+            const std::size_t r = ref - 1;
+            std::size_t len = MIN_MATCH;
+            while(i + len < mlimit && src[r + len] == src[i + len]) { ++len; }
+            emit(out, src + anchor, i - anchor, i - r, len);
+            i += len;
+            anchor = i;
+            continue;
+        }
+        ++i;
+    }
+    emit(out, src + anchor, ssize - anchor, 0, 0);
+    return out;
+}
+//
+}
+
+// ----------------------------------------------------------------------------
+// AssetStream
+void AssetStream::close()
+{
+    _src = nullptr;
+    _head = _size = _pos = 0;
+    _buffer.clear();
+    _buffer.shrink_to_fit();
+    _opened = false;
+}
+
+AssetStream::pos_type AssetStream::read(std::uint8_t* buf, std::size_t len)
+{
+    if(!_opened || is_tail() || len == 0) { return 0; }
+    auto clen = static_cast<std::size_t>(std::min(_size - _pos, static_cast<pos_type>(len)));
+    if(buffered())
+    {
+        std::memcpy(buf, _buffer.data() + _pos, clen);
+    }
+    else
+    {
+        if(!_src->seek(_head + _pos)) { return 0; }
+        clen = static_cast<std::size_t>(_src->read(buf, clen));
+    }
+    _pos += clen;
+    return clen;
+}
+
+StreamView AssetStream::view(std::size_t len)
+{
+    if(!_opened || is_tail()) { return StreamView{ nullptr, 0 }; }
+    auto clen = static_cast<std::size_t>(std::min(_size - _pos, static_cast<pos_type>(len)));
+    StreamView v{ nullptr, 0 };
+    if(buffered())
+    {
+        v = StreamView{ _buffer.data() + _pos, clen };
+    }
+    else
+    {
+        if(!_src->seek(_head + _pos)) { return v; }
+        v = _src->view(clen);
+    }
+    _pos += v.size;
+    return v;
+}
+
+bool AssetStream::seek(off_type off, seekdir s)
+{
+    if(!_opened) { return false; }
+    off_type base = 0;
+    switch(s)
+    {
+    case seekdir::beg: base = 0; break;
+    case seekdir::cur: base = static_cast<off_type>(_pos); break;
+    case seekdir::end: base = static_cast<off_type>(_size); break;
+    }
+    const off_type np = base + off;
+    if(np < 0 || np > static_cast<off_type>(_size)) { return false; }
+    _pos = static_cast<pos_type>(np);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// AssetPack
+bool AssetPack::assign(Stream* s)
+{
+    _stream = nullptr;
+    _header = pack::Header{};
+    _entries.clear();
+    _names.clear();
+    if(!s || !s->is_open() || s->size() < pack::Header::SIZE || !s->seek(0)) { return false; }
+
+    pack::Header h{};
+    h.magic = s->readValue<std::uint32_t, Order::Little>();
+    h.version = s->readValue<std::uint16_t, Order::Little>();
+    h.align = s->readValue<std::uint16_t, Order::Little>();
+    h.count = s->readValue<std::uint32_t, Order::Little>();
+    h.directory = s->readValue<std::uint32_t, Order::Little>();
+    h.names = s->readValue<std::uint32_t, Order::Little>();
+    h.namesSize = s->readValue<std::uint32_t, Order::Little>();
+    if(h.magic != pack::MAGIC || h.version != pack::VERSION) { return false; }
+    const auto fsize = s->size();
+    if(h.directory + static_cast<Stream::pos_type>(h.count) * pack::Entry::SIZE > fsize ||
+       h.names + static_cast<Stream::pos_type>(h.namesSize) > fsize) { return false; }
+
+    std::vector<std::uint8_t> dir(static_cast<std::size_t>(h.count) * pack::Entry::SIZE);
+    _names.resize(h.namesSize);
+    if(!s->seek(h.directory) || s->read(dir.data(), dir.size()) != dir.size()) { return false; }
+    if(!s->seek(h.names) || s->read(_names.data(), _names.size()) != _names.size()) { _names.clear(); return false; }
+
+    _entries.resize(h.count);
+    const std::uint8_t* p = dir.data();
+    for(auto& e : _entries)
+    {
+        std::memcpy(&e.hash, p + 0, 4);
+        std::memcpy(&e.name, p + 4, 4);
+        std::memcpy(&e.offset, p + 8, 4);
+        std::memcpy(&e.size, p + 12, 4);
+        std::memcpy(&e.rawSize, p + 16, 4);
+        std::memcpy(&e.nameLength, p + 20, 2);
+        std::memcpy(&e.flags, p + 22, 2);
+        e.hash = endian::convert<Order::Little>(e.hash);
+        e.name = endian::convert<Order::Little>(e.name);
+        e.offset = endian::convert<Order::Little>(e.offset);
+        e.size = endian::convert<Order::Little>(e.size);
+        e.rawSize = endian::convert<Order::Little>(e.rawSize);
+        e.nameLength = endian::convert<Order::Little>(e.nameLength);
+        e.flags = endian::convert<Order::Little>(e.flags);
+        p += pack::Entry::SIZE;
+        if(static_cast<std::uint64_t>(e.name) + e.nameLength > h.namesSize ||
+           static_cast<std::uint64_t>(e.offset) + e.size > fsize)
+        {
+            _entries.clear();
+            _names.clear();
+            return false;
+        }
+    }
+    _header = h;
+    _stream = s;
+    return true;
+}
+
+bool AssetPack::matchName(const pack::Entry& e, const char* name, const std::size_t len) const
+{
+    return e.nameLength == len && std::memcmp(_names.data() + e.name, name, len) == 0;
+}
+
+std::size_t AssetPack::find(const char* name) const
+{
+    if(!name) { return npos; }
+    const std::size_t len = std::strlen(name);
+    const std::uint32_t h = pack::hash(name, len);
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), h, [](const pack::Entry& e, const std::uint32_t v)
+    {
+        return e.hash < v;
+    });
+    for(; it != _entries.end() && it->hash == h; ++it)
+    {
+        if(matchName(*it, name, len)) { return static_cast<std::size_t>(it - _entries.begin()); }
+    }
+    return npos;
+}
+
+std::string AssetPack::name(const std::size_t idx) const
+{
+    assert(idx < _entries.size() && "Index out of range");
+    const auto& e = _entries[idx];
+    return std::string(_names.data() + e.name, e.nameLength);
+}
+
+bool AssetPack::open(const std::size_t idx, AssetStream& as) const
+{
+    as.close();
+    if(!valid() || idx >= _entries.size()) { return false; }
+    const auto& e = _entries[idx];
+    if(e.compressed())
+    {
+        if(!_stream->seek(e.offset)) { return false; }
+        std::vector<std::uint8_t> tmp;
+        StreamView v = _stream->view(e.size);
+        if(v.size != e.size)
+        {
+            // Stream does not support view.
+            if(!_stream->seek(e.offset)) { return false; }
+            tmp.resize(e.size);
+            if(_stream->read(tmp.data(), tmp.size()) != tmp.size()) { return false; }
+            v = StreamView{ tmp.data(), tmp.size() };
+        }
+        as._buffer.resize(e.rawSize);
+        if(pack::decompressLZ4(v.data, v.size, as._buffer.data(), as._buffer.size()) != e.rawSize)
+        {
+            as.close();
+            return false;
+        }
+    }
+    as._src = _stream;
+    as._head = e.offset;
+    as._size = e.rawSize;
+    as._pos = 0;
+    as._opened = true;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// AssetPackWriter
+AssetPackWriter::AssetPackWriter(std::uint16_t align) : _align(align ? align : 1), _items()
+{
+    assert(!(_align & (_align - 1)) && "align must be power of 2");
+}
+
+bool AssetPackWriter::add(const char* name, const void* data, std::size_t size, bool compress)
+{
+    assert(name && "name must not be nullptr");
+    assert(std::strlen(name) <= std::numeric_limits<std::uint16_t>::max() && "name too long");
+    assert(size <= std::numeric_limits<std::uint32_t>::max() && "data too large");
+    if(std::any_of(_items.begin(), _items.end(), [name](const Item& i) { return i.name == name; })) { return false; }
+
+    Item item{ name, pack::hash(name), static_cast<std::uint32_t>(size), false, {} };
+    const std::uint8_t* src = static_cast<const std::uint8_t*>(data);
+    if(compress && size)
+    {
+        item.data = pack::compressLZ4(src, size);
+        item.compressed = item.data.size() < size;
+    }
+    if(!item.compressed) { item.data.assign(src, src + size); }
+    _items.push_back(std::move(item));
+    return true;
+}
+
+std::vector<std::uint8_t> AssetPackWriter::build() const
+{
+    std::vector<const Item*> sorted;
+    sorted.reserve(_items.size());
+    for(auto& i : _items) { sorted.push_back(&i); }
+    std::sort(sorted.begin(), sorted.end(), [](const Item* a, const Item* b)
+    {
+        return a->hash != b->hash ? a->hash < b->hash : a->name < b->name;
+    });
+
+    const std::size_t directory = pack::Header::SIZE;
+    const std::size_t names = directory + sorted.size() * pack::Entry::SIZE;
+    std::size_t namesSize = 0;
+    for(auto i : sorted) { namesSize += i->name.size(); }
+
+    auto aligned = [this](const std::size_t v) { return (v + _align - 1) & ~static_cast<std::size_t>(_align - 1); };
+    std::size_t total = aligned(names + namesSize);
+    for(auto i : sorted) { total = aligned(total + i->data.size()); }
+    assert(total <= std::numeric_limits<std::uint32_t>::max() && "pack too large");
+
+    std::vector<std::uint8_t> out(total, 0);
+    put<std::uint32_t>(out, 0, pack::MAGIC);
+    put<std::uint16_t>(out, 4, pack::VERSION);
+    put<std::uint16_t>(out, 6, _align);
+    put<std::uint32_t>(out, 8, static_cast<std::uint32_t>(sorted.size()));
+    put<std::uint32_t>(out, 12, static_cast<std::uint32_t>(directory));
+    put<std::uint32_t>(out, 16, static_cast<std::uint32_t>(names));
+    put<std::uint32_t>(out, 20, static_cast<std::uint32_t>(namesSize));
+
+    std::size_t noff = names;
+    std::size_t dpos = aligned(names + namesSize);
+    std::size_t epos = directory;
+    for(auto i : sorted)
+    {
+        put<std::uint32_t>(out, epos + 0, i->hash);
+        put<std::uint32_t>(out, epos + 4, static_cast<std::uint32_t>(noff - names));
+        put<std::uint32_t>(out, epos + 8, static_cast<std::uint32_t>(dpos));
+        put<std::uint32_t>(out, epos + 12, static_cast<std::uint32_t>(i->data.size()));
+        put<std::uint32_t>(out, epos + 16, i->rawSize);
+        put<std::uint16_t>(out, epos + 20, static_cast<std::uint16_t>(i->name.size()));
+        put<std::uint16_t>(out, epos + 22, static_cast<std::uint16_t>(i->compressed ? pack::Flag::LZ4 : 0));
+        epos += pack::Entry::SIZE;
+
+        std::memcpy(out.data() + noff, i->name.data(), i->name.size());
+        noff += i->name.size();
+        if(!i->data.empty()) { std::memcpy(out.data() + dpos, i->data.data(), i->data.size()); }
+        dpos = aligned(dpos + i->data.size());
+    }
+    return out;
+}
+
+//
+}
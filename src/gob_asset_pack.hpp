@@ -0,0 +1,246 @@
+/*!
+  Goblin Library
+
+  @file   gob_asset_pack.hpp
+  @brief  Indexed asset pack archive over Stream.
+*/
+#pragma once
+#ifndef GOBLIB_ASSET_PACK_HPP
+#define GOBLIB_ASSET_PACK_HPP
+
+#include "gob_macro.hpp"
+#include "gob_stream.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+
+namespace goblib
+{
+
+/*!
+  @brief Asset pack archive format.
+  @details All values are little endian.
+  |Offset|Contents|
+  |---|---|
+  |0|Header|
+  |Header::directory|Entry x Header::count (Sorted by hash, name)|
+  |Header::names|Name table (Not terminated)|
+  |Entry::offset|Data of entry (Aligned by Header::align)|
+*/
+namespace pack
+{
+constexpr std::uint32_t MAGIC = 0x4B415047; //!< "GPAK"
+constexpr std::uint16_t VERSION = 1;
+
+/*! @brief Entry flags */
+enum Flag : std::uint16_t
+{
+    LZ4 = 0x0001, //!< Data is compressed by LZ4 block format.
+};
+
+/*! @brief Pack header */
+struct Header
+{
+    std::uint32_t magic;        //!< MAGIC
+    std::uint16_t version;      //!< VERSION
+    std::uint16_t align;        //!< Alignment of entry data (Power of 2)
+    std::uint32_t count;        //!< Number of entries
+    std::uint32_t directory;    //!< Offset of directory
+    std::uint32_t names;        //!< Offset of name table
+    std::uint32_t namesSize;    //!< Size of name table
+    constexpr static std::size_t SIZE = 24;
+};
+
+/*! @brief Directory entry */
+struct Entry
+{
+    std::uint32_t hash;     //!< hash() of name
+    std::uint32_t name;     //!< Offset of name in name table
+    std::uint32_t offset;   //!< Offset of data from head of pack
+    std::uint32_t size;     //!< Stored size
+    std::uint32_t rawSize;  //!< Size after decompression (Same as size if not compressed)
+    std::uint16_t nameLength; //!< Length of name
+    std::uint16_t flags;    //!< Flag
+    constexpr static std::size_t SIZE = 24;
+    GOBLIB_INLINE bool compressed() const { return flags & Flag::LZ4; }
+};
+
+/// @cond
+namespace detail
+{
+constexpr std::uint32_t fnv1a(const char* s, const std::uint32_t h)
+{
+    return *s ? fnv1a(s + 1, (h ^ static_cast<std::uint8_t>(*s)) * 16777619U) : h;
+}
+//
+}
+/// @endcond
+
+/*! @brief Hash of entry name (FNV-1a 32bit) */
+constexpr std::uint32_t hash(const char* s) { return detail::fnv1a(s, 2166136261U); }
+/*! @brief Hash of entry name (FNV-1a 32bit) */
+std::uint32_t hash(const char* s, std::size_t len);
+
+/*!
+  @brief Decompress LZ4 block
+  @return Decompressed size, or 0 if failed. (Malformed or insufficient dst)
+*/
+std::size_t decompressLZ4(const std::uint8_t* src, std::size_t ssize, std::uint8_t* dst, std::size_t dsize);
+/*!
+  @brief Compress LZ4 block
+  @return Compressed data. (Empty if src is empty)
+*/
+std::vector<std::uint8_t> compressLZ4(const std::uint8_t* src, std::size_t ssize);
+//
+}
+
+/*!
+  @brief Stream of entry in AssetPack.
+  @details Reads sub-range of the stream of pack. Compressed entry is decompressed into own buffer on open.<br>
+  view() is zero-copy into the pack if the stream of pack supports view (e.g. MappedFileStream, MemoryStream).
+  @note Shares and seeks the stream of pack, so streams of the same pack must not be used from multiple threads.
+*/
+class AssetStream : public Stream
+{
+  public:
+    using pos_type = typename Stream::pos_type;
+    using off_type = typename Stream::off_type;
+
+    AssetStream() : Stream(), _src(nullptr), _head(0), _size(0), _pos(0), _buffer(), _opened(false) {}
+    virtual ~AssetStream() {}
+
+    /// @name Open, Close
+    /// @{
+    virtual bool is_open() const override { return _opened; }
+    /*! @brief Not supported (Use AssetPack::open) */
+    virtual bool open(const char* /*path*/) override { return false; }
+    virtual void close() override;
+    /// @}
+
+    /// @name Property
+    /// @{
+    virtual pos_type size() const override { return _size; }
+    /*! @brief Is decompressed into own buffer? */
+    bool buffered() const { return !_buffer.empty(); }
+    /// @}
+
+    /// @name Read
+    /// @{
+    template<typename U> pos_type read(U buf, std::size_t len)
+    {
+        return read(reinterpret_cast<std::uint8_t*>(buf), len);
+    }
+    virtual pos_type read(std::uint8_t* buf, std::size_t len) override;
+    virtual StreamView view(std::size_t len) override;
+    /// @}
+
+    /// @name Seek
+    /// @{
+    virtual bool seek(off_type off, seekdir s) override;
+    virtual pos_type position() const override { return _pos; }
+    virtual bool is_tail() const override { return _pos >= _size; }
+    /// @}
+
+  private:
+    friend class AssetPack;
+
+    Stream* _src;
+    pos_type _head, _size, _pos;
+    std::vector<std::uint8_t> _buffer; // Decompressed data
+    bool _opened;
+};
+
+/*!
+  @brief Reader of asset pack.
+  @details Loads header and directory on open. Lookup is binary search of name hash. (O(log n))
+@code
+goblib::MappedFileStream file("/assets.gpk");
+goblib::AssetPack pack(&file);
+goblib::AssetStream s;
+if(pack.open("se/jump.wav", s))
+{
+    goblib::PcmStream pcm(&s);
+}
+@endcode
+*/
+class AssetPack
+{
+  public:
+    constexpr static std::size_t npos = static_cast<std::size_t>(-1);
+
+    AssetPack() : _stream(nullptr), _header{}, _entries(), _names() {}
+    /*! @brief Assign stream of pack */
+    explicit AssetPack(Stream* s) : AssetPack() { assign(s); }
+
+    /*! @brief Assign stream of pack and load directory */
+    bool assign(Stream* s);
+    bool valid() const { return _stream != nullptr; }
+
+    /// @name Directory
+    /// @{
+    std::size_t size() const { return _entries.size(); }
+    /*! @brief Index of entry (npos if not exists) */
+    std::size_t find(const char* name) const;
+    const pack::Entry& entry(const std::size_t idx) const { return _entries[idx]; }
+    /*! @brief Name of entry */
+    std::string name(const std::size_t idx) const;
+    /// @}
+
+    /// @name Open
+    /// @{
+    /*! @brief Open entry as stream */
+    bool open(const char* name, AssetStream& as) const { return open(find(name), as); }
+    bool open(const std::size_t idx, AssetStream& as) const;
+    /// @}
+
+  private:
+    bool matchName(const pack::Entry& e, const char* name, std::size_t len) const;
+
+    Stream* _stream;
+    pack::Header _header;
+    std::vector<pack::Entry> _entries;
+    std::vector<char> _names;
+};
+
+/*!
+  @brief Builds asset pack.
+@code
+goblib::AssetPackWriter w;
+w.add("se/jump.wav", wav.data(), wav.size());
+w.add("map/1-1.bin", map.data(), map.size(), true); // Compress
+std::vector<std::uint8_t> out = w.build();
+@endcode
+*/
+class AssetPackWriter
+{
+  public:
+    /*! @param align Alignment of entry data (Power of 2) */
+    explicit AssetPackWriter(std::uint16_t align = 4);
+
+    /*!
+      @brief Add entry
+      @param compress Compress by LZ4 (Stored uncompressed if not smaller)
+      @retval false Same name already exists
+    */
+    bool add(const char* name, const void* data, std::size_t size, bool compress = false);
+    std::size_t size() const { return _items.size(); }
+    /*! @brief Build pack */
+    std::vector<std::uint8_t> build() const;
+
+  private:
+    struct Item
+    {
+        std::string name;
+        std::uint32_t hash;
+        std::uint32_t rawSize;
+        bool compressed;
+        std::vector<std::uint8_t> data;
+    };
+    std::uint16_t _align;
+    std::vector<Item> _items;
+};
+
+//
+}
+#endif
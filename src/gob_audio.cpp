@@ -0,0 +1,508 @@
+/*!
+  Goblin Library
+
+  @file   gob_audio.cpp
+  @brief  Streaming PCM decoder, resampler and mixer.
+*/
+#include "gob_audio.hpp"
+#include "gob_math.hpp"
+#include <cstring>
+#include <cmath>
+
+/// @cond
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define GOBLIB_AUDIO_SSE2
+# include <emmintrin.h>
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+# define GOBLIB_AUDIO_NEON
+# include <arm_neon.h>
+#endif
+
+// Conversion kernel for Sample
+#if defined(GOBLIB_AUDIO_FIXED_POINT)
+# define GOBLIB_AUDIO_KERNEL(src) goblib::audio::kernel::src##_to_fixed
+#else
+# define GOBLIB_AUDIO_KERNEL(src) goblib::audio::kernel::src##_to_float
+#endif
+/// @endcond
+
+namespace goblib { namespace audio {
+
+namespace kernel
+{
+
+void u8_to_float(float* dst, const std::uint8_t* src, const std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(GOBLIB_AUDIO_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+    for(; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i w[2] = { _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), bias), _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), bias) };
+        for(int k = 0; k < 2; ++k)
+        {
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(w[k], w[k]), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(w[k], w[k]), 16);
+            _mm_storeu_ps(dst + i + k * 8,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(dst + i + k * 8 + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+    }
+#elif defined(GOBLIB_AUDIO_NEON)
+    for(; i + 8 <= n; i += 8)
+    {
+        int16x8_t w = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src + i))), vdupq_n_s16(128));
+        vst1q_f32(dst + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(w))),  1.0f / 128.0f));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(w))), 1.0f / 128.0f));
+    }
+#endif
+    for(; i < n; ++i)
+    {
+        dst[i] = (static_cast<int>(src[i]) - 128) * (1.0f / 128.0f);
+    }
+}
+
+void s16_to_float(float* dst, const std::uint8_t* src, const std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(GOBLIB_AUDIO_SSE2)
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    for(; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#elif defined(GOBLIB_AUDIO_NEON)
+    for(; i + 8 <= n; i += 8)
+    {
+        int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(src + i * 2));
+        vst1q_f32(dst + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))),  1.0f / 32768.0f));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), 1.0f / 32768.0f));
+    }
+#endif
+    for(; i < n; ++i)
+    {
+        const std::uint8_t* s = src + i * 2;
+        dst[i] = static_cast<std::int16_t>(s[0] | (s[1] << 8)) * (1.0f / 32768.0f);
+    }
+}
+
+void s24_to_float(float* dst, const std::uint8_t* src, const std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint8_t* s = src + i * 3;
+        // Place to upper 24 bits, so that the sign is extended.
+        std::uint32_t u = (static_cast<std::uint32_t>(s[0]) << 8) | (static_cast<std::uint32_t>(s[1]) << 16) | (static_cast<std::uint32_t>(s[2]) << 24);
+        dst[i] = static_cast<std::int32_t>(u) * (1.0f / 2147483648.0f);
+    }
+}
+
+void s32_to_float(float* dst, const std::uint8_t* src, const std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint8_t* s = src + i * 4;
+        std::uint32_t u = s[0] | (static_cast<std::uint32_t>(s[1]) << 8) | (static_cast<std::uint32_t>(s[2]) << 16) | (static_cast<std::uint32_t>(s[3]) << 24);
+        dst[i] = static_cast<std::int32_t>(u) * (1.0f / 2147483648.0f);
+    }
+}
+
+void f32_to_float(float* dst, const std::uint8_t* src, const std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint8_t* s = src + i * 4;
+        std::uint32_t u = s[0] | (static_cast<std::uint32_t>(s[1]) << 8) | (static_cast<std::uint32_t>(s[2]) << 16) | (static_cast<std::uint32_t>(s[3]) << 24);
+        std::memcpy(dst + i, &u, sizeof(float));
+    }
+}
+
+void mix_add(float* dst, const float* src, const float gain, const std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(GOBLIB_AUDIO_SSE2)
+    const __m128 g = _mm_set1_ps(gain);
+    for(; i + 4 <= n; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+    }
+#elif defined(GOBLIB_AUDIO_NEON)
+    for(; i + 4 <= n; i += 4)
+    {
+        vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
+    }
+#endif
+    for(; i < n; ++i) { dst[i] += src[i] * gain; }
+}
+
+void float_to_s16(std::int16_t* dst, const float* src, const std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(GOBLIB_AUDIO_SSE2)
+    const __m128 hi = _mm_set1_ps(1.0f), lo = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(32767.0f);
+    for(; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i),     hi), lo), scale);
+        __m128 b = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i + 4), hi), lo), scale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#elif defined(GOBLIB_AUDIO_NEON)
+    for(; i + 8 <= n; i += 8)
+    {
+        float32x4_t a = vmulq_n_f32(vmaxq_f32(vminq_f32(vld1q_f32(src + i),     vdupq_n_f32(1.0f)), vdupq_n_f32(-1.0f)), 32767.0f);
+        float32x4_t b = vmulq_n_f32(vmaxq_f32(vminq_f32(vld1q_f32(src + i + 4), vdupq_n_f32(1.0f)), vdupq_n_f32(-1.0f)), 32767.0f);
+# if defined(__aarch64__)
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+# else
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)), vqmovn_s32(vcvtq_s32_f32(b))));
+# endif
+    }
+#endif
+    for(; i < n; ++i)
+    {
+        float v = goblib::clamp(src[i], -1.0f, 1.0f) * 32767.0f;
+        dst[i] = static_cast<std::int16_t>(v >= 0.0f ? v + 0.5f : v - 0.5f);
+    }
+}
+
+// Fixed point (Integer arithmetic only, except f32_to_fixed)
+namespace
+{
+constexpr std::size_t FIXED_FRACTION = Fixed::FRACTION;
+GOBLIB_INLINE Fixed raw_fixed(const std::int32_t v) { return Fixed::from_raw(v); }
+//
+}
+
+void u8_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        dst[i] = raw_fixed((static_cast<std::int32_t>(src[i]) - 128) * (1 << (FIXED_FRACTION - 7)));
+    }
+}
+
+void s16_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint8_t* s = src + i * 2;
+        dst[i] = raw_fixed(static_cast<std::int16_t>(s[0] | (s[1] << 8)) * (1 << (FIXED_FRACTION - 15)));
+    }
+}
+
+void s24_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint8_t* s = src + i * 3;
+        std::uint32_t u = (static_cast<std::uint32_t>(s[0]) << 8) | (static_cast<std::uint32_t>(s[1]) << 16) | (static_cast<std::uint32_t>(s[2]) << 24);
+        dst[i] = raw_fixed(static_cast<std::int32_t>(u) >> (31 - FIXED_FRACTION));
+    }
+}
+
+void s32_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint8_t* s = src + i * 4;
+        std::uint32_t u = s[0] | (static_cast<std::uint32_t>(s[1]) << 8) | (static_cast<std::uint32_t>(s[2]) << 16) | (static_cast<std::uint32_t>(s[3]) << 24);
+        dst[i] = raw_fixed(static_cast<std::int32_t>(u) >> (31 - FIXED_FRACTION));
+    }
+}
+
+void f32_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n)
+{
+    constexpr float lim = 1 << (31 - FIXED_FRACTION - 1); // Headroom of Fixed
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint8_t* s = src + i * 4;
+        std::uint32_t u = s[0] | (static_cast<std::uint32_t>(s[1]) << 8) | (static_cast<std::uint32_t>(s[2]) << 16) | (static_cast<std::uint32_t>(s[3]) << 24);
+        float f;
+        std::memcpy(&f, &u, sizeof(float));
+        dst[i] = Fixed(goblib::clamp(f, -lim, lim));
+    }
+}
+
+void mix_add(Fixed* dst, const Fixed* src, const Fixed gain, const std::size_t n)
+{
+    const std::int64_t g = gain.raw();
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        dst[i] = raw_fixed(dst[i].raw() + static_cast<std::int32_t>((src[i].raw() * g) >> FIXED_FRACTION));
+    }
+}
+
+void fixed_to_s16(std::int16_t* dst, const Fixed* src, const std::size_t n)
+{
+    constexpr std::int32_t half = (FIXED_FRACTION > 15) ? (1 << (FIXED_FRACTION - 16)) : 0;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const std::int32_t v = (src[i].raw() + half) >> (FIXED_FRACTION - 15);
+        dst[i] = static_cast<std::int16_t>(goblib::clamp<std::int32_t>(v, -32768, 32767));
+    }
+}
+
+//
+}
+
+constexpr std::size_t PcmDecoder::RAW_SIZE;
+
+bool PcmDecoder::assign(PcmStream* pcm)
+{
+    _pcm = pcm;
+    _convert = nullptr;
+    if(!pcm || !pcm->valid() || pcm->blockAlign() > RAW_SIZE) { return false; }
+
+    switch(pcm->formatTag())
+    {
+    case wave::fmtSubChunk::WAVE_FORMAT_PCM:
+        switch(pcm->bitsPerSample())
+        {
+        case 8:  _convert = GOBLIB_AUDIO_KERNEL(u8);  break;
+        case 16: _convert = GOBLIB_AUDIO_KERNEL(s16); break;
+        case 24: _convert = GOBLIB_AUDIO_KERNEL(s24); break;
+        case 32: _convert = GOBLIB_AUDIO_KERNEL(s32); break;
+        default: break;
+        }
+        break;
+    case wave::fmtSubChunk::WAVE_FORMAT_IEEE_FLOAT:
+        if(pcm->bitsPerSample() == 32) { _convert = GOBLIB_AUDIO_KERNEL(f32); }
+        break;
+    default:
+        break;
+    }
+    return _convert != nullptr;
+}
+
+std::size_t PcmDecoder::decode(Sample* out, const std::size_t frames)
+{
+    if(!valid()) { return 0; }
+    const std::size_t ba = _pcm->blockAlign();
+    const std::size_t ch = _pcm->channels();
+    std::size_t done = 0;
+    while(done < frames && !_pcm->is_tail())
+    {
+        const std::size_t want = (frames - done) * ba;
+        // Zero-copy if supported.
+        StreamView v = _pcm->view(want);
+        const std::uint8_t* src = v.data;
+        std::size_t bytes = v.size;
+        if(!src)
+        {
+            bytes = _pcm->read(_raw, std::min(want, RAW_SIZE / ba * ba));
+            src = _raw;
+        }
+        const std::size_t n = bytes / ba;
+        if(!n) { break; } // Incomplete frame at tail.
+        _convert(out + done * ch, src, n * ch);
+        done += n;
+    }
+    return done;
+}
+
+constexpr std::size_t Resampler::MAX_CHANNELS;
+constexpr std::size_t Resampler::BLOCK;
+constexpr std::size_t Resampler::TAPS;
+constexpr std::size_t Resampler::PHASES;
+
+namespace
+{
+// Position between input frames (frac / outRate) as weight and FIR phase.
+// invOut is 1.0f / outRate, invOutQ is 2^32 / outRate (frac < outRate, so frac * invOutQ < 2^32)
+GOBLIB_INLINE float weight(const float*, const std::uint32_t frac, const float invOut, const std::uint64_t)
+{
+    return frac * invOut;
+}
+GOBLIB_INLINE Fixed weight(const Fixed*, const std::uint32_t frac, const float, const std::uint64_t invOutQ)
+{
+    return Fixed::from_raw(static_cast<std::int32_t>((frac * invOutQ) >> (32 - Fixed::FRACTION)));
+}
+GOBLIB_INLINE std::size_t phase(const float*, const std::uint32_t frac, const float invOut, const std::uint64_t)
+{
+    return std::min(static_cast<std::size_t>(frac * invOut * Resampler::PHASES), Resampler::PHASES - 1);
+}
+GOBLIB_INLINE std::size_t phase(const Fixed*, const std::uint32_t frac, const float, const std::uint64_t invOutQ)
+{
+    return std::min(static_cast<std::size_t>((frac * invOutQ * Resampler::PHASES) >> 32), Resampler::PHASES - 1);
+}
+
+// Linear interpolation of CH channels.
+template<std::size_t CH, typename S> std::size_t resample_linear(S* out, const std::size_t frames, const S* buf, std::size_t& pos, const std::size_t count,
+                                                                 std::uint32_t& frac, const std::uint32_t stepInt, const std::uint32_t stepFrac, const std::uint32_t outRate,
+                                                                 const float invOut, const std::uint64_t invOutQ)
+{
+    std::size_t n = 0;
+    while(n < frames && pos + 2 <= count)
+    {
+        const S w = weight(buf, frac, invOut, invOutQ);
+        const S* a = buf + pos * CH;
+        for(std::size_t c = 0; c < CH; ++c) { out[c] = a[c] + (a[c + CH] - a[c]) * w; }
+        out += CH;
+        ++n;
+        pos += stepInt;
+        frac += stepFrac;
+        if(frac >= outRate) { frac -= outRate; ++pos; }
+    }
+    return n;
+}
+
+// Polyphase FIR of CH channels.
+template<std::size_t CH, typename S> std::size_t resample_fir(S* out, const std::size_t frames, const S* buf, std::size_t& pos, const std::size_t count,
+                                                              std::uint32_t& frac, const std::uint32_t stepInt, const std::uint32_t stepFrac, const std::uint32_t outRate,
+                                                              const float invOut, const std::uint64_t invOutQ, const S* table)
+{
+    constexpr std::size_t TAPS = Resampler::TAPS;
+    std::size_t n = 0;
+    while(n < frames && pos + TAPS <= count)
+    {
+        const S* h = table + phase(buf, frac, invOut, invOutQ) * TAPS;
+        const S* a = buf + pos * CH;
+        S acc[CH] = {};
+        for(std::size_t k = 0; k < TAPS; ++k)
+        {
+            for(std::size_t c = 0; c < CH; ++c) { acc[c] += a[k * CH + c] * h[k]; }
+        }
+        for(std::size_t c = 0; c < CH; ++c) { out[c] = acc[c]; }
+        out += CH;
+        ++n;
+        pos += stepInt;
+        frac += stepFrac;
+        if(frac >= outRate) { frac -= outRate; ++pos; }
+    }
+    return n;
+}
+//
+}
+
+bool Resampler::assign(PcmStream* pcm, const std::uint32_t rate, const Quality q)
+{
+    _inRate = _outRate = 0;
+    if(!_decoder.assign(pcm) || _decoder.channels() > MAX_CHANNELS || !_decoder.sampleRate()) { return false; }
+
+    _quality = q;
+    _inRate = _decoder.sampleRate();
+    _outRate = rate ? rate : _inRate;
+    _stepInt = _inRate / _outRate;
+    _stepFrac = _inRate % _outRate;
+    _invOut = 1.0f / _outRate;
+    _invOutQ = (static_cast<std::uint64_t>(1) << 32) / _outRate;
+    if(!passThrough() && _quality == Quality::Fir) { makeTable(); }
+    reset();
+    return true;
+}
+
+bool Resampler::rewind()
+{
+    if(!_decoder.rewind()) { return false; }
+    reset();
+    return true;
+}
+
+void Resampler::reset()
+{
+    // History of zero frames, so that the first output is the first input frame.
+    _frac = 0;
+    _pos = 0;
+    _count = taps() / 2 - 1;
+    _flushed = false;
+    std::fill(_buf, _buf + _count * MAX_CHANNELS, Sample(0));
+}
+
+// Move the window to head and append frames. Return false if no frames are appended.
+bool Resampler::refill()
+{
+    const std::size_t ch = channels();
+    std::size_t keep = _count > _pos ? _count - _pos : 0;
+    std::copy(_buf + _pos * ch, _buf + (_pos + keep) * ch, _buf);
+    if(_pos > _count) { _pos -= _count; } // Skipped frames that are not decoded yet.
+    else { _pos = 0; }
+    _count = keep;
+
+    while(_pos > _count) // Skip without output (Large step)
+    {
+        std::size_t n = _decoder.decode(_buf, std::min<std::size_t>(_pos - _count, BLOCK));
+        if(!n) { break; }
+        _pos -= n;
+    }
+
+    const std::size_t space = BLOCK + TAPS - _count;
+    std::size_t n = _decoder.decode(_buf + _count * ch, space);
+    if(!n && !_flushed)
+    {
+        // Zero frames after tail, so that the last input frame is output.
+        n = std::min(taps() / 2, space);
+        std::fill(_buf + _count * ch, _buf + (_count + n) * ch, Sample(0));
+        _flushed = true;
+    }
+    _count += n;
+    return n > 0;
+}
+
+void Resampler::makeTable()
+{
+    if(!_table) { _table.reset(new Sample[PHASES * TAPS]); }
+    const double pi = goblib::math::constants::pi_d;
+    // Cutoff by the lower Nyquist frequency. (Normalized to input rate)
+    const double fc = std::min(1.0, static_cast<double>(_outRate) / _inRate);
+    const double center = TAPS / 2 - 1;
+    for(std::size_t p = 0; p < PHASES; ++p)
+    {
+        double h[TAPS];
+        double sum = 0.0;
+        for(std::size_t k = 0; k < TAPS; ++k)
+        {
+            const double t = k - center - static_cast<double>(p) / PHASES;
+            const double x = pi * fc * t;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(x) / x;
+            // Blackman window over (-TAPS/2, TAPS/2)
+            const double wpos = (t + TAPS / 2.0) / TAPS;
+            const double win = 0.42 - 0.5 * std::cos(2.0 * pi * wpos) + 0.08 * std::cos(4.0 * pi * wpos);
+            const double v = fc * sinc * win;
+            h[k] = v;
+            sum += v;
+        }
+        // Unity gain at DC
+        Sample* dst = _table.get() + p * TAPS;
+        for(std::size_t k = 0; k < TAPS; ++k) { dst[k] = static_cast<Sample>(h[k] / sum); }
+    }
+}
+
+std::size_t Resampler::decode(Sample* out, const std::size_t frames)
+{
+    if(!valid()) { return 0; }
+    if(passThrough()) { return _decoder.decode(out, frames); }
+
+    const std::size_t ch = channels();
+    const std::size_t K = taps();
+    std::size_t done = 0;
+    while(done < frames)
+    {
+        if(_pos + K > _count)
+        {
+            if(!refill()) { break; }
+            continue;
+        }
+        Sample* o = out + done * ch;
+        const std::size_t rest = frames - done;
+        if(_quality == Quality::Fir)
+        {
+            done += (ch == 1) ? resample_fir<1>(o, rest, _buf, _pos, _count, _frac, _stepInt, _stepFrac, _outRate, _invOut, _invOutQ, _table.get())
+                    :           resample_fir<2>(o, rest, _buf, _pos, _count, _frac, _stepInt, _stepFrac, _outRate, _invOut, _invOutQ, _table.get());
+        }
+        else
+        {
+            done += (ch == 1) ? resample_linear<1>(o, rest, _buf, _pos, _count, _frac, _stepInt, _stepFrac, _outRate, _invOut, _invOutQ)
+                    :           resample_linear<2>(o, rest, _buf, _pos, _count, _frac, _stepInt, _stepFrac, _outRate, _invOut, _invOutQ);
+        }
+    }
+    return done;
+}
+
+//
+}}
@@ -0,0 +1,400 @@
+/*!
+  Goblin Library
+
+  @file   gob_audio.hpp
+  @brief  Streaming PCM decoder, resampler and mixer.
+*/
+#pragma once
+#ifndef GOBLIB_AUDIO_HPP
+#define GOBLIB_AUDIO_HPP
+
+#include "gob_pcm_stream.hpp"
+#include "gob_ring_buffer.hpp"
+#include "gob_utility.hpp"
+#include "gob_fixed_point_number.hpp"
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <cassert>
+
+namespace goblib
+{
+/*!
+  @brief Audio pipeline
+  @details PcmStream -> PcmDecoder (Sample) -> Mixer -> SpscRingBuffer (int16_t stereo) -> output callback.
+*/
+namespace audio
+{
+/*! @brief Fixed point sample (Q15, with headroom for mixing) */
+using Fixed = goblib::FixedPointNumber<std::int32_t, 15>;
+
+/*!
+  @typedef Sample
+  @brief Internal sample type in [-1.0, 1.0]
+  @details float, or Fixed if GOBLIB_AUDIO_FIXED_POINT is defined. (For FPU-less targets)<br>
+  In fixed point, decoding, resampling and mixing are integer arithmetic.
+  Float is used only for IEEE float sources, gains (once per block) and the FIR table (on assign).
+*/
+#if defined(GOBLIB_AUDIO_FIXED_POINT)
+using Sample = Fixed;
+#else
+using Sample = float;
+#endif
+
+/*!
+  @brief Block-wise sample conversion kernels.
+  @details Samples are in [-1.0, 1.0]. Float kernels use SSE2 or NEON if available.
+*/
+namespace kernel
+{
+/// @name To float
+/// @{
+/*! @brief Unsigned 8-bit */
+void u8_to_float(float* dst, const std::uint8_t* src, const std::size_t n);
+/*! @brief Signed 16-bit little endian */
+void s16_to_float(float* dst, const std::uint8_t* src, const std::size_t n);
+/*! @brief Signed 24-bit little endian (packed) */
+void s24_to_float(float* dst, const std::uint8_t* src, const std::size_t n);
+/*! @brief Signed 32-bit little endian */
+void s32_to_float(float* dst, const std::uint8_t* src, const std::size_t n);
+/*! @brief IEEE float little endian (src need not be aligned) */
+void f32_to_float(float* dst, const std::uint8_t* src, const std::size_t n);
+/// @}
+
+/// @name To Fixed
+/// @{
+/*! @brief Unsigned 8-bit */
+void u8_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n);
+/*! @brief Signed 16-bit little endian */
+void s16_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n);
+/*! @brief Signed 24-bit little endian (packed) */
+void s24_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n);
+/*! @brief Signed 32-bit little endian */
+void s32_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n);
+/*! @brief IEEE float little endian (Uses float) */
+void f32_to_fixed(Fixed* dst, const std::uint8_t* src, const std::size_t n);
+/// @}
+
+/// @name Mix
+/// @{
+/*! @brief dst[i] += src[i] * gain */
+void mix_add(float* dst, const float* src, const float gain, const std::size_t n);
+/*! @brief dst[i] += src[i] * gain */
+void mix_add(Fixed* dst, const Fixed* src, const Fixed gain, const std::size_t n);
+/*! @brief Float to signed 16-bit with saturation */
+void float_to_s16(std::int16_t* dst, const float* src, const std::size_t n);
+/*! @brief Fixed to signed 16-bit with saturation (16-bit source is restored exactly) */
+void fixed_to_s16(std::int16_t* dst, const Fixed* src, const std::size_t n);
+GOBLIB_INLINE void to_s16(std::int16_t* dst, const float* src, const std::size_t n) { float_to_s16(dst, src, n); }
+GOBLIB_INLINE void to_s16(std::int16_t* dst, const Fixed* src, const std::size_t n) { fixed_to_s16(dst, src, n); }
+/// @}
+//
+}
+
+/*!
+  @brief Decode PCM data of PcmStream to Sample.
+  @details Supports 8/16/24/32-bit PCM and 32-bit IEEE float.<br>
+  Uses zero-copy Stream::view() if the stream supports it, otherwise reads through internal buffer.
+*/
+class PcmDecoder
+{
+  public:
+    constexpr static std::size_t RAW_SIZE = 1024; //!< Size of internal buffer
+
+    PcmDecoder() : PcmDecoder(nullptr) {}
+    explicit PcmDecoder(PcmStream* pcm) : _pcm(nullptr), _convert(nullptr), _raw{} { assign(pcm); }
+
+    /*! @brief Assign stream. Return false if format is not supported */
+    bool assign(PcmStream* pcm);
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE bool valid() const { return _convert != nullptr; }
+    GOBLIB_INLINE PcmStream* stream() const { return _pcm; }
+    GOBLIB_INLINE std::uint16_t channels() const { return valid() ? _pcm->channels() : 0; }
+    GOBLIB_INLINE std::uint32_t sampleRate() const { return valid() ? _pcm->sampleRate() : 0; }
+    GOBLIB_INLINE bool is_tail() const { return !valid() || _pcm->is_tail(); }
+    /// @}
+
+    /*!
+      @brief Decode frames
+      @param out Interleaved samples of channels() (frames * channels())
+      @param frames Max frames
+      @return Number of decoded frames (Less than frames if tail)
+    */
+    std::size_t decode(Sample* out, const std::size_t frames);
+    /*! @brief Rewind to head of data */
+    GOBLIB_INLINE bool rewind() { return valid() && _pcm->rewind(); }
+
+  private:
+    using Convert = void(*)(Sample*, const std::uint8_t*, const std::size_t);
+
+    PcmStream* _pcm;
+    Convert _convert;
+    std::uint8_t _raw[RAW_SIZE];
+};
+
+/*!
+  @brief Streaming sample-rate converter on PcmDecoder.
+  @details Converts sample rate of PcmStream to the output rate by blocks of BLOCK input frames.<br>
+  Quality::Linear uses linear interpolation.
+  Quality::Fir uses polyphase windowed-sinc FIR (TAPS taps, PHASES phases) with precomputed table,
+  that is low-passed at the lower Nyquist frequency.<br>
+  Position is kept as exact fraction of integers (input rate / output rate), so it does not drift.
+  If rates are equal, frames are decoded directly.
+*/
+class Resampler
+{
+  public:
+    enum class Quality : std::uint8_t
+    {
+        Linear, //!< Linear interpolation
+        Fir,    //!< Polyphase FIR
+    };
+    constexpr static std::size_t MAX_CHANNELS = 2;  //!< Max channels of source
+    constexpr static std::size_t BLOCK = 128;       //!< Input frames decoded at once
+    constexpr static std::size_t TAPS = 16;         //!< Taps of FIR
+    constexpr static std::size_t PHASES = 32;       //!< Phases of FIR
+
+    Resampler() : _decoder(), _quality(Quality::Linear), _inRate(0), _outRate(0), _stepInt(0), _stepFrac(0), _frac(0), _invOut(0.0f), _invOutQ(0)
+                , _table(), _buf{}, _pos(0), _count(0), _flushed(false) {}
+
+    /*!
+      @brief Assign stream
+      @param pcm Stream
+      @param rate Output rate (Source rate if zero)
+      @param q Quality
+      @retval false Unsupported format or more than MAX_CHANNELS
+    */
+    bool assign(PcmStream* pcm, const std::uint32_t rate, const Quality q = Quality::Linear);
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE bool valid() const { return _decoder.valid() && _outRate; }
+    GOBLIB_INLINE std::uint16_t channels() const { return _decoder.channels(); }
+    /*! @brief Output rate */
+    GOBLIB_INLINE std::uint32_t sampleRate() const { return _outRate; }
+    GOBLIB_INLINE Quality quality() const { return _quality; }
+    GOBLIB_INLINE bool passThrough() const { return _inRate == _outRate; }
+    /*! @brief No more frames? */
+    GOBLIB_INLINE bool is_tail() const { return passThrough() ? _decoder.is_tail() : (_flushed && _pos + taps() > _count); }
+    /// @}
+
+    /*!
+      @brief Output frames
+      @param out Interleaved samples of channels() (frames * channels())
+      @param frames Max frames
+      @return Number of frames (Less than frames if tail)
+    */
+    std::size_t decode(Sample* out, const std::size_t frames);
+    /*! @brief Rewind to head of data and clear history */
+    bool rewind();
+
+  private:
+    GOBLIB_INLINE std::size_t taps() const { return _quality == Quality::Fir ? TAPS : 2; }
+    void reset();
+    bool refill();
+    void makeTable();
+
+  private:
+    PcmDecoder _decoder;
+    Quality _quality;
+    std::uint32_t _inRate, _outRate;
+    std::uint32_t _stepInt, _stepFrac, _frac; // Position advances _stepInt + _stepFrac / _outRate
+    float _invOut;
+    std::uint64_t _invOutQ; // 2^32 / _outRate (For fixed point)
+    std::unique_ptr<Sample[]> _table; // [PHASES][TAPS]
+    Sample _buf[(BLOCK + TAPS) * MAX_CHANNELS]; // Input frames (with history)
+    std::size_t _pos, _count; // First frame of the window, number of frames in _buf
+    bool _flushed;
+};
+
+/*!
+  @brief N-voice mixer that writes int16_t stereo into SpscRingBuffer.
+  @tparam Voices Number of voices
+  @tparam Block Frames per mixing block
+  @details Voices are mono or stereo. Voices are converted to the output rate by Resampler if it is not zero.<br>
+  mix() writes only to free space of the ring, so output callback that pops from the ring never blocks.
+  @code
+  goblib::audio::Mixer<8> mixer(44100);
+  goblib::SpscRingBuffer<std::int16_t, 4096> ring;
+  mixer.play(0, &pcm, 1.0f, 0.0f, true);
+  mixer.mix(ring); // In producer thread.
+  ring.read(dma, len); // In output callback.
+  @endcode
+  @warning Call all functions from the producer thread.
+*/
+template<std::size_t Voices, std::size_t Block = 256> class Mixer
+{
+    static_assert(Voices > 0, "Voices must be greater than zero");
+    static_assert(Block > 0, "Block must be greater than zero");
+
+  public:
+    constexpr static std::size_t VOICES = Voices;
+    constexpr static std::size_t BLOCK = Block;
+
+    /*!
+      @param rate Output rate (No conversion if zero)
+      @param q Quality of conversion
+    */
+    explicit Mixer(const std::uint32_t rate = 0, const Resampler::Quality q = Resampler::Quality::Linear)
+            : _voice(), _rate(rate), _quality(q), _master(1.0f), _mix{}, _tmp{} {}
+
+    /// @name Voice control
+    /// @{
+    /*!
+      @brief Play stream on voice
+      @param v Voice index
+      @param pcm Stream (Must be alive while playing)
+      @param gain Gain
+      @param pan Pan (-1.0 left, 0.0 center, 1.0 right)
+      @param loop Rewind if tail?
+      @retval false Unsupported format
+    */
+    bool play(const std::size_t v, PcmStream* pcm, const float gain = 1.0f, const float pan = 0.0f, const bool loop = false)
+    {
+        assert(v < Voices && "Out of range");
+        Voice& vo = _voice[v];
+        vo.active = false;
+        if(!pcm || !pcm->rewind() || !vo.resampler.assign(pcm, _rate, _quality)) { return false; }
+        vo.gain = gain;
+        vo.pan = goblib::clamp(pan, -1.0f, 1.0f);
+        vo.loop = loop;
+        vo.active = true;
+        return true;
+    }
+    GOBLIB_INLINE void stop(const std::size_t v) { assert(v < Voices && "Out of range"); _voice[v].active = false; }
+    GOBLIB_INLINE void stopAll() { for(auto& vo : _voice) { vo.active = false; } }
+    GOBLIB_INLINE void setGain(const std::size_t v, const float gain) { assert(v < Voices && "Out of range"); _voice[v].gain = gain; }
+    GOBLIB_INLINE void setPan(const std::size_t v, const float pan) { assert(v < Voices && "Out of range"); _voice[v].pan = goblib::clamp(pan, -1.0f, 1.0f); }
+    GOBLIB_INLINE void setLoop(const std::size_t v, const bool loop) { assert(v < Voices && "Out of range"); _voice[v].loop = loop; }
+    GOBLIB_INLINE void setMasterGain(const float gain) { _master = gain; }
+    /// @}
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE bool playing(const std::size_t v) const { assert(v < Voices && "Out of range"); return _voice[v].active; }
+    GOBLIB_INLINE float gain(const std::size_t v) const { assert(v < Voices && "Out of range"); return _voice[v].gain; }
+    GOBLIB_INLINE float pan(const std::size_t v) const { assert(v < Voices && "Out of range"); return _voice[v].pan; }
+    GOBLIB_INLINE float masterGain() const { return _master; }
+    /*! @brief Output rate (0 means rate of each source) */
+    GOBLIB_INLINE std::uint32_t sampleRate() const { return _rate; }
+    /// @}
+
+    /*!
+      @brief Mix frames into free space of ring
+      @param out Ring of interleaved int16_t stereo
+      @param maxFrames Max frames to write
+      @return Number of written frames
+    */
+    template<std::size_t N> std::size_t mix(SpscRingBuffer<std::int16_t, N>& out, const std::size_t maxFrames = ~static_cast<std::size_t>(0))
+    {
+        static_assert(N >= 2, "Ring must hold at least one frame");
+        std::size_t total = 0;
+        auto sp = out.writeSpans();
+        for(auto& s : { sp.first, sp.second })
+        {
+            // Each span consists of whole frames because head and N are even.
+            std::size_t frames = std::min(s.size / 2, maxFrames - total);
+            std::int16_t* dst = s.data;
+            while(frames)
+            {
+                std::size_t n = std::min(frames, Block);
+                mixBlock(n);
+                kernel::to_s16(dst, _mix.data(), n * 2);
+                dst += n * 2; frames -= n; total += n;
+            }
+        }
+        out.commit(total * 2);
+        return total;
+    }
+    /*!
+      @brief Mix frames into buffer
+      @param out Interleaved stereo (frames * 2)
+      @param frames Number of frames
+    */
+    void mix(Sample* out, std::size_t frames)
+    {
+        while(frames)
+        {
+            std::size_t n = std::min(frames, Block);
+            mixBlock(n);
+            std::copy(_mix.begin(), _mix.begin() + n * 2, out);
+            out += n * 2; frames -= n;
+        }
+    }
+
+  private:
+    struct Voice
+    {
+        Resampler resampler;
+        float gain, pan;
+        bool loop, active;
+        Voice() : resampler(), gain(1.0f), pan(0.0f), loop(false), active(false) {}
+    };
+
+    // Mix n frames of all voices into _mix.
+    void mixBlock(const std::size_t n)
+    {
+        std::fill(_mix.begin(), _mix.begin() + n * 2, Sample(0));
+        for(auto& vo : _voice)
+        {
+            if(!vo.active) { continue; }
+            const std::size_t ch = vo.resampler.channels();
+            // Balance (center is unity on both sides)
+            const Sample lg(vo.gain * _master * std::min(1.0f, 1.0f - vo.pan));
+            const Sample rg(vo.gain * _master * std::min(1.0f, 1.0f + vo.pan));
+            std::size_t done = 0;
+            while(done < n)
+            {
+                std::size_t d = vo.resampler.decode(_tmp.data(), n - done);
+                if(!d)
+                {
+                    if(vo.loop && vo.resampler.rewind() && !vo.resampler.is_tail()) { continue; }
+                    vo.active = false;
+                    break;
+                }
+                Sample* dst = _mix.data() + done * 2;
+                if(ch == 1)
+                {
+                    for(std::size_t i = 0; i < d; ++i)
+                    {
+                        dst[i * 2]     += _tmp[i] * lg;
+                        dst[i * 2 + 1] += _tmp[i] * rg;
+                    }
+                }
+                else if(lg == rg)
+                {
+                    kernel::mix_add(dst, _tmp.data(), lg, d * 2);
+                }
+                else
+                {
+                    for(std::size_t i = 0; i < d; ++i)
+                    {
+                        dst[i * 2]     += _tmp[i * 2] * lg;
+                        dst[i * 2 + 1] += _tmp[i * 2 + 1] * rg;
+                    }
+                }
+                done += d;
+            }
+        }
+    }
+
+  private:
+    std::array<Voice, Voices> _voice;
+    std::uint32_t _rate;
+    Resampler::Quality _quality;
+    float _master;
+    std::array<Sample, Block * 2> _mix; // Interleaved stereo
+    std::array<Sample, Block * 2> _tmp; // Decoded samples of a voice
+};
+
+template<std::size_t Voices, std::size_t Block> constexpr std::size_t Mixer<Voices, Block>::VOICES;
+template<std::size_t Voices, std::size_t Block> constexpr std::size_t Mixer<Voices, Block>::BLOCK;
+
+//
+}}
+#endif
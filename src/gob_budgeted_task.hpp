@@ -0,0 +1,205 @@
+/*!
+  Goblin Library
+
+  @file  gob_budgeted_task.hpp
+  @brief Task system with time-sliced background tasks.
+*/
+#pragma once
+#ifndef GOBLIB_BUDGETED_TASK_HPP
+#define GOBLIB_BUDGETED_TASK_HPP
+
+#include "gob_macro.hpp"
+#include "gob_task.hpp"
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#if defined(GOBLIB_CPP17_OR_EARLIER)
+#include "gob_template_helper.hpp"
+#endif
+
+namespace goblib
+{
+
+/*!
+  @brief Parent-child task system with budgeted pump for background tasks.
+  @details Tasks marked as background are not pumped every frame.
+  After other tasks are pumped, background tasks are pumped round-robin until the budget is spent,
+  and resumed from the next one on the next pump. At least one background task is pumped per pump.<br>
+  Accumulated execution time per Task::tag() can be enabled for all tasks.
+  @tparam T Task or derived of Task
+  @tparam Clock using std::chrono clock. (steady_clock as default, CycleClock is also available)
+  @note Background task is pumped with delta of the pump that runs it. Children of background task are pumped every frame unless marked.
+  @note Derived class that overrides onRemoveNode must call that of BudgetedTaskTree.
+*/
+template<class T, class Clock = std::chrono::steady_clock>
+class BudgetedTaskTree : public TaskTree<T>
+{
+#if defined(GOBLIB_CPP20_OR_LATER)
+    static_assert(std::chrono::is_clock<Clock>::value, "Clock must satisfies the Clock requirements");
+#else
+    static_assert(goblib::template_helper::is_clock<Clock>::value, "Clock must satisfies the Clock requirements");
+#endif
+
+  public:
+    using Duration = typename Clock::duration;
+    constexpr static std::size_t TAG_SIZE = 16;
+
+    /*! @brief Accumulated execution time of tasks that have the same tag */
+    struct ExecutionTime
+    {
+        char tag[TAG_SIZE];
+        Duration total;
+        std::uint32_t calls;
+    };
+
+    /*!
+      @param budget Budget for background tasks per pump.
+      @param qreserve Message queue max size for post message.
+    */
+    explicit BudgetedTaskTree(std::chrono::microseconds budget = std::chrono::microseconds(1000),
+                              std::size_t qreserve = TaskTree<T>::QUEUE_RESERVE_SIZE)
+            : TaskTree<T>(qreserve), _budget(budget), _background(), _jobs(), _resume(nullptr)
+            , _ran(0), _backgroundTime(0), _times(), _measure(false)
+    {}
+
+    void pump(const float delta = 1.0f)
+    {
+        if(this->isPauseGlobal()) { return; }
+
+        GOBLIB_TRACE_SCOPE("BudgetedTaskTree::pump");
+        this->deliverMessage();
+
+        _jobs.clear();
+        this->visit([this, delta](T* t)
+        {
+            if(isBackground(t)) { _jobs.push_back(t); }
+            else                { run(t, delta); }
+        });
+        pumpBackground(delta);
+
+        this->insertReservedNodes();
+        this->remove_if([](const T* t) { return t->isKill(); });
+    }
+
+    /// @name Background
+    /// @{
+    /*! @brief Set/unset task as time-sliced background task */
+    void setBackground(T* t, bool b = true)
+    {
+        auto it = std::lower_bound(_background.begin(), _background.end(), t, std::less<const T*>());
+        bool exists = it != _background.end() && *it == t;
+        if(b && !exists) { _background.insert(it, t); }
+        if(!b && exists) { _background.erase(it); }
+    }
+    GOBLIB_INLINE bool isBackground(const T* t) const
+    {
+        auto it = std::lower_bound(_background.begin(), _background.end(), t, std::less<const T*>());
+        return it != _background.end() && *it == t;
+    }
+    GOBLIB_INLINE void setBudget(const std::chrono::microseconds us) { _budget = us; }
+    GOBLIB_INLINE std::chrono::microseconds budget() const { return _budget; }
+    /*! @brief Number of background tasks pumped in last pump */
+    GOBLIB_INLINE std::size_t backgroundPumped() const { return _ran; }
+    /*! @brief Time spent for background tasks in last pump */
+    GOBLIB_INLINE Duration backgroundTime() const { return _backgroundTime; }
+    /// @}
+
+    /// @name Execution time
+    /// @{
+    /*! @brief Enable/disable accumulation of execution time per tag */
+    GOBLIB_INLINE void measureExecutionTime(bool b) { _measure = b; }
+    GOBLIB_INLINE bool isMeasureExecutionTime() const { return _measure; }
+    /*! @brief All accumulated times (Sorted by tag) */
+    GOBLIB_INLINE const std::vector<ExecutionTime>& executionTimes() const { return _times; }
+    /*! @brief Accumulated time of tag (Zero if not exists) */
+    Duration executionTime(const char* tag) const
+    {
+        auto it = findTime(tag);
+        return (it != _times.end() && std::strncmp(it->tag, tag, TAG_SIZE - 1) == 0) ? it->total : Duration(0);
+    }
+    GOBLIB_INLINE void clearExecutionTime() { _times.clear(); }
+    /// @}
+
+  protected:
+    virtual void onRemoveNode(T* node) override
+    {
+        setBackground(node, false);
+        if(_resume == node) { _resume = nullptr; }
+        TaskTree<T>::onRemoveNode(node);
+    }
+
+  private:
+    using TimeIterator = typename std::vector<ExecutionTime>::const_iterator;
+
+    TimeIterator findTime(const char* tag) const
+    {
+        return std::lower_bound(_times.begin(), _times.end(), tag, [](const ExecutionTime& e, const char* s)
+        {
+            return std::strncmp(e.tag, s, TAG_SIZE - 1) < 0;
+        });
+    }
+
+    void run(T* t, const float delta)
+    {
+        if(!_measure) { t->pump(delta); return; }
+
+        auto start = Clock::now();
+        t->pump(delta);
+        Duration d = Clock::now() - start;
+
+        auto cit = findTime(t->tag());
+        auto it = _times.begin() + (cit - _times.cbegin());
+        if(it == _times.end() || std::strncmp(it->tag, t->tag(), TAG_SIZE - 1) != 0)
+        {
+            ExecutionTime e{ {}, Duration(0), 0 };
+            std::strncpy(e.tag, t->tag(), TAG_SIZE - 1);
+            e.tag[TAG_SIZE - 1] = '\0';
+            it = _times.insert(it, e);
+        }
+        it->total += d;
+        ++it->calls;
+    }
+
+    void pumpBackground(const float delta)
+    {
+        _ran = 0;
+        _backgroundTime = Duration(0);
+        if(_jobs.empty()) { return; }
+
+        GOBLIB_TRACE_SCOPE("BudgetedTaskTree::background");
+        // Resume from the next of the last pumped.
+        std::size_t start = 0;
+        auto it = std::find(_jobs.begin(), _jobs.end(), _resume);
+        if(it != _jobs.end()) { start = (static_cast<std::size_t>(it - _jobs.begin()) + 1) % _jobs.size(); }
+
+        const auto begin = Clock::now();
+        const Duration budget = std::chrono::duration_cast<Duration>(_budget);
+        do
+        {
+            T* t = _jobs[(start + _ran) % _jobs.size()];
+            run(t, delta);
+            _resume = t;
+            ++_ran;
+            _backgroundTime = Clock::now() - begin;
+        }
+        while(_ran < _jobs.size() && _backgroundTime < budget);
+    }
+
+  private:
+    std::chrono::microseconds _budget;
+    std::vector<T*> _background; // Sorted background tasks.
+    std::vector<T*> _jobs;       // Background tasks in visit order of this pump.
+    T* _resume;                  // Last pumped background task.
+    std::size_t _ran;
+    Duration _backgroundTime;
+    std::vector<ExecutionTime> _times; // Sorted by tag.
+    bool _measure;
+};
+
+template<class T, class Clock> constexpr std::size_t BudgetedTaskTree<T, Clock>::TAG_SIZE;
+
+//
+}
+#endif
@@ -0,0 +1,192 @@
+/*!
+  Goblin Library
+
+  @file   gob_buffered_stream.cpp
+  @brief  Buffered stream decorator.
+*/
+#include "gob_buffered_stream.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace goblib
+{
+
+constexpr std::size_t BufferedStream::DEFAULT_BLOCK_SIZE;
+
+BufferedStream::BufferedStream(Stream* src, const std::size_t blockSize, const bool prefetch)
+        : Stream(), _src(src), _blockSize(blockSize ? blockSize : DEFAULT_BLOCK_SIZE), _prefetch(prefetch)
+        , _size(0), _pos(0), _srcPos(0), _block(), _front(0), _sourceReads(0)
+        , _worker(), _mutex(), _cv(), _requestPos(0), _requested(false), _quit(false)
+{
+    assert(_src && "Source must not be nullptr");
+    for(auto& b : _block)
+    {
+        b.data.reset(new std::uint8_t[_blockSize]);
+        b.pos = 0; b.len = 0; b.valid = false;
+    }
+    _size = _src->is_open() ? _src->size() : 0;
+    _srcPos = _src->is_open() ? _src->position() : 0;
+    _pos = _srcPos;
+    if(_prefetch) { _worker = std::thread(&BufferedStream::work, this); }
+}
+
+BufferedStream::~BufferedStream()
+{
+    if(_worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _quit = true;
+        }
+        _cv.notify_all();
+        _worker.join();
+    }
+}
+
+bool BufferedStream::open(const char* path)
+{
+    wait();
+    bool b = _src->open(path);
+    invalidate();
+    _size = b ? _src->size() : 0;
+    _pos = _srcPos = b ? _src->position() : 0;
+    return b;
+}
+
+void BufferedStream::close()
+{
+    wait();
+    _src->close();
+    invalidate();
+    _size = _pos = _srcPos = 0;
+}
+
+void BufferedStream::invalidate()
+{
+    wait();
+    for(auto& b : _block) { b.valid = false; }
+    _srcPos = _src->is_open() ? _src->position() : 0;
+}
+
+Stream::pos_type BufferedStream::read(std::uint8_t* buf, std::size_t len)
+{
+    pos_type total = 0;
+    while(len && _pos < _size)
+    {
+        Block& b = _block[_front];
+        if(inBlock(b, _pos))
+        {
+            std::size_t off = static_cast<std::size_t>(_pos - b.pos);
+            std::size_t n = std::min(len, b.len - off);
+            std::memcpy(buf, b.data.get() + off, n);
+            buf += n; len -= n; _pos += n; total += n;
+            continue;
+        }
+        // Large read goes to source directly.
+        if(len >= _blockSize && (wait(), !inBlock(_block[_front ^ 1], _pos)))
+        {
+            std::size_t n = readSource(_pos, buf, len);
+            if(!n) { break; }
+            buf += n; len -= n; _pos += n; total += n;
+            continue;
+        }
+        if(!fill(_pos)) { break; }
+    }
+    return total;
+}
+
+bool BufferedStream::seek(off_type off, seekdir s)
+{
+    off_type base = 0;
+    switch(s)
+    {
+    case seekdir::beg: base = 0; break;
+    case seekdir::cur: base = static_cast<off_type>(_pos); break;
+    case seekdir::end: base = static_cast<off_type>(_size); break;
+    }
+    off_type np = base + off;
+    if(np < 0 || np > static_cast<off_type>(_size)) { return false; }
+    _pos = static_cast<pos_type>(np);
+    return true;
+}
+
+// Load block that contains pos to front.
+bool BufferedStream::fill(const pos_type pos)
+{
+    wait();
+    const pos_type bpos = align(pos);
+    Block& back = _block[_front ^ 1];
+    if(inBlock(back, pos))
+    {
+        _front ^= 1;
+    }
+    else
+    {
+        Block& b = _block[_front];
+        b.valid = false;
+        b.pos = bpos;
+        b.len = readSource(bpos, b.data.get(), static_cast<std::size_t>(std::min<pos_type>(_blockSize, _size - bpos)));
+        b.valid = b.len > 0;
+        if(!inBlock(b, pos)) { return false; }
+    }
+    const Block& f = _block[_front];
+    if(_prefetch && f.pos + f.len < _size) { request(f.pos + f.len); }
+    return true;
+}
+
+// Caller must own source. (Worker is idle or caller is worker)
+std::size_t BufferedStream::readSource(const pos_type pos, std::uint8_t* dst, const std::size_t len)
+{
+    if(_srcPos != pos)
+    {
+        if(!_src->seek(pos)) { return 0; }
+        _srcPos = pos;
+    }
+    std::size_t n = static_cast<std::size_t>(_src->read(dst, len));
+    _srcPos += n;
+    _sourceReads.fetch_add(1, std::memory_order_relaxed);
+    return n;
+}
+
+void BufferedStream::request(const pos_type pos)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _block[_front ^ 1].valid = false;
+        _requestPos = pos;
+        _requested = true;
+    }
+    _cv.notify_all();
+}
+
+// Wait until worker is idle.
+void BufferedStream::wait()
+{
+    if(!_prefetch) { return; }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return !_requested; });
+}
+
+void BufferedStream::work()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    for(;;)
+    {
+        _cv.wait(lock, [this] { return _requested || _quit; });
+        if(_quit) { return; }
+
+        Block& b = _block[_front ^ 1];
+        pos_type pos = _requestPos;
+        lock.unlock();
+        b.pos = pos;
+        b.len = readSource(pos, b.data.get(), static_cast<std::size_t>(std::min<pos_type>(_blockSize, _size - pos)));
+        lock.lock();
+        b.valid = b.len > 0;
+        _requested = false;
+        _cv.notify_all();
+    }
+}
+
+//
+}
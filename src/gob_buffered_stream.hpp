@@ -0,0 +1,123 @@
+/*!
+  Goblin Library
+
+  @file   gob_buffered_stream.hpp
+  @brief  Buffered stream decorator.
+*/
+#pragma once
+#ifndef GOBLIB_BUFFERED_STREAM_HPP
+#define GOBLIB_BUFFERED_STREAM_HPP
+
+#include "gob_stream.hpp"
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace goblib
+{
+
+/*!
+  @brief Stream decorator that reads source by aligned blocks.
+  @details Small reads (and read8/16/32) are served from the block cache. Reads larger than block size read source directly.<br>
+  seek() only moves the position, source is touched when data is needed.<br>
+  If prefetch is enabled, next block is read on worker thread while the current block is used (double-buffered).
+  @note Source is not owned. Source must not be used directly while this is used. (Call invalidate() if it was)
+  @warning If prefetch is enabled, source is read on worker thread.
+*/
+class BufferedStream : public Stream
+{
+  public:
+    using pos_type = typename Stream::pos_type;
+    using off_type = typename Stream::off_type;
+    constexpr static std::size_t DEFAULT_BLOCK_SIZE = 512;
+
+    /*!
+      @param src Source stream
+      @param blockSize Size of block. (Read size and alignment of source)
+      @param prefetch Prefetch next block on worker thread?
+    */
+    explicit BufferedStream(Stream* src, const std::size_t blockSize = DEFAULT_BLOCK_SIZE, const bool prefetch = false);
+    virtual ~BufferedStream();
+
+    /// @name Open,Close
+    /// @{
+    virtual bool is_open() const override { return _src->is_open(); }
+    /*! @brief Open source */
+    virtual bool open(const char* path) override;
+    /*! @brief Close source */
+    virtual void close() override;
+    /// @}
+
+    /// @name Property
+    /// @{
+    virtual pos_type size() const override { return _size; }
+    GOBLIB_INLINE Stream* source() const { return _src; }
+    GOBLIB_INLINE std::size_t blockSize() const { return _blockSize; }
+    GOBLIB_INLINE bool prefetch() const { return _prefetch; }
+    /*! @brief Number of read() of source */
+    GOBLIB_INLINE std::size_t sourceReads() const { return _sourceReads.load(std::memory_order_relaxed); }
+    /// @}
+
+    /// @name Read
+    /// @{
+    template<typename U> pos_type read(U buf, std::size_t len)
+    {
+        return read(reinterpret_cast<std::uint8_t*>(buf), len);
+    }
+    virtual pos_type read(std::uint8_t* buf, std::size_t len) override;
+    /// @}
+
+    /// @name Seek
+    /// @{
+    virtual bool seek(off_type off, seekdir s) override;
+    virtual pos_type position() const override { return _pos; }
+    virtual bool is_tail() const override { return _pos >= _size; }
+    /// @}
+
+    /*! @brief Discard cached blocks (e.g. source was changed) */
+    void invalidate();
+
+  private:
+    struct Block
+    {
+        std::unique_ptr<std::uint8_t[]> data;
+        pos_type pos;
+        std::size_t len;
+        bool valid;
+    };
+
+    GOBLIB_INLINE pos_type align(const pos_type pos) const { return pos - pos % _blockSize; }
+    GOBLIB_INLINE bool inBlock(const Block& b, const pos_type pos) const { return b.valid && pos >= b.pos && pos < b.pos + b.len; }
+
+    bool fill(const pos_type pos);
+    std::size_t readSource(const pos_type pos, std::uint8_t* dst, const std::size_t len);
+    void request(const pos_type pos);
+    void wait();
+    void work();
+
+  private:
+    Stream* _src;
+    const std::size_t _blockSize;
+    const bool _prefetch;
+    pos_type _size, _pos;
+    pos_type _srcPos;       // Position of source. (Touched by the side that uses source)
+    Block _block[2];        // Front and back (prefetch)
+    std::size_t _front;
+    std::atomic<std::size_t> _sourceReads; // Read by any thread
+
+    // Prefetch
+    std::thread _worker;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    pos_type _requestPos;
+    bool _requested, _quit;
+};
+
+//
+}
+#endif
@@ -0,0 +1,236 @@
+/*!
+  Goblin Library
+
+  @file  gob_coroutine_task.hpp
+  @brief Task that executes C++20 coroutine.
+  @note Only available with C++20 or later.
+*/
+#pragma once
+#ifndef GOBLIB_COROUTINE_TASK_HPP
+#define GOBLIB_COROUTINE_TASK_HPP
+
+#include "gob_macro.hpp"
+
+#if defined(GOBLIB_CPP20_OR_LATER)
+#if __has_include(<coroutine>)
+
+#include "gob_task.hpp"
+#include "gob_allocator.hpp"
+#include <coroutine>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include <new>
+
+namespace goblib
+{
+
+/*!
+  @brief Task whose onExecute resumes coroutine run().
+  @details run() is started on the first execute, and resumed from TaskTree::pump() each time the awaited condition is satisfied.
+  The task is released when run() returns.<br>
+  Suspended tasks only test their condition in onExecute, so no per-task state machine is needed.
+@code
+goblib::CoroutineTask::Routine Enemy::run()
+{
+    for(;;)
+    {
+        co_await seconds(1.5f);
+        fire();
+        auto m = co_await message(MSG_HIT);
+        if(m.arg) { break; }
+        co_await nextFrame();
+    }
+}
+@endcode
+  @note Coroutine frames are allocated from the allocator set by setAllocator() if set, otherwise from global heap.
+  @note Derived class that overrides onReceive or onRelease must call that of CoroutineTask.
+*/
+class CoroutineTask : public Task
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /*! @brief Return type of run() */
+    class Routine
+    {
+      public:
+        struct promise_type
+        {
+            Routine get_return_object() { return Routine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() { std::terminate(); }
+
+            static void* operator new(const std::size_t sz)
+            {
+                void* p = CoroutineTask::_allocator ? CoroutineTask::_allocator->allocate(sz) : nullptr;
+                return p ? p : ::operator new(sz);
+            }
+            static void operator delete(void* p)
+            {
+                if(CoroutineTask::_allocator && CoroutineTask::_allocator->owns(p)) { CoroutineTask::_allocator->deallocate(p); }
+                else { ::operator delete(p); }
+            }
+        };
+
+        Routine() : _handle(nullptr) {}
+        Routine(Routine&& o) noexcept : _handle(std::exchange(o._handle, nullptr)) {}
+        Routine& operator=(Routine&& o) noexcept
+        {
+            if(this != &o)
+            {
+                reset();
+                _handle = std::exchange(o._handle, nullptr);
+            }
+            return *this;
+        }
+        ~Routine() { reset(); }
+
+        GOBLIB_INLINE bool valid() const { return static_cast<bool>(_handle); }
+        GOBLIB_INLINE bool done() const { return !_handle || _handle.done(); }
+        GOBLIB_INLINE void resume() { if(!done()) { _handle.resume(); } }
+        void reset()
+        {
+            if(_handle) { _handle.destroy(); }
+            _handle = nullptr;
+        }
+
+      private:
+        explicit Routine(std::coroutine_handle<promise_type> h) : _handle(h) {}
+        Routine(const Routine&) = delete;
+        Routine& operator=(const Routine&) = delete;
+
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    CoroutineTask(PriorityType pri, const char* tag)
+            : Task(pri, tag), _routine(), _wait(Wait::None), _frames(0), _deadline(), _msg(0), _received(), _delta(0.0f)
+    {}
+    virtual ~CoroutineTask() {}
+
+    /// @name Allocator
+    /// @{
+    /*! @brief Set allocator for coroutine frames (nullptr: global heap) */
+    static void setAllocator(SlabAllocator* a) { _allocator = a; }
+    static SlabAllocator* allocator() { return _allocator; }
+    /// @}
+
+    /// @name Property
+    /// @{
+    /*! @brief Is suspended on timer, frames or message? */
+    GOBLIB_INLINE bool isWaiting() const { return _wait != Wait::None && _wait != Wait::Ready; }
+    /*! @brief Delta of the pump that resumed coroutine */
+    GOBLIB_INLINE float delta() const { return _delta; }
+    /// @}
+
+  protected:
+    /*! @brief Coroutine body */
+    virtual Routine run() = 0;
+
+    /// @name Awaitable
+    /// @{
+    struct FrameAwaiter
+    {
+        CoroutineTask* task;
+        std::uint32_t frames;
+        bool await_ready() const noexcept { return frames == 0; }
+        void await_suspend(std::coroutine_handle<>) noexcept
+        {
+            task->_wait = Wait::Frames;
+            task->_frames = frames;
+        }
+        void await_resume() const noexcept {}
+    };
+    struct TimeAwaiter
+    {
+        CoroutineTask* task;
+        Clock::time_point deadline;
+        bool await_ready() const noexcept { return Clock::now() >= deadline; }
+        void await_suspend(std::coroutine_handle<>) noexcept
+        {
+            task->_wait = Wait::Time;
+            task->_deadline = deadline;
+        }
+        void await_resume() const noexcept {}
+    };
+    struct MessageAwaiter
+    {
+        CoroutineTask* task;
+        std::uint32_t msg;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) noexcept
+        {
+            task->_wait = Wait::Message;
+            task->_msg = msg;
+        }
+        TaskMessage await_resume() const noexcept { return task->_received; }
+    };
+
+    /*! @brief Resume on next pump */
+    GOBLIB_INLINE FrameAwaiter nextFrame() { return FrameAwaiter{ this, 1 }; }
+    /*! @brief Resume after n pumps */
+    GOBLIB_INLINE FrameAwaiter frames(const std::uint32_t n) { return FrameAwaiter{ this, n }; }
+    /*! @brief Resume on the first pump after the elapsed time */
+    template<class Rep, class Period> TimeAwaiter wait(const std::chrono::duration<Rep, Period>& d)
+    {
+        return TimeAwaiter{ this, Clock::now() + std::chrono::duration_cast<Clock::duration>(d) };
+    }
+    GOBLIB_INLINE TimeAwaiter seconds(const float sec) { return wait(std::chrono::duration<float>(sec)); }
+    /*! @brief Resume when message msg has been received. co_await returns the message. */
+    GOBLIB_INLINE MessageAwaiter message(const std::uint32_t msg) { return MessageAwaiter{ this, msg }; }
+    /// @}
+
+    virtual void onExecute(const float delta) override
+    {
+        switch(_wait)
+        {
+        case Wait::Frames:  if(--_frames) { return; } break;
+        case Wait::Time:    if(Clock::now() < _deadline) { return; } break;
+        case Wait::Message: return;
+        default: break;
+        }
+        _delta = delta;
+        _wait = Wait::None;
+        if(!_routine.valid()) { _routine = run(); }
+        _routine.resume();
+        if(_routine.done()) { release(); }
+    }
+
+    virtual void onReceive(const TaskMessage& m) override
+    {
+        if(_wait == Wait::Message && m.msg == _msg)
+        {
+            _received = m;
+            _wait = Wait::Ready; // Resume on onExecute
+        }
+    }
+
+    virtual bool onRelease() override
+    {
+        _routine.reset();
+        _wait = Wait::None;
+        return true;
+    }
+
+  private:
+    enum class Wait : std::uint8_t { None, Frames, Time, Message, Ready };
+
+    Routine _routine;
+    Wait _wait;
+    std::uint32_t _frames;
+    Clock::time_point _deadline;
+    std::uint32_t _msg;
+    TaskMessage _received;
+    float _delta;
+
+    inline static SlabAllocator* _allocator = nullptr;
+};
+
+//
+}
+#endif
+#endif
+#endif
@@ -0,0 +1,62 @@
+/*!
+  Goblin Library
+
+  @file   gob_cycle_clock.cpp
+  @brief  Clock that reads hardware cycle counter.
+*/
+#include "gob_cycle_clock.hpp"
+
+namespace goblib
+{
+
+constexpr bool CycleClock::is_steady;
+constexpr unsigned CycleClock::SHIFT;
+#if defined(GOBLIB_CYCLE_CLOCK_32BIT)
+std::atomic<std::uint64_t> CycleClock::_last{0};
+#endif
+std::atomic<bool> CycleClock::_calibrated{false};
+std::atomic<std::uint64_t> CycleClock::_frequency{1000000000ULL};
+std::atomic<std::uint64_t> CycleClock::_mult{1ULL << CycleClock::SHIFT};
+
+void CycleClock::calibrateOnce() noexcept
+{
+    // Initialization of local static is thread-safe, other threads wait for the measurement.
+    static const bool once = (_calibrated.load(std::memory_order_acquire) || (calibrate(), true));
+    (void)once;
+}
+
+void CycleClock::calibrate(const std::uint64_t freq, const std::uint32_t ms)
+{
+    std::uint64_t f = freq;
+
+#if defined(GOBLIB_CYCLE_CLOCK_DWT)
+    // Enable cycle counter. (DEMCR.TRCENA, DWT_CTRL.CYCCNTENA)
+    *reinterpret_cast<volatile std::uint32_t*>(0xE000EDFC) |= (1U << 24);
+    *reinterpret_cast<volatile std::uint32_t*>(0xE0001000) |= 1U;
+#endif
+#if defined(GOBLIB_CYCLE_CLOCK_AARCH64)
+    if(!f) { __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(f)); }
+#endif
+    if(!hardware()) { f = 1000000000ULL; } // steady_clock in nanoseconds.
+
+    if(!f)
+    {
+        // Measure against steady_clock.
+        auto t0 = std::chrono::steady_clock::now();
+        std::uint64_t c0 = counter();
+        auto t1 = t0;
+        while((t1 = std::chrono::steady_clock::now()) - t0 < std::chrono::milliseconds(ms ? ms : 1)) { counter(); }
+        std::uint64_t c1 = counter();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        f = ns > 0 ? static_cast<std::uint64_t>((static_cast<double>(c1 - c0) * 1e9) / ns) : 0;
+    }
+    if(!f) { f = 1000000000ULL; }
+
+    _frequency.store(f, std::memory_order_relaxed);
+    // (1e9 << 32) / f without 128bit
+    _mult.store((1000000000ULL / f) << SHIFT | (((1000000000ULL % f) << SHIFT) / f), std::memory_order_relaxed);
+    _calibrated.store(true, std::memory_order_release);
+}
+
+//
+}
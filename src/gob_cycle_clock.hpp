@@ -0,0 +1,162 @@
+/*!
+  Goblin Library
+
+  @file   gob_cycle_clock.hpp
+  @brief  Clock that reads hardware cycle counter.
+*/
+#pragma once
+#ifndef GOBLIB_CYCLE_CLOCK_HPP
+#define GOBLIB_CYCLE_CLOCK_HPP
+
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <chrono>
+#include <atomic>
+
+/// @cond
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+# define GOBLIB_CYCLE_CLOCK_X86
+# if defined(GOBLIB_COMPILER_MSC)
+#   include <intrin.h>
+# else
+#   include <x86intrin.h>
+# endif
+#elif defined(__aarch64__)
+# define GOBLIB_CYCLE_CLOCK_AARCH64
+#elif defined(__XTENSA__)
+# define GOBLIB_CYCLE_CLOCK_XTENSA
+# define GOBLIB_CYCLE_CLOCK_32BIT
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+# define GOBLIB_CYCLE_CLOCK_DWT
+# define GOBLIB_CYCLE_CLOCK_32BIT
+#endif
+/// @endcond
+
+namespace goblib
+{
+
+/*!
+  @brief Clock that reads hardware cycle counter, satisfies the Clock requirements.
+  @details Reads RDTSC (x86), CNTVCT_EL0 (AArch64), CCOUNT (Xtensa) or DWT CYCCNT (Cortex-M3/4/7/33),
+  and converts cycles to nanoseconds by the frequency calibrated on first use.<br>
+  Falls back to std::chrono::steady_clock on other targets. (hardware() returns false)
+  @code
+  using Inst = goblib::profile::MeasuringInstrument<goblib::CycleClock, std::chrono::nanoseconds>;
+  class MyApp : public goblib::App<goblib::CycleClock, 60, 60> { ... };
+  @endcode
+  @note Assumes constant rate counter. (e.g. invariant TSC, fixed CPU frequency)
+  @note The first conversion measures the counter for a few milliseconds unless calibrate() is called beforehand.
+  @warning On 32-bit counters (CCOUNT, CYCCNT), now() must be called at least once per wrap of counter
+  (about 17 seconds at 240MHz). (From any thread)
+*/
+class CycleClock
+{
+  public:
+    using rep = std::int64_t;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<CycleClock>;
+    constexpr static bool is_steady = true;
+
+    static time_point now() noexcept { return time_point(duration(static_cast<rep>(toNanoseconds(cycles())))); }
+
+    /*! @brief Raw cycles (Extended to 64bit) */
+    GOBLIB_INLINE static std::uint64_t cycles() noexcept
+    {
+#if defined(GOBLIB_CYCLE_CLOCK_DWT)
+        ensureCalibrated(); // Counter is enabled by calibrate()
+#endif
+        return counter();
+    }
+
+    /*! @brief Cycles to nanoseconds */
+    GOBLIB_INLINE static std::uint64_t toNanoseconds(const std::uint64_t c) noexcept
+    {
+        ensureCalibrated();
+        const std::uint64_t mult = _mult.load(std::memory_order_relaxed);
+#if defined(__SIZEOF_INT128__)
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(c) * mult) >> SHIFT);
+#else
+        // (c * _mult) >> 32 by 32bit multiplications. (Wrapped terms cancel if the result fits 64bit)
+        const std::uint64_t cl = c & 0xFFFFFFFFU, ch = c >> 32;
+        const std::uint64_t ml = mult & 0xFFFFFFFFU, mh = mult >> 32;
+        return ((ch * mh) << 32) + ch * ml + cl * mh + ((cl * ml) >> 32);
+#endif
+    }
+
+    /*! @brief Frequency of counter (Hz) */
+    GOBLIB_INLINE static std::uint64_t frequency() noexcept { ensureCalibrated(); return _frequency.load(std::memory_order_relaxed); }
+    /*! @brief Is hardware counter used? */
+    static constexpr bool hardware()
+    {
+#if defined(GOBLIB_CYCLE_CLOCK_X86) || defined(GOBLIB_CYCLE_CLOCK_AARCH64) || defined(GOBLIB_CYCLE_CLOCK_32BIT)
+        return true;
+#else
+        return false;
+#endif
+    }
+    /*!
+      @brief Calibrate frequency
+      @param freq Frequency of counter (Hz). If zero, measured against std::chrono::steady_clock. (Counter register is used if exists)
+      @param ms Measuring time.
+      @note Called with default arguments on first use if not called yet.
+    */
+    static void calibrate(const std::uint64_t freq = 0, const std::uint32_t ms = 2);
+
+  private:
+    GOBLIB_INLINE static std::uint64_t counter() noexcept
+    {
+#if defined(GOBLIB_CYCLE_CLOCK_X86)
+        return __rdtsc();
+#elif defined(GOBLIB_CYCLE_CLOCK_AARCH64)
+        std::uint64_t v;
+        __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+#elif defined(GOBLIB_CYCLE_CLOCK_32BIT)
+        return read64();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Calibrate with default arguments if not calibrated yet.
+    GOBLIB_INLINE static void ensureCalibrated() noexcept
+    {
+        if(!_calibrated.load(std::memory_order_acquire)) { calibrateOnce(); }
+    }
+    static void calibrateOnce() noexcept;
+
+#if defined(GOBLIB_CYCLE_CLOCK_32BIT)
+    GOBLIB_INLINE static std::uint32_t read32() noexcept
+    {
+# if defined(GOBLIB_CYCLE_CLOCK_XTENSA)
+        std::uint32_t c;
+        __asm__ volatile("rsr %0, ccount" : "=a"(c));
+        return c;
+# else
+        return *reinterpret_cast<volatile std::uint32_t*>(0xE0001004); // DWT_CYCCNT
+# endif
+    }
+    // Read counter extended to 64bit by the latest value of all threads.
+    GOBLIB_INLINE static std::uint64_t read64() noexcept
+    {
+        std::uint64_t prev = _last.load(std::memory_order_acquire); // Counter is read after this
+        const std::uint32_t c = read32();
+        std::uint64_t v = (prev & ~0xFFFFFFFFULL) | c;
+        if(c < static_cast<std::uint32_t>(prev)) { v += 0x100000000ULL; }
+        // Publish unless the later value is already published.
+        while(v > prev && !_last.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {}
+        return v;
+    }
+    static std::atomic<std::uint64_t> _last; // Latest extended cycles
+#endif
+    constexpr static unsigned SHIFT = 32;
+    static std::atomic<bool> _calibrated;
+    static std::atomic<std::uint64_t> _frequency;
+    static std::atomic<std::uint64_t> _mult; // (1e9 << SHIFT) / frequency
+};
+
+//
+}
+#endif
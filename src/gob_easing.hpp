@@ -13,7 +13,11 @@
 #include "gob_template_helper.hpp"
 #include <cstdint>
 #include <cmath> // std::cos,sin...
+#include <array>
+#include <algorithm>
+#include <cassert>
 #include <gob_math.hpp> // pi,half_pi
+#include "gob_fixed_point_math.hpp"
 
 #include <cstdio>
 
@@ -188,6 +192,48 @@ GOBLIB_INLINE float circular_inout(const float t)
         0.5f * (std::sqrt(1.0f - (t * 2.0f - 2.0f) * (t * 2.0f - 2.0f)) + 1.0f);
 }
 
+/// @name Easing behavior for FixedPointNumber (without floating point)
+/// @note t [0 ~ 1]
+/// @{
+template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE T sinusoidal_in(const T t)
+{
+    return T(1) - math::cos(t * T(math::constants::half_pi_f));
+}
+
+template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE T sinusoidal_out(const T t)
+{
+    return math::sin(t * T(math::constants::half_pi_f));
+}
+
+template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE T sinusoidal_inout(const T t)
+{
+    return (T(1) - math::cos(t * T(math::constants::pi_f))) / 2;
+}
+
+template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE T circular_in(const T t)
+{
+    return T(1) - math::sqrt(T(1) - t * t);
+}
+
+template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE T circular_out(const T t)
+{
+    return math::sqrt(T(1) - (t - T(1)) * (t - T(1)));
+}
+
+template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE T circular_inout(const T t)
+{
+    return (t * 2) < T(1) ?
+        (T(1) - math::sqrt(T(1) - (t * 2) * (t * 2))) / 2 :
+        (math::sqrt(T(1) - (t * 2 - T(2)) * (t * 2 - T(2))) + T(1)) / 2;
+}
+/// @}
+
 namespace
 {
 constexpr float BackFactor = 1.70158f;
@@ -296,13 +342,43 @@ struct easing_quintic_out       { GOBLIB_INLINE constexpr float operator()(const
 struct easing_quintic_inout     { GOBLIB_INLINE constexpr float operator()(const float t) const { return quintic_inout(t); } };
 
 #if defined(__GNUG__) && !defined(__clang__)
-struct easing_sinusoidal_in     { GOBLIB_INLINE constexpr float operator()(const float t) const { return sinusoidal_in(t); } };
-struct easing_sinusoidal_out    { GOBLIB_INLINE constexpr float operator()(const float t) const { return sinusoidal_out(t); } };
-struct easing_sinusoidal_inout  { GOBLIB_INLINE constexpr float operator()(const float t) const { return sinusoidal_inout(t); } };
+struct easing_sinusoidal_in
+{
+    GOBLIB_INLINE constexpr float operator()(const float t) const { return sinusoidal_in(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return sinusoidal_in(t); }
+};
+struct easing_sinusoidal_out
+{
+    GOBLIB_INLINE constexpr float operator()(const float t) const { return sinusoidal_out(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return sinusoidal_out(t); }
+};
+struct easing_sinusoidal_inout
+{
+    GOBLIB_INLINE constexpr float operator()(const float t) const { return sinusoidal_inout(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return sinusoidal_inout(t); }
+};
 #else
-struct easing_sinusoidal_in     { GOBLIB_INLINE float operator()(const float t) const { return sinusoidal_in(t); } };
-struct easing_sinusoidal_out    { GOBLIB_INLINE float operator()(const float t) const { return sinusoidal_out(t); } };
-struct easing_sinusoidal_inout  { GOBLIB_INLINE float operator()(const float t) const { return sinusoidal_inout(t); } };
+struct easing_sinusoidal_in
+{
+    GOBLIB_INLINE float operator()(const float t) const { return sinusoidal_in(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return sinusoidal_in(t); }
+};
+struct easing_sinusoidal_out
+{
+    GOBLIB_INLINE float operator()(const float t) const { return sinusoidal_out(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return sinusoidal_out(t); }
+};
+struct easing_sinusoidal_inout
+{
+    GOBLIB_INLINE float operator()(const float t) const { return sinusoidal_inout(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return sinusoidal_inout(t); }
+};
 #endif
 
 #if defined(__GNUG__) && !defined(__clang__)
@@ -316,13 +392,43 @@ struct easing_exponential_inout { GOBLIB_INLINE float operator()(const float t)
 #endif
 
 #if defined(__GNUG__) && !defined(__clang__)
-struct easing_circular_in       { GOBLIB_INLINE constexpr float operator()(const float t) const { return circular_in(t); } };
-struct easing_circular_out      { GOBLIB_INLINE constexpr float operator()(const float t) const { return circular_out(t); } };
-struct easing_circular_inout    { GOBLIB_INLINE constexpr float operator()(const float t) const { return circular_inout(t); } };
+struct easing_circular_in
+{
+    GOBLIB_INLINE constexpr float operator()(const float t) const { return circular_in(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return circular_in(t); }
+};
+struct easing_circular_out
+{
+    GOBLIB_INLINE constexpr float operator()(const float t) const { return circular_out(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return circular_out(t); }
+};
+struct easing_circular_inout
+{
+    GOBLIB_INLINE constexpr float operator()(const float t) const { return circular_inout(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return circular_inout(t); }
+};
 #else
-struct easing_circular_in       { GOBLIB_INLINE float operator()(const float t) const { return circular_in(t); } };
-struct easing_circular_out      { GOBLIB_INLINE float operator()(const float t) const { return circular_out(t); } };
-struct easing_circular_inout    { GOBLIB_INLINE float operator()(const float t) const { return circular_inout(t); } };
+struct easing_circular_in
+{
+    GOBLIB_INLINE float operator()(const float t) const { return circular_in(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return circular_in(t); }
+};
+struct easing_circular_out
+{
+    GOBLIB_INLINE float operator()(const float t) const { return circular_out(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return circular_out(t); }
+};
+struct easing_circular_inout
+{
+    GOBLIB_INLINE float operator()(const float t) const { return circular_inout(t); }
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const { return circular_inout(t); }
+};
 #endif
 
 struct easing_back_in           { GOBLIB_INLINE constexpr float operator()(const float t) const { return back_in(t); } };
@@ -344,10 +450,208 @@ struct easing_bounce_out        { GOBLIB_INLINE constexpr float operator()(const
 struct easing_bounce_inout      { GOBLIB_INLINE constexpr float operator()(const float t) const { return bounce_inout(t); } };
 
 
+/// @cond
+namespace detail
+{
+// Math on compile for tables. (std::sin, std::pow, std::sqrt are not constexpr)
+constexpr double ce_sin_series(const double x2, const double term, const int n)
+{
+    return n > 14 ? term : term + ce_sin_series(x2, -term * x2 / ((2 * n) * (2 * n + 1)), n + 1);
+}
+// To [-pi, pi]
+constexpr double ce_reduce(const double x)
+{
+    return x - math::constants::pi2_d * static_cast<double>(static_cast<long long>(x / math::constants::pi2_d + (x >= 0.0 ? 0.5 : -0.5)));
+}
+constexpr double ce_sin(const double x) { return ce_sin_series(ce_reduce(x) * ce_reduce(x), ce_reduce(x), 1); }
+constexpr double ce_cos(const double x) { return ce_sin(x + math::constants::half_pi_d); }
+
+constexpr double ce_exp_series(const double x, const double term, const int n)
+{
+    return n > 20 ? term : term + ce_exp_series(x, term * x / n, n + 1);
+}
+constexpr double ce_pow2i(const long long n) { return n == 0 ? 1.0 : n > 0 ? 2.0 * ce_pow2i(n - 1) : 0.5 * ce_pow2i(n + 1); }
+constexpr long long ce_floor(const double x)
+{
+    return static_cast<long long>(x) - (x < static_cast<double>(static_cast<long long>(x)) ? 1 : 0);
+}
+// 2^x
+constexpr double ce_exp2(const double x)
+{
+    return ce_pow2i(ce_floor(x)) * ce_exp_series((x - static_cast<double>(ce_floor(x))) * 0.69314718055994530942, 1.0, 1);
+}
+
+constexpr double ce_sqrt_newton(const double x, const double g, const int n)
+{
+    return n == 0 ? g : ce_sqrt_newton(x, 0.5 * (g + x / g), n - 1);
+}
+constexpr double ce_sqrt(const double x) { return x <= 0.0 ? 0.0 : ce_sqrt_newton(x, x > 1.0 ? x : 1.0, 40); }
+
+// Evaluate functor on compile. Specialized for functors that are not constexpr.
+template<class F> struct easing_evaluator
+{
+    constexpr static double eval(const double t) { return F()(static_cast<float>(t)); }
+};
+template<> struct easing_evaluator<easing_sinusoidal_in>
+{
+    constexpr static double eval(const double t) { return 1.0 - ce_cos(t * math::constants::half_pi_d); }
+};
+template<> struct easing_evaluator<easing_sinusoidal_out>
+{
+    constexpr static double eval(const double t) { return ce_sin(t * math::constants::half_pi_d); }
+};
+template<> struct easing_evaluator<easing_sinusoidal_inout>
+{
+    constexpr static double eval(const double t) { return -0.5 * (ce_cos(t * math::constants::pi_d) - 1.0); }
+};
+template<> struct easing_evaluator<easing_exponential_in>
+{
+    constexpr static double eval(const double t) { return t == 0.0 ? 0.0 : ce_exp2(10.0 * (t - 1.0)); }
+};
+template<> struct easing_evaluator<easing_exponential_out>
+{
+    constexpr static double eval(const double t) { return t == 1.0 ? 1.0 : 1.0 - ce_exp2(-10.0 * t); }
+};
+template<> struct easing_evaluator<easing_exponential_inout>
+{
+    constexpr static double eval(const double t)
+    {
+        return t == 0.0 ? 0.0 : t == 1.0 ? 1.0 :
+                (t * 2.0) < 1.0 ? 0.5 * ce_exp2(10.0 * (t * 2.0 - 1.0)) : 0.5 * (2.0 - ce_exp2(-10.0 * (t * 2.0 - 1.0)));
+    }
+};
+template<> struct easing_evaluator<easing_circular_in>
+{
+    constexpr static double eval(const double t) { return 1.0 - ce_sqrt(1.0 - t * t); }
+};
+template<> struct easing_evaluator<easing_circular_out>
+{
+    constexpr static double eval(const double t) { return ce_sqrt(1.0 - (t - 1.0) * (t - 1.0)); }
+};
+template<> struct easing_evaluator<easing_circular_inout>
+{
+    constexpr static double eval(const double t)
+    {
+        return (t * 2.0) < 1.0 ? -0.5 * (ce_sqrt(1.0 - (t * 2.0) * (t * 2.0)) - 1.0) : 0.5 * (ce_sqrt(1.0 - (t * 2.0 - 2.0) * (t * 2.0 - 2.0)) + 1.0);
+    }
+};
+template<> struct easing_evaluator<easing_elastic_in>
+{
+    constexpr static double eval(const double t)
+    {
+        return t <= 0.0 ? 0.0 : t >= 1.0 ? 1.0 : -ce_exp2(10.0 * t - 10.0) * ce_sin((t * 10.0 - 10.75) * (math::constants::pi2_d / 3.0));
+    }
+};
+template<> struct easing_evaluator<easing_elastic_out>
+{
+    constexpr static double eval(const double t)
+    {
+        return t <= 0.0 ? 0.0 : t >= 1.0 ? 1.0 : ce_exp2(-10.0 * t) * ce_sin((t * 10.0 - 0.75) * (math::constants::pi2_d / 3.0)) + 1.0;
+    }
+};
+template<> struct easing_evaluator<easing_elastic_inout>
+{
+    constexpr static double eval(const double t)
+    {
+        return t <= 0.0 ? 0.0 : t >= 1.0 ? 1.0 :
+                t < 0.5 ? -0.5 * (ce_exp2(20.0 * t - 10.0) * ce_sin((20.0 * t - 11.125) * (math::constants::pi2_d / 4.5))) :
+                0.5 * (ce_exp2(-20.0 * t + 10.0) * ce_sin((20.0 * t - 11.125) * (math::constants::pi2_d / 4.5))) + 1.0;
+    }
+};
+
+template<class F, std::size_t N> constexpr float easing_sample(const std::size_t i)
+{
+    return static_cast<float>(easing_evaluator<F>::eval(static_cast<double>(i) / N));
+}
+// Q16
+template<class F, std::size_t N> constexpr std::int32_t easing_sample_fixed(const std::size_t i)
+{
+    return static_cast<std::int32_t>(easing_evaluator<F>::eval(static_cast<double>(i) / N) * 65536.0 + (easing_evaluator<F>::eval(static_cast<double>(i) / N) < 0.0 ? -0.5 : 0.5));
+}
+//
+}
+/// @endcond
+
+/*!
+  @brief Easing functor by lookup table
+  @details The table of EasingFunctor is built on compile, and sampled with linear interpolation.
+  Useful for the functors calling std::sin, std::pow or std::sqrt.
+  @tparam EasingFunctor Easing functor structure.
+  @tparam N Resolution (Number of divisions)
+  @note FixedPointNumber is sampled from Q16 table without floating point.
+  @note In C++11, N is limited by the depth of template instantiation (about 800).
+@code
+goblib::easing::Easing<float, goblib::easing::EasingTable<goblib::easing::easing_elastic_out, 128>> e;
+@endcode
+*/
+template<class EasingFunctor, std::size_t N = 256> struct EasingTable
+{
+    static_assert(N >= 2, "N must be 2 or more");
+    constexpr static std::size_t RESOLUTION = N;
+    constexpr static std::array<float, N + 1> table = goblib::template_helper::table::generator<N + 1>(detail::easing_sample<EasingFunctor, N>);
+    constexpr static std::array<std::int32_t, N + 1> fixed_table = goblib::template_helper::table::generator<N + 1>(detail::easing_sample_fixed<EasingFunctor, N>);
+
+    GOBLIB_INLINE float operator()(const float t) const
+    {
+        const float p = (t <= 0.0f ? 0.0f : t >= 1.0f ? 1.0f : t) * N;
+        const std::size_t i = std::min(static_cast<std::size_t>(p), N - 1);
+        return table[i] + (table[i + 1] - table[i]) * (p - static_cast<float>(i));
+    }
+
+    template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE T operator()(const T t) const
+    {
+        constexpr std::int64_t one = std::int64_t(1) << T::FRACTION;
+        const std::int64_t raw = t.raw() <= 0 ? 0 : (t.raw() >= one ? one : t.raw());
+        const std::int64_t pos = raw * static_cast<std::int64_t>(N);
+        const std::size_t i = std::min(static_cast<std::size_t>(pos >> T::FRACTION), N - 1);
+        const std::int64_t frac = pos - (static_cast<std::int64_t>(i) << T::FRACTION);
+        const std::int64_t v = fixed_table[i] + (((static_cast<std::int64_t>(fixed_table[i + 1]) - fixed_table[i]) * frac) >> T::FRACTION); // Q16
+        return T::from_raw(static_cast<typename T::base_type>(
+            T::FRACTION >= 16 ? v * (std::int64_t(1) << (T::FRACTION >= 16 ? T::FRACTION - 16 : 0))
+            :                   (v + (std::int64_t(1) << (T::FRACTION < 16 ? 15 - T::FRACTION : 0))) >> (T::FRACTION < 16 ? 16 - T::FRACTION : 0)));
+    }
+};
+template<class F, std::size_t N> constexpr std::size_t EasingTable<F, N>::RESOLUTION;
+template<class F, std::size_t N> constexpr std::array<float, N + 1> EasingTable<F, N>::table;
+template<class F, std::size_t N> constexpr std::array<std::int32_t, N + 1> EasingTable<F, N>::fixed_table;
+
+/// @cond
+namespace detail
+{
+// Is T FixedPointNumber and F has operator()(T) returning T?
+template<class T, class F, class = void> struct has_fixed_easing : std::false_type {};
+template<class T, class F> struct has_fixed_easing<T, F,
+    typename std::enable_if<goblib::is_fixed_point_number<T>::value &&
+                            std::is_same<T, decltype(std::declval<const F&>()(std::declval<const T>()))>::value>::type>
+    : std::true_type {};
+
+// Value at count/times. FixedPointNumber is evaluated without floating point if F supports it.
+template<class T, class F, typename std::enable_if<has_fixed_easing<T, F>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE T easing_lerp(const F& f, const T& from, const T& to, const std::uint32_t count, const std::uint32_t times)
+{
+    if(count >= times) { return to; } // Fixed point functor may not reach 1 exactly.
+    const T t = T::from_raw(static_cast<typename T::base_type>((static_cast<std::int64_t>(count) << T::FRACTION) / times));
+    const T e = f(t);
+    return (from * (T(1) - e)) + (to * e);
+}
+template<class T, class F, typename std::enable_if<!has_fixed_easing<T, F>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE T easing_lerp(const F& f, const T& from, const T& to, const std::uint32_t count, const std::uint32_t times)
+{
+    const float e = f(static_cast<float>(count) / times);
+    return (from * (1.0f - e)) + (to * e);
+}
+//
+}
+/// @endcond
+
+
 /*!
   @brief Easing wrapper
   @tparam T type of value.
   @tparam EasingFunctor Easing functor structure.
+  @note If T is FixedPointNumber and EasingFunctor has the overload for it (e.g. sinusoidal, circular, EasingTable),
+  pump() evaluates without floating point.
  */
 template<class T, class EasingFunctor> class Easing
 {
@@ -355,7 +659,7 @@ template<class T, class EasingFunctor> class Easing
     static_assert(goblib::template_helper::is_return_type< float, EasingFunctor, const float>::value, "EasingFunctor must be return float");
 
   public:
-    explicit Easing(const T& cur = 0) : _behavior(), _current(cur), _from(0), _to(0), _count(0), _times(0) {}
+    explicit Easing(const T& cur = T(0)) : _behavior(), _current(cur), _from(0), _to(0), _count(0), _times(0) {}
 
     /// @name Property
     /// @{
@@ -394,13 +698,13 @@ template<class T, class EasingFunctor> class Easing
     {
     if(!_times) { return; }
     
-    _current = value(static_cast<float>(++_count)/_times);
-
-    if(_count >= _times)
+    if(++_count >= _times)
     {
-        _current = value(1.0f);
+        _current = detail::easing_lerp(_behavior, _from, _to, 1, 1);
         _count = _times = 0;
+        return;
     }
+    _current = detail::easing_lerp(_behavior, _from, _to, _count, _times);
     }
     
   private:
@@ -409,6 +713,95 @@ template<class T, class EasingFunctor> class Easing
     std::uint32_t _count, _times;
 };
 
+/*!
+  @brief Group of easing with the same functor
+  @details Each slot behaves as Easing, and pump() advances all slots in one loop over contiguous arrays.
+  @tparam T type of value.
+  @tparam EasingFunctor Easing functor structure. (EasingTable is suitable)
+  @tparam Max Number of slots.
+  @note As Easing, FixedPointNumber is evaluated without floating point if EasingFunctor supports it.
+ */
+template<class T, class EasingFunctor, std::size_t Max> class EasingGroup
+{
+    static_assert(goblib::template_helper::is_callable< EasingFunctor, const float>::value,"Unable to call EasingFunctor");
+    static_assert(goblib::template_helper::is_return_type< float, EasingFunctor, const float>::value, "EasingFunctor must be return float");
+    static_assert(Max > 0, "Max must be greater than zero");
+
+  public:
+    EasingGroup() : _behavior(), _busy(0)
+    {
+        _current.fill(T(0));
+        _from.fill(T(0));
+        _to.fill(T(0));
+        _count.fill(0);
+        _times.fill(0);
+    }
+
+    /// @name Property
+    /// @{
+    constexpr static std::size_t size() { return Max; }
+    GOBLIB_INLINE T value(const std::size_t i) const { return _current[i]; }
+    GOBLIB_INLINE const T* values() const { return _current.data(); }
+    GOBLIB_INLINE bool busy(const std::size_t i) const { return _times[i]; }
+    /*! @brief Number of busy slots */
+    GOBLIB_INLINE std::size_t busyCount() const { return _busy; }
+    /// @}
+
+    /*!
+      Start easing
+      @param i Slot
+      @param from Value of start
+      @param to Value of end
+      @param times Number of call pump() required to change from [from] to [to].
+     */
+    void start(const std::size_t i, const T& from, const T& to, const std::uint32_t& times)
+    {
+        assert(i < Max && "Out of range");
+        _busy += (times != 0) - (_times[i] != 0);
+        _current[i] = _from[i] = from;
+        _to[i] = to;
+        _times[i] = times;
+        _count[i] = 0;
+    }
+    /*! Start easing from current value. */
+    void start(const std::size_t i, const T& to, const std::uint32_t& times)
+    {
+        start(i, _current[i], to, times);
+    }
+    /*! Stop easing and keep current value. */
+    void stop(const std::size_t i)
+    {
+        _busy -= (_times[i] != 0);
+        _count[i] = _times[i] = 0;
+    }
+
+    /*! change current values */
+    void pump()
+    {
+        if(!_busy) { return; }
+        for(std::size_t i = 0; i < Max; ++i)
+        {
+            if(!_times[i]) { continue; }
+            const std::uint32_t c = ++_count[i];
+            if(c >= _times[i])
+            {
+                _current[i] = detail::easing_lerp(_behavior, _from[i], _to[i], 1, 1);
+                _count[i] = _times[i] = 0;
+                --_busy;
+                continue;
+            }
+            _current[i] = detail::easing_lerp(_behavior, _from[i], _to[i], c, _times[i]);
+        }
+    }
+
+  private:
+
+    EasingFunctor _behavior;
+    std::array<T, Max> _current, _from, _to;
+    std::array<std::uint32_t, Max> _count, _times;
+    std::size_t _busy;
+};
+
 // Easing wrapper classes
 template<typename T> class EaseLerp         : public Easing<T, easing::easing_linear>{};
 
@@ -2,7 +2,7 @@
   Goblin Library
 
   @file   gob_endianness.hpp
-  @brief  Determine endianness.
+  @brief  Determine endianness and byte swap.
 */
 #pragma once
 #ifndef GOBLIB_ENDIANNESS_HPP
@@ -12,9 +12,26 @@
 
 #if defined(GOBLIB_CPP20_OR_LATER)
 #include <bit> // std::endian
-#else
+#endif
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#if defined(_MSC_VER)
+# include <stdlib.h> // _byteswap_*
+#endif
+
+/// @cond
+#if !defined(GOBLIB_ENDIAN_NO_SIMD)
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define GOBLIB_ENDIAN_SSE2
+#   include <emmintrin.h>
+# elif defined(__ARM_NEON)
+#   define GOBLIB_ENDIAN_NEON
+#   include <arm_neon.h>
+# endif
 #endif
+/// @endcond
 
 namespace goblib
 {
@@ -43,6 +60,166 @@ constexpr bool other = !little && !big; //!< true if other endian.
 /// @}
 #endif
 static_assert(little || big || other, "Unable to determine endianness!");
+
+/*! @brief Byte order of data */
+enum class Order : std::uint8_t
+{
+    Little,                         //!< Little endian
+    Big,                            //!< Big endian
+    Native = big ? Big : Little,    //!< Endian of this platform
+};
+
+/// @name Byte swap
+/// @{
+GOBLIB_INLINE std::uint16_t byteswap16(const std::uint16_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(v);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(v);
+#else
+    return static_cast<std::uint16_t>((v << 8) | (v >> 8));
+#endif
+}
+GOBLIB_INLINE std::uint32_t byteswap32(const std::uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(v);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(v);
+#else
+    return (v << 24) | ((v & 0xFF00U) << 8) | ((v >> 8) & 0xFF00U) | (v >> 24);
+#endif
+}
+GOBLIB_INLINE std::uint64_t byteswap64(const std::uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(v);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(v);
+#else
+    return (static_cast<std::uint64_t>(byteswap32(static_cast<std::uint32_t>(v))) << 32) | byteswap32(static_cast<std::uint32_t>(v >> 32));
+#endif
+}
+
+/// @cond
+namespace detail
+{
+template<std::size_t N> struct swap_unit {};
+template<> struct swap_unit<1> { using type = std::uint8_t;  static GOBLIB_INLINE type swap(const type v) { return v; } };
+template<> struct swap_unit<2> { using type = std::uint16_t; static GOBLIB_INLINE type swap(const type v) { return byteswap16(v); } };
+template<> struct swap_unit<4> { using type = std::uint32_t; static GOBLIB_INLINE type swap(const type v) { return byteswap32(v); } };
+template<> struct swap_unit<8> { using type = std::uint64_t; static GOBLIB_INLINE type swap(const type v) { return byteswap64(v); } };
+
+// Swap bytes in every N bytes of buf. Returns processed bytes. (Primary does nothing, caller finishes the tail)
+template<std::size_t N> GOBLIB_INLINE std::size_t swap_block(std::uint8_t*, std::size_t) { return 0; }
+
+#if defined(GOBLIB_ENDIAN_SSE2)
+GOBLIB_INLINE __m128i swap_bytes16(const __m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+GOBLIB_INLINE __m128i swap_words32(const __m128i v)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+GOBLIB_INLINE __m128i swap_words64(const __m128i v)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+}
+template<std::size_t N> GOBLIB_INLINE __m128i swap_lanes(const __m128i v);
+template<> GOBLIB_INLINE __m128i swap_lanes<2>(const __m128i v) { return swap_bytes16(v); }
+template<> GOBLIB_INLINE __m128i swap_lanes<4>(const __m128i v) { return swap_bytes16(swap_words32(v)); }
+template<> GOBLIB_INLINE __m128i swap_lanes<8>(const __m128i v) { return swap_bytes16(swap_words64(v)); }
+
+template<std::size_t N> GOBLIB_INLINE std::size_t swap_block_sse2(std::uint8_t* buf, const std::size_t bytes)
+{
+    std::size_t i = 0;
+    for(; i + 16 <= bytes; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i), swap_lanes<N>(v));
+    }
+    return i;
+}
+template<> GOBLIB_INLINE std::size_t swap_block<2>(std::uint8_t* buf, std::size_t bytes) { return swap_block_sse2<2>(buf, bytes); }
+template<> GOBLIB_INLINE std::size_t swap_block<4>(std::uint8_t* buf, std::size_t bytes) { return swap_block_sse2<4>(buf, bytes); }
+template<> GOBLIB_INLINE std::size_t swap_block<8>(std::uint8_t* buf, std::size_t bytes) { return swap_block_sse2<8>(buf, bytes); }
+#elif defined(GOBLIB_ENDIAN_NEON)
+template<std::size_t N> GOBLIB_INLINE uint8x16_t swap_lanes(const uint8x16_t v);
+template<> GOBLIB_INLINE uint8x16_t swap_lanes<2>(const uint8x16_t v) { return vrev16q_u8(v); }
+template<> GOBLIB_INLINE uint8x16_t swap_lanes<4>(const uint8x16_t v) { return vrev32q_u8(v); }
+template<> GOBLIB_INLINE uint8x16_t swap_lanes<8>(const uint8x16_t v) { return vrev64q_u8(v); }
+
+template<std::size_t N> GOBLIB_INLINE std::size_t swap_block_neon(std::uint8_t* buf, const std::size_t bytes)
+{
+    std::size_t i = 0;
+    for(; i + 16 <= bytes; i += 16) { vst1q_u8(buf + i, swap_lanes<N>(vld1q_u8(buf + i))); }
+    return i;
+}
+template<> GOBLIB_INLINE std::size_t swap_block<2>(std::uint8_t* buf, std::size_t bytes) { return swap_block_neon<2>(buf, bytes); }
+template<> GOBLIB_INLINE std::size_t swap_block<4>(std::uint8_t* buf, std::size_t bytes) { return swap_block_neon<4>(buf, bytes); }
+template<> GOBLIB_INLINE std::size_t swap_block<8>(std::uint8_t* buf, std::size_t bytes) { return swap_block_neon<8>(buf, bytes); }
+#endif
+//
+}
+/// @endcond
+
+/*!
+  @brief Reverses the bytes of value
+  @tparam T Trivially copyable type of size 1, 2, 4 or 8. (Integer, floating point, enum...)
+*/
+template<typename T> GOBLIB_INLINE T byteswap(const T v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    using U = detail::swap_unit<sizeof(T)>;
+    typename U::type u;
+    std::memcpy(&u, &v, sizeof(T));
+    u = U::swap(u);
+    T r;
+    std::memcpy(&r, &u, sizeof(T));
+    return r;
+}
+
+/*!
+  @brief Reverses the bytes of each element in place
+  @details Uses SSE2 or NEON if available. (GOBLIB_ENDIAN_NO_SIMD to disable)
+  @param buf Head of elements (Not required to be aligned)
+  @param count Number of elements
+*/
+template<typename T> void byteswap(T* buf, const std::size_t count)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    constexpr std::size_t N = sizeof(T);
+    if(N == 1 || !count) { return; }
+    using U = detail::swap_unit<N>;
+    std::uint8_t* p = reinterpret_cast<std::uint8_t*>(buf);
+    const std::size_t bytes = count * N;
+    for(std::size_t i = detail::swap_block<N>(p, bytes); i < bytes; i += N)
+    {
+        typename U::type u;
+        std::memcpy(&u, p + i, N);
+        u = U::swap(u);
+        std::memcpy(p + i, &u, N);
+    }
+}
+/// @}
+
+/// @name Conversion
+/// @note No-op if O is Order::Native.
+/// @{
+/*! @brief Converts value between byte order O and native */
+template<Order O, typename T> GOBLIB_INLINE T convert(const T v)
+{
+    return (O == Order::Native) ? v : byteswap(v);
+}
+/*! @brief Converts elements between byte order O and native in place */
+template<Order O, typename T> GOBLIB_INLINE void convert(T* buf, const std::size_t count)
+{
+    if(O != Order::Native) { byteswap(buf, count); }
+}
+/// @}
+//
 }
 
 //
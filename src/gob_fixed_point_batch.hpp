@@ -0,0 +1,345 @@
+/*!
+  Goblin Library
+
+  @file   gob_fixed_point_batch.hpp
+  @brief  Batch arithmetic for arrays of FixedPointNumber.
+*/
+#pragma once
+#ifndef GOBLIB_FIXED_POINT_BATCH_HPP
+#define GOBLIB_FIXED_POINT_BATCH_HPP
+
+#include "gob_fixed_point_number.hpp"
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+/// @cond
+#if !defined(GOBLIB_FIXED_POINT_BATCH_NO_SIMD)
+# if defined(__AVX2__)
+#   define GOBLIB_FIXED_POINT_BATCH_AVX2
+#   include <immintrin.h>
+# elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define GOBLIB_FIXED_POINT_BATCH_SSE2
+#   include <emmintrin.h>
+# elif defined(__ARM_NEON)
+#   define GOBLIB_FIXED_POINT_BATCH_NEON
+#   include <arm_neon.h>
+# endif
+#endif
+/// @endcond
+
+namespace goblib
+{
+/*!
+  @brief Batch kernels over contiguous arrays.
+  @details Results are bit-for-bit identical to the scalar operators of FixedPointNumber,
+  so they can be used for deterministic (lockstep) simulation.<br>
+  FixedPointNumber<std::int32_t, 1...30> uses AVX2, SSE2 or NEON if available, others use scalar operators.
+  Division is always scalar (no integer division in SIMD).
+  @note Define GOBLIB_FIXED_POINT_BATCH_NO_SIMD to disable SIMD.
+  @note Output may be the same array as input.
+*/
+namespace batch
+{
+
+/// @cond
+namespace detail
+{
+// Scalar kernels. (Return processed count)
+template<typename BT, std::size_t F, bool SIMD> struct FixedKernel
+{
+    using FP = FixedPointNumber<BT, F>;
+    static GOBLIB_INLINE std::size_t add(FP*, const FP*, const FP*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t sub(FP*, const FP*, const FP*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t mul(FP*, const FP*, const FP*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t mac(FP*, const FP*, const FP*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t lerp(FP*, const FP*, const FP*, const FP, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t to_float(float*, const FP*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t from_float(FP*, const float*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t to_int(std::int32_t*, const FP*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t from_int(FP*, const std::int32_t*, const std::size_t) { return 0; }
+};
+
+#if defined(GOBLIB_FIXED_POINT_BATCH_AVX2) || defined(GOBLIB_FIXED_POINT_BATCH_SSE2) || defined(GOBLIB_FIXED_POINT_BATCH_NEON)
+constexpr bool fixed_simd = true;
+#else
+constexpr bool fixed_simd = false;
+#endif
+
+template<typename BT, std::size_t F> struct FixedSimd
+        : std::integral_constant<bool, fixed_simd && std::is_same<BT, std::int32_t>::value && (F >= 1) && (F <= 30)> {};
+
+/*
+  Multiplication same as FixedPointNumber::operator*=.
+  T = a * b (64bit), iv = T / 2^(F-1) (truncate), result = iv / 2 + (iv & 1)
+  By magnitude M = |T| and sign s, result = s * (M >> F) + ((M >> (F - 1)) & 1) (mod 2^32)
+*/
+#if defined(GOBLIB_FIXED_POINT_BATCH_AVX2)
+using vi32 = __m256i;
+constexpr std::size_t LANES = 8;
+GOBLIB_INLINE vi32 load(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+GOBLIB_INLINE void store(void* p, const vi32 v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+GOBLIB_INLINE vi32 add(const vi32 a, const vi32 b) { return _mm256_add_epi32(a, b); }
+GOBLIB_INLINE vi32 sub(const vi32 a, const vi32 b) { return _mm256_sub_epi32(a, b); }
+GOBLIB_INLINE vi32 splat(const std::int32_t v) { return _mm256_set1_epi32(v); }
+template<std::size_t F> GOBLIB_INLINE vi32 mul(const vi32 a, const vi32 b)
+{
+    const vi32 sgn = _mm256_srai_epi32(_mm256_xor_si256(a, b), 31);
+    const vi32 ua = _mm256_abs_epi32(a), ub = _mm256_abs_epi32(b);
+    const vi32 p02 = _mm256_mul_epu32(ua, ub);
+    const vi32 p13 = _mm256_mul_epu32(_mm256_srli_epi64(ua, 32), _mm256_srli_epi64(ub, 32));
+    const vi32 lo = _mm256_set1_epi64x(0xFFFFFFFF);
+    const vi32 q = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi64(p02, F), lo), _mm256_slli_epi64(_mm256_srli_epi64(p13, F), 32));
+    const vi32 o = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi64(p02, F - 1), lo), _mm256_slli_epi64(_mm256_srli_epi64(p13, F - 1), 32));
+    return _mm256_add_epi32(_mm256_sub_epi32(_mm256_xor_si256(q, sgn), sgn), _mm256_and_si256(o, _mm256_set1_epi32(1)));
+}
+template<std::size_t F> GOBLIB_INLINE void to_float(float* dst, const vi32 v)
+{
+    _mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / (1 << F))));
+}
+template<std::size_t F> GOBLIB_INLINE vi32 from_float(const float* src)
+{
+    return _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src), _mm256_set1_ps(static_cast<float>(1 << F))));
+}
+template<std::size_t F> GOBLIB_INLINE vi32 to_int(const vi32 v)
+{
+    // Truncate toward zero
+    return _mm256_srai_epi32(_mm256_add_epi32(v, _mm256_and_si256(_mm256_srai_epi32(v, 31), _mm256_set1_epi32((1 << F) - 1))), F);
+}
+template<std::size_t F> GOBLIB_INLINE vi32 from_int(const vi32 v) { return _mm256_slli_epi32(v, F); }
+
+#elif defined(GOBLIB_FIXED_POINT_BATCH_SSE2)
+using vi32 = __m128i;
+constexpr std::size_t LANES = 4;
+GOBLIB_INLINE vi32 load(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+GOBLIB_INLINE void store(void* p, const vi32 v) { _mm_storeu_si128(static_cast<__m128i*>(p), v); }
+GOBLIB_INLINE vi32 add(const vi32 a, const vi32 b) { return _mm_add_epi32(a, b); }
+GOBLIB_INLINE vi32 sub(const vi32 a, const vi32 b) { return _mm_sub_epi32(a, b); }
+GOBLIB_INLINE vi32 splat(const std::int32_t v) { return _mm_set1_epi32(v); }
+template<std::size_t F> GOBLIB_INLINE vi32 mul(const vi32 a, const vi32 b)
+{
+    const vi32 sa = _mm_srai_epi32(a, 31), sb = _mm_srai_epi32(b, 31);
+    const vi32 sgn = _mm_xor_si128(sa, sb);
+    const vi32 ua = _mm_sub_epi32(_mm_xor_si128(a, sa), sa), ub = _mm_sub_epi32(_mm_xor_si128(b, sb), sb);
+    const vi32 p02 = _mm_mul_epu32(ua, ub);
+    const vi32 p13 = _mm_mul_epu32(_mm_srli_epi64(ua, 32), _mm_srli_epi64(ub, 32));
+    const vi32 lo = _mm_set_epi32(0, -1, 0, -1);
+    const vi32 q = _mm_or_si128(_mm_and_si128(_mm_srli_epi64(p02, F), lo), _mm_slli_epi64(_mm_srli_epi64(p13, F), 32));
+    const vi32 o = _mm_or_si128(_mm_and_si128(_mm_srli_epi64(p02, F - 1), lo), _mm_slli_epi64(_mm_srli_epi64(p13, F - 1), 32));
+    return _mm_add_epi32(_mm_sub_epi32(_mm_xor_si128(q, sgn), sgn), _mm_and_si128(o, _mm_set1_epi32(1)));
+}
+template<std::size_t F> GOBLIB_INLINE void to_float(float* dst, const vi32 v)
+{
+    _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / (1 << F))));
+}
+template<std::size_t F> GOBLIB_INLINE vi32 from_float(const float* src)
+{
+    return _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src), _mm_set1_ps(static_cast<float>(1 << F))));
+}
+template<std::size_t F> GOBLIB_INLINE vi32 to_int(const vi32 v)
+{
+    return _mm_srai_epi32(_mm_add_epi32(v, _mm_and_si128(_mm_srai_epi32(v, 31), _mm_set1_epi32((1 << F) - 1))), F);
+}
+template<std::size_t F> GOBLIB_INLINE vi32 from_int(const vi32 v) { return _mm_slli_epi32(v, F); }
+
+#elif defined(GOBLIB_FIXED_POINT_BATCH_NEON)
+using vi32 = int32x4_t;
+constexpr std::size_t LANES = 4;
+GOBLIB_INLINE vi32 load(const void* p) { return vreinterpretq_s32_u8(vld1q_u8(static_cast<const std::uint8_t*>(p))); }
+GOBLIB_INLINE void store(void* p, const vi32 v) { vst1q_u8(static_cast<std::uint8_t*>(p), vreinterpretq_u8_s32(v)); }
+GOBLIB_INLINE vi32 add(const vi32 a, const vi32 b) { return vaddq_s32(a, b); }
+GOBLIB_INLINE vi32 sub(const vi32 a, const vi32 b) { return vsubq_s32(a, b); }
+GOBLIB_INLINE vi32 splat(const std::int32_t v) { return vdupq_n_s32(v); }
+template<std::size_t F> GOBLIB_INLINE vi32 mul(const vi32 a, const vi32 b)
+{
+    const vi32 sgn = vshrq_n_s32(veorq_s32(a, b), 31);
+    const uint32x4_t ua = vreinterpretq_u32_s32(vabsq_s32(a)), ub = vreinterpretq_u32_s32(vabsq_s32(b));
+    const uint64x2_t plo = vmull_u32(vget_low_u32(ua), vget_low_u32(ub));
+    const uint64x2_t phi = vmull_u32(vget_high_u32(ua), vget_high_u32(ub));
+    const int64x2_t sq = vdupq_n_s64(-static_cast<std::int64_t>(F)), so = vdupq_n_s64(-static_cast<std::int64_t>(F - 1));
+    const vi32 q = vreinterpretq_s32_u32(vcombine_u32(vmovn_u64(vshlq_u64(plo, sq)), vmovn_u64(vshlq_u64(phi, sq))));
+    const vi32 o = vreinterpretq_s32_u32(vcombine_u32(vmovn_u64(vshlq_u64(plo, so)), vmovn_u64(vshlq_u64(phi, so))));
+    return vaddq_s32(vsubq_s32(veorq_s32(q, sgn), sgn), vandq_s32(o, vdupq_n_s32(1)));
+}
+template<std::size_t F> GOBLIB_INLINE void to_float(float* dst, const vi32 v)
+{
+    vst1q_f32(dst, vmulq_n_f32(vcvtq_f32_s32(v), 1.0f / (1 << F)));
+}
+template<std::size_t F> GOBLIB_INLINE vi32 from_float(const float* src)
+{
+    return vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src), static_cast<float>(1 << F))); // Truncate toward zero
+}
+template<std::size_t F> GOBLIB_INLINE vi32 to_int(const vi32 v)
+{
+    return vshrq_n_s32(vaddq_s32(v, vandq_s32(vshrq_n_s32(v, 31), vdupq_n_s32((1 << F) - 1))), F);
+}
+template<std::size_t F> GOBLIB_INLINE vi32 from_int(const vi32 v) { return vshlq_n_s32(v, F); }
+#endif
+
+#if defined(GOBLIB_FIXED_POINT_BATCH_AVX2) || defined(GOBLIB_FIXED_POINT_BATCH_SSE2) || defined(GOBLIB_FIXED_POINT_BATCH_NEON)
+// SIMD kernels for std::int32_t.
+template<std::size_t F> struct FixedKernel<std::int32_t, F, true>
+{
+    using FP = FixedPointNumber<std::int32_t, F>;
+    static_assert(sizeof(FP) == sizeof(std::int32_t), "Layout of FixedPointNumber must be same as base type");
+
+    // Multiple of LANES not exceeding n. (i + LANES <= n may wrap, then the scalar tail can not be proved to end)
+    static GOBLIB_INLINE constexpr std::size_t vector_end(const std::size_t n) { return n - n % LANES; }
+
+    static std::size_t add(FP* dst, const FP* a, const FP* b, const std::size_t n)
+    {
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES) { store(dst + i, detail::add(load(a + i), load(b + i))); }
+        return i;
+    }
+    static std::size_t sub(FP* dst, const FP* a, const FP* b, const std::size_t n)
+    {
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES) { store(dst + i, detail::sub(load(a + i), load(b + i))); }
+        return i;
+    }
+    static std::size_t mul(FP* dst, const FP* a, const FP* b, const std::size_t n)
+    {
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES) { store(dst + i, detail::mul<F>(load(a + i), load(b + i))); }
+        return i;
+    }
+    static std::size_t mac(FP* dst, const FP* a, const FP* b, const std::size_t n)
+    {
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES) { store(dst + i, detail::add(load(dst + i), detail::mul<F>(load(a + i), load(b + i)))); }
+        return i;
+    }
+    static std::size_t lerp(FP* dst, const FP* a, const FP* b, const FP t, const std::size_t n)
+    {
+        const vi32 vt = splat(t.raw());
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES)
+        {
+            const vi32 va = load(a + i);
+            store(dst + i, detail::add(va, detail::mul<F>(detail::sub(load(b + i), va), vt)));
+        }
+        return i;
+    }
+    static std::size_t to_float(float* dst, const FP* src, const std::size_t n)
+    {
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES) { detail::to_float<F>(dst + i, load(src + i)); }
+        return i;
+    }
+    static std::size_t from_float(FP* dst, const float* src, const std::size_t n)
+    {
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES) { store(dst + i, detail::from_float<F>(src + i)); }
+        return i;
+    }
+    static std::size_t to_int(std::int32_t* dst, const FP* src, const std::size_t n)
+    {
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES) { store(dst + i, detail::to_int<F>(load(src + i))); }
+        return i;
+    }
+    static std::size_t from_int(FP* dst, const std::int32_t* src, const std::size_t n)
+    {
+        const std::size_t end = vector_end(n);
+        std::size_t i = 0;
+        for(; i < end; i += LANES) { store(dst + i, detail::from_int<F>(load(src + i))); }
+        return i;
+    }
+};
+#endif
+
+template<typename BT, std::size_t F> using FixedKernelOf = FixedKernel<BT, F, FixedSimd<BT, F>::value>;
+//
+}
+/// @endcond
+
+/// @name Arithmetic
+/// @{
+/*! @brief dst[i] = a[i] + b[i] */
+template<typename BT, std::size_t F>
+void add(FixedPointNumber<BT, F>* dst, const FixedPointNumber<BT, F>* a, const FixedPointNumber<BT, F>* b, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::add(dst, a, b, n);
+    for(; i < n; ++i) { dst[i] = a[i] + b[i]; }
+}
+/*! @brief dst[i] = a[i] - b[i] */
+template<typename BT, std::size_t F>
+void sub(FixedPointNumber<BT, F>* dst, const FixedPointNumber<BT, F>* a, const FixedPointNumber<BT, F>* b, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::sub(dst, a, b, n);
+    for(; i < n; ++i) { dst[i] = a[i] - b[i]; }
+}
+/*! @brief dst[i] = a[i] * b[i] */
+template<typename BT, std::size_t F>
+void mul(FixedPointNumber<BT, F>* dst, const FixedPointNumber<BT, F>* a, const FixedPointNumber<BT, F>* b, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::mul(dst, a, b, n);
+    for(; i < n; ++i) { dst[i] = a[i] * b[i]; }
+}
+/*! @brief dst[i] = a[i] / b[i] */
+template<typename BT, std::size_t F>
+void div(FixedPointNumber<BT, F>* dst, const FixedPointNumber<BT, F>* a, const FixedPointNumber<BT, F>* b, const std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i) { dst[i] = a[i] / b[i]; }
+}
+/*! @brief Multiply-accumulate dst[i] += a[i] * b[i] */
+template<typename BT, std::size_t F>
+void mac(FixedPointNumber<BT, F>* dst, const FixedPointNumber<BT, F>* a, const FixedPointNumber<BT, F>* b, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::mac(dst, a, b, n);
+    for(; i < n; ++i) { dst[i] += a[i] * b[i]; }
+}
+/*! @brief dst[i] = a[i] + (b[i] - a[i]) * t */
+template<typename BT, std::size_t F>
+void lerp(FixedPointNumber<BT, F>* dst, const FixedPointNumber<BT, F>* a, const FixedPointNumber<BT, F>* b, const FixedPointNumber<BT, F> t, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::lerp(dst, a, b, t, n);
+    for(; i < n; ++i) { dst[i] = a[i] + (b[i] - a[i]) * t; }
+}
+/// @}
+
+/// @name Conversion
+/// @{
+/*! @brief dst[i] = static_cast<float>(src[i]) */
+template<typename BT, std::size_t F>
+void to_float(float* dst, const FixedPointNumber<BT, F>* src, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::to_float(dst, src, n);
+    for(; i < n; ++i) { dst[i] = static_cast<float>(src[i]); }
+}
+/*! @brief dst[i] = FixedPointNumber(src[i]) */
+template<typename BT, std::size_t F>
+void from_float(FixedPointNumber<BT, F>* dst, const float* src, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::from_float(dst, src, n);
+    for(; i < n; ++i) { dst[i] = FixedPointNumber<BT, F>(src[i]); }
+}
+/*! @brief dst[i] = static_cast<std::int32_t>(src[i]) */
+template<typename BT, std::size_t F>
+void to_int(std::int32_t* dst, const FixedPointNumber<BT, F>* src, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::to_int(dst, src, n);
+    for(; i < n; ++i) { dst[i] = static_cast<std::int32_t>(src[i]); }
+}
+/*! @brief dst[i] = FixedPointNumber(src[i]) */
+template<typename BT, std::size_t F>
+void from_int(FixedPointNumber<BT, F>* dst, const std::int32_t* src, const std::size_t n)
+{
+    std::size_t i = detail::FixedKernelOf<BT, F>::from_int(dst, src, n);
+    for(; i < n; ++i) { dst[i] = FixedPointNumber<BT, F>(src[i]); }
+}
+/// @}
+
+//
+}}
+#endif
@@ -0,0 +1,183 @@
+/*!
+  Goblin Library
+
+  @file   gob_fixed_point_math.hpp
+  @brief  Math functions for FixedPointNumber without floating point.
+*/
+#pragma once
+#ifndef GOBLIB_FIXED_POINT_MATH_HPP
+#define GOBLIB_FIXED_POINT_MATH_HPP
+
+#include "gob_fixed_point_number.hpp"
+#include "gob_template_helper.hpp"
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+
+namespace goblib { namespace math {
+
+/// @cond
+namespace detail
+{
+// Taylor series of sin on compile.
+constexpr double sin_series(const double x2, const double term, const int n)
+{
+    return n > 12 ? term : term + sin_series(x2, -term * x2 / ((2 * n) * (2 * n + 1)), n + 1);
+}
+constexpr std::int32_t sin_q30(const std::size_t i)
+{
+    return static_cast<std::int32_t>(sin_series((i * (constants::pi_d / 512)) * (i * (constants::pi_d / 512)),
+                                                i * (constants::pi_d / 512), 1) * 1073741824.0 + 0.5);
+}
+
+// Quarter-wave table of sin (257 entries of [0, pi/2], Q30)
+template<typename D = void> struct SinTable
+{
+    constexpr static std::array<std::int32_t, 257> value = goblib::template_helper::table::generator<257>(sin_q30);
+};
+template<typename D> constexpr std::array<std::int32_t, 257> SinTable<D>::value;
+
+// Phase (Full circle is 2^32) to sin (Q30)
+GOBLIB_INLINE std::int32_t sin_phase(const std::uint32_t phase)
+{
+    const auto& t = SinTable<>::value;
+    std::uint32_t x = phase & 0x3FFFFFFFU;
+    if(phase & 0x40000000U) { x = 0x40000000U - x; }
+    const std::uint32_t idx = x >> 22;
+    std::int32_t v = t[idx];
+    if(idx < 256) { v += static_cast<std::int32_t>((static_cast<std::int64_t>(t[idx + 1] - t[idx]) * ((x >> 6) & 0xFFFFU)) >> 16); }
+    return (phase & 0x80000000U) ? -v : v;
+}
+
+// Radian to phase. (2^32 / 2pi = 683565276)
+template<typename T> GOBLIB_INLINE std::uint32_t to_phase(const T a)
+{
+    return static_cast<std::uint32_t>((static_cast<std::int64_t>(a.raw()) * 683565276LL) >> T::FRACTION);
+}
+
+// Q30 to T with rounding
+template<typename T> GOBLIB_INLINE T from_q30(const std::int64_t v)
+{
+    constexpr int sh = 30 - static_cast<int>(T::FRACTION);
+    return T::from_raw(static_cast<typename T::base_type>(
+        sh > 0 ? (v + (std::int64_t(1) << (sh > 0 ? sh - 1 : 0))) >> (sh > 0 ? sh : 0)
+        :        v * (std::int64_t(1) << (sh < 0 ? -sh : 0))));
+}
+
+template<typename T> struct fixed_math_supported
+        : std::integral_constant<bool, sizeof(typename T::base_type) <= 4 && sizeof(typename T::base_type) * 8 + T::FRACTION <= 64> {};
+//
+}
+/// @endcond
+
+/// @name Math functions for FixedPointNumber
+/// @note Base type must be 32bit or less.
+/// @{
+/*!
+  @brief Square root (Bitwise, rounded to nearest)
+  @pre v >= 0
+*/
+template<typename T> GOBLIB_INLINE auto sqrt(const T v)
+        -> typename std::enable_if<goblib::is_fixed_point_number<T>::value, T>::type
+{
+    static_assert(detail::fixed_math_supported<T>::value, "Base type must be 32bit or less, and bits + FRACTION <= 64");
+    using BT = typename T::base_type;
+    assert(v.raw() >= 0 && "Negative value");
+    if(v.raw() <= 0) { return T::from_raw(0); }
+
+    std::uint64_t n = static_cast<std::uint64_t>(v.raw()) << T::FRACTION;
+    std::uint64_t r = 0;
+    std::uint64_t bit = std::uint64_t(1) << 62;
+    while(bit > n) { bit >>= 2; }
+    while(bit)
+    {
+        if(n >= r + bit) { n -= r + bit; r = (r >> 1) + bit; }
+        else             { r >>= 1; }
+        bit >>= 2;
+    }
+    if(n > r) { ++r; } // Remainder is greater than r + 0.25
+    return T::from_raw(static_cast<BT>(r));
+}
+
+/*! @brief Sine (radian) by quarter-wave table with linear interpolation */
+template<typename T> GOBLIB_INLINE auto sin(const T a)
+        -> typename std::enable_if<goblib::is_fixed_point_number<T>::value, T>::type
+{
+    static_assert(detail::fixed_math_supported<T>::value, "Base type must be 32bit or less, and bits + FRACTION <= 64");
+    return detail::from_q30<T>(detail::sin_phase(detail::to_phase(a)));
+}
+
+/*! @brief Cosine (radian) by quarter-wave table with linear interpolation */
+template<typename T> GOBLIB_INLINE auto cos(const T a)
+        -> typename std::enable_if<goblib::is_fixed_point_number<T>::value, T>::type
+{
+    static_assert(detail::fixed_math_supported<T>::value, "Base type must be 32bit or less, and bits + FRACTION <= 64");
+    return detail::from_q30<T>(detail::sin_phase(detail::to_phase(a) + 0x40000000U));
+}
+
+/*!
+  @brief Arc tangent of y/x [-pi, pi] by CORDIC
+  @note T must be able to represent pi.
+*/
+template<typename T> auto atan2(const T y, const T x)
+        -> typename std::enable_if<goblib::is_fixed_point_number<T>::value, T>::type
+{
+    static_assert(detail::fixed_math_supported<T>::value, "Base type must be 32bit or less, and bits + FRACTION <= 64");
+    // atan(2^-i) (Q30)
+    static constexpr std::int64_t table[31] =
+    {
+        843314857, 497837829, 263043837, 133525159, 67021687, 33543516, 16775851, 8388437,
+        4194283, 2097149, 1048576, 524288, 262144, 131072, 65536, 32768,
+        16384, 8192, 4096, 2048, 1024, 512, 256, 128,
+        64, 32, 16, 8, 4, 2, 1
+    };
+    constexpr std::int64_t PI_Q30 = 3373259426LL;
+
+    std::int64_t xi = x.raw(), yi = y.raw();
+    if(!xi && !yi) { return T::from_raw(0); }
+
+    // Rotate to right half plane.
+    std::int64_t z = 0;
+    if(xi < 0)
+    {
+        z = (yi >= 0) ? PI_Q30 : -PI_Q30;
+        xi = -xi;
+        yi = -yi;
+    }
+    // Scale up for precision.
+    const std::int64_t m = std::max(xi, yi < 0 ? -yi : yi);
+    std::int64_t scale = 1;
+    while(m * scale < (std::int64_t(1) << 39)) { scale <<= 1; }
+    xi *= scale;
+    yi *= scale;
+
+    for(int i = 0; i < 31; ++i)
+    {
+        const std::int64_t dx = xi >> i, dy = yi >> i;
+        if(yi > 0) { xi += dy; yi -= dx; z += table[i]; }
+        else       { xi -= dy; yi += dx; z -= table[i]; }
+    }
+    return detail::from_q30<T>(z);
+}
+/// @}
+
+/// @name Math functions for arithmetic type (Same as std)
+/// @brief Templated code can call goblib::math::sqrt etc. for any type.
+/// @{
+template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE GOBLIB_CONSTEXPR_GCC auto sqrt(const T v) -> decltype(std::sqrt(v)) { return std::sqrt(v); }
+template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE GOBLIB_CONSTEXPR_GCC auto sin(const T v) -> decltype(std::sin(v)) { return std::sin(v); }
+template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE GOBLIB_CONSTEXPR_GCC auto cos(const T v) -> decltype(std::cos(v)) { return std::cos(v); }
+template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, std::nullptr_t>::type = nullptr>
+GOBLIB_INLINE GOBLIB_CONSTEXPR_GCC auto atan2(const T y, const T x) -> decltype(std::atan2(y, x)) { return std::atan2(y, x); }
+/// @}
+
+//
+}}
+#endif
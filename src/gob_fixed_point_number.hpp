@@ -471,7 +471,7 @@ GOBLIB_INLINE constexpr const T& fmin(const T& left, const T& right)
 }
 
 template<typename T, typename std::enable_if<goblib::is_fixed_point_number<T>::value, std::nullptr_t>::type = nullptr>
-GOBLIB_INLINE constexpr const T& fmax(const T left, const T right)
+GOBLIB_INLINE constexpr const T& fmax(const T& left, const T& right)
 {
     return std::max(left, right);
 }
@@ -14,6 +14,7 @@
 #include <type_traits>
 #include <algorithm>
 #include <memory>
+#include <utility>
 
 #include "gob_macro.hpp"
 #include "gob_utility.hpp"
@@ -30,6 +31,7 @@ namespace goblib
   Class has method of compatibiliy for std::vector.
   @attention No throw exceptions
   @sa https://en.cppreference.com/w/cpp/container/vector
+  @sa InlineVector (Elements in object, no heap allocation)
 */
 template<typename T, std::size_t Max = 16>
 class FixedVector
@@ -0,0 +1,114 @@
+/*!
+  Goblin Library
+
+  @file  gob_flat_task.hpp
+  @brief Task system with flat execution order.
+  @warning This is NOT THREAD.
+*/
+#pragma once
+#ifndef GOBLIB_FLAT_TASK_HPP
+#define GOBLIB_FLAT_TASK_HPP
+
+#include "gob_macro.hpp"
+#include "gob_task.hpp"
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+namespace goblib
+{
+
+/*!
+  @brief Parent-child task system that pumps tasks by linear sweep.
+  @details Same semantics as TaskTree, but the execution order (preorder) is stored as contiguous arrays.<br>
+  The arrays are rebuilt in pump() only when the tree has changed (insert / remove).
+  @warning Change the tree during pump() by reserveInsertNode() and Task::kill().<br>
+  Nodes inserted directly during pump are pumped from the next frame, and removed nodes must be alive until end of frame.
+  @note Derived class that overrides onInsertNode / onRemoveNode must call those of FlatTaskTree.
+*/
+template<class  T>
+class FlatTaskTree : public TaskTree<T>
+{
+  public:
+    using IndexType = std::uint32_t;
+    constexpr static IndexType NO_PARENT = std::numeric_limits<IndexType>::max(); //!< Parent index of root.
+
+    /*!
+      @param qreserve Message queue max size for post message.
+    */
+    explicit FlatTaskTree(std::size_t qreserve = TaskTree<T>::QUEUE_RESERVE_SIZE)
+            : TaskTree<T>(qreserve), _task(), _parent(), _priority(), _depthStack(), _dirty(true)
+    {}
+
+    void pump(const float delta = 1.0f)
+    {
+        if(this->isPauseGlobal()) { return; }
+
+        GOBLIB_TRACE_SCOPE("FlatTaskTree::pump");
+        this->deliverMessage();
+        if(_dirty) { rebuild(); }
+        for(auto& t : _task) { t->pump(delta); }
+        this->insertReservedNodes();
+
+        // Unlink only if anyone was killed or inserted.
+        if(_dirty || std::any_of(_task.begin(), _task.end(), [](const T* t) { return t->isKill(); }))
+        {
+            this->remove_if([](const T* t) { return t->isKill(); });
+        }
+    }
+
+    /// @name Flat order
+    /// @{
+    /*! @brief Number of tasks in flat order (include root) */
+    GOBLIB_INLINE std::size_t flatSize() const { return _task.size(); }
+    /*! @brief Task at preorder index */
+    GOBLIB_INLINE T* flatTask(const std::size_t idx) const { return _task[idx]; }
+    /*! @brief Parent index of preorder index. NO_PARENT if root */
+    GOBLIB_INLINE IndexType parentIndex(const std::size_t idx) const { return _parent[idx]; }
+    /*! @brief Priority at preorder index */
+    GOBLIB_INLINE Task::PriorityType priorityAt(const std::size_t idx) const { return _priority[idx]; }
+    /*! @brief Is flat order outdated? */
+    GOBLIB_INLINE bool isDirty() const { return _dirty; }
+    /*! @brief Rebuild flat order from tree */
+    void rebuild();
+    /// @}
+
+  protected:
+    virtual void onInsertNode(T* node) override { _dirty = true; TaskTree<T>::onInsertNode(node); }
+    virtual void onRemoveNode(T* node) override { _dirty = true; TaskTree<T>::onRemoveNode(node); }
+    virtual void onRestoreTree() override { _dirty = true; TaskTree<T>::onRestoreTree(); }
+
+  private:
+    std::vector<T*> _task;                      // Tasks in preorder.
+    std::vector<IndexType> _parent;             // Parent index of each task.
+    std::vector<Task::PriorityType> _priority;  // Priority of each task.
+    std::vector<IndexType> _depthStack;         // Index of last task at each depth (for rebuild).
+    bool _dirty;
+};
+
+template<class T> constexpr typename FlatTaskTree<T>::IndexType FlatTaskTree<T>::NO_PARENT;
+
+template<class T> void FlatTaskTree<T>::rebuild()
+{
+    _task.clear();
+    _parent.clear();
+    _priority.clear();
+    _depthStack.clear();
+
+    this->visit_with_depth([this](T* t, const std::uint32_t depth)
+    {
+        IndexType idx = static_cast<IndexType>(_task.size());
+        _depthStack.resize(depth + 1);
+        _depthStack[depth] = idx;
+
+        _task.push_back(t);
+        _parent.push_back(depth ? _depthStack[depth - 1] : NO_PARENT);
+        _priority.push_back(t->priority());
+    }, this->root(), 0);
+
+    _dirty = false;
+}
+
+//
+}
+#endif
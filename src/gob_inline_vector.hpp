@@ -0,0 +1,372 @@
+/*!
+  Goblin Library
+
+  @file   gob_inline_vector.hpp
+  @brief  Fixed capacity vector with in-object storage, compatible with std::vector
+*/
+#pragma once
+#ifndef GOBLIB_INLINE_VECTOR_HPP
+#define GOBLIB_INLINE_VECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <initializer_list>
+#include <type_traits>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <new>
+#include <cassert>
+
+#include "gob_macro.hpp"
+
+#ifdef min
+#undef min
+#endif
+
+namespace goblib
+{
+
+/*! @brief Fixed capacity vector with in-object storage.
+  Same interface as FixedVector, but elements are stored in an aligned buffer in the object,
+  so construction does not allocate and data() is on the owner's memory.<br>
+  Trivially copyable T is copied and shifted by memcpy/memmove.
+  @attention No throw exceptions
+  @attention If the number of elements exceeds Max by insertion, it will not be inserted.
+  @sa https://en.cppreference.com/w/cpp/container/vector
+*/
+template<typename T, std::size_t Max = 16>
+class InlineVector
+{
+    static_assert(Max > 0, "Max must be greater than zero");
+    using trivial = std::integral_constant<bool, std::is_trivially_copyable<T>::value>;
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /// @name Constructor
+    /// @{
+    InlineVector() : _size(0) {}
+    explicit InlineVector(size_type n) : _size(0) { resize(n); }
+    InlineVector(size_type n, const T& value) : _size(0) { resize(n, value); }
+    template <class InputIter, typename std::enable_if<!std::is_integral<InputIter>::value, std::nullptr_t>::type = nullptr>
+    InlineVector(InputIter first, InputIter last) : _size(0) { assign(first, last); }
+    InlineVector(std::initializer_list<T> il) : InlineVector(il.begin(), il.end()) {}
+    InlineVector(const InlineVector& x) : _size(0) { _copy(x.begin(), x.size(), trivial()); }
+    InlineVector(InlineVector&& x) noexcept(std::is_nothrow_move_constructible<T>::value) : _size(0)
+    {
+        _move(x.begin(), x.size(), trivial());
+        x.clear();
+    }
+    /// @}
+
+    ~InlineVector() { clear(); }
+
+    /// @name Operator=
+    /// @{
+    InlineVector& operator=(const InlineVector& x)
+    {
+        if(this != &x)
+        {
+            clear();
+            _copy(x.begin(), x.size(), trivial());
+        }
+        return *this;
+    }
+    InlineVector& operator=(InlineVector&& x) noexcept(std::is_nothrow_move_constructible<T>::value)
+    {
+        if(this != &x)
+        {
+            clear();
+            _move(x.begin(), x.size(), trivial());
+            x.clear();
+        }
+        return *this;
+    }
+    InlineVector& operator=(std::initializer_list<T> il)
+    {
+        assign(il.begin(), il.end());
+        return *this;
+    }
+    /// @}
+
+    /// @name Assign
+    /// @{
+    template <class InputIterator, typename std::enable_if<!std::is_integral<InputIterator>::value, std::nullptr_t>::type = nullptr>
+    void assign(InputIterator first, InputIterator last)
+    {
+        clear();
+        while(first != last && _size < Max) { new (_ptr(_size++)) T(*first++); }
+        assert(first == last && "Illegal size");
+    }
+    void assign(size_type n, const T& u)
+    {
+        assert(n <= Max && "Illegal size");
+        clear();
+        resize(n, u);
+    }
+    GOBLIB_INLINE void assign(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+    /// @}
+
+    /// @name Element access
+    /// @{
+    GOBLIB_INLINE reference at(size_type n) &           { assert(n < _size); return data()[n]; }
+    GOBLIB_INLINE const_reference at(size_type n) const&{ assert(n < _size); return data()[n]; }
+
+    GOBLIB_INLINE reference operator[](size_type n) &   { return data()[n]; }
+    GOBLIB_INLINE const_reference operator[](size_type n) const& { return data()[n]; }
+    GOBLIB_INLINE T operator[](size_type n) const &&    { return std::move(data()[n]); }
+
+    GOBLIB_INLINE reference front()                     { return *data(); }
+    GOBLIB_INLINE const_reference front() const         { return *data(); }
+    GOBLIB_INLINE reference back()                      { return data()[_size - 1]; }
+    GOBLIB_INLINE const_reference back() const          { return data()[_size - 1]; }
+
+    GOBLIB_INLINE T* data() noexcept                    { return reinterpret_cast<T*>(_buf); }
+    GOBLIB_INLINE const T* data() const noexcept        { return reinterpret_cast<const T*>(_buf); }
+    /// @}
+
+    /// @name Iterators
+    /// @{
+    GOBLIB_INLINE iterator begin() noexcept { return data(); }
+    GOBLIB_INLINE iterator end() noexcept { return data() + _size; }
+    GOBLIB_INLINE const_iterator begin() const noexcept { return data(); }
+    GOBLIB_INLINE const_iterator end() const noexcept { return data() + _size; }
+    GOBLIB_INLINE const_iterator cbegin() const noexcept { return begin(); }
+    GOBLIB_INLINE const_iterator cend() const noexcept { return end(); }
+
+    GOBLIB_INLINE reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    GOBLIB_INLINE reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    GOBLIB_INLINE const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    GOBLIB_INLINE const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    GOBLIB_INLINE const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+    GOBLIB_INLINE const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+    /// @}
+
+    /// @name Capacity
+    /// @{
+    GOBLIB_INLINE std::size_t size() const noexcept { return _size; }
+    GOBLIB_INLINE std::size_t max_size() const noexcept { return Max; }
+    GOBLIB_INLINE std::size_t capacity() const noexcept { return Max; }
+    GOBLIB_NODISCARD GOBLIB_INLINE bool empty() const noexcept { return _size == 0; }
+    /// @}
+
+    /// @name NOP
+    /// @{
+    GOBLIB_INLINE void reserve() { }
+    GOBLIB_INLINE void shrink_to_fit(){ }
+    /// @}
+
+    /// @name  Modifiers
+    /// @{
+    void clear()
+    {
+        _destroy(begin(), end(), std::is_trivially_destructible<T>());
+        _size = 0;
+    }
+
+    GOBLIB_INLINE iterator insert(const_iterator position, const T& x) { return insert(position, 1, x); }
+    iterator insert(const_iterator position, T&& x)
+    {
+        assert(_size + 1 <= Max && "size full");
+        if(_size + 1 > Max) { return end(); } // Leave argument untouched if not inserted
+        T tmp(std::move(x)); // x may be an element of this
+        iterator it = _open(position, 1);
+        if(!it) { return end(); }
+        new (it) T(std::move(tmp));
+        ++_size;
+        return it;
+    }
+    iterator insert(const_iterator position, size_type n, const T& x)
+    {
+        if(n == 0) { return const_cast<iterator>(position); }
+        const T tmp(x); // x may be an element of this
+        iterator it = _open(position, n);
+        if(!it) { return end(); }
+        std::uninitialized_fill_n(it, n, tmp);
+        _size += n;
+        return it;
+    }
+    template <class InputIterator, typename std::enable_if<!std::is_integral<InputIterator>::value, std::nullptr_t>::type = nullptr>
+    iterator insert(const_iterator position, InputIterator first, InputIterator last)
+    {
+        size_type n = static_cast<size_type>(std::distance(first, last));
+        iterator it = _open(position, n);
+        if(!it) { return end(); }
+        std::uninitialized_copy(first, last, it);
+        _size += n;
+        return it;
+    }
+    GOBLIB_INLINE iterator insert(const_iterator position, std::initializer_list<T> il)
+    {
+        return insert(position, il.begin(), il.end());
+    }
+
+    template <class... Args> iterator emplace(const_iterator position, Args&&... args)
+    {
+        assert(_size + 1 <= Max && "size full");
+        if(_size + 1 > Max) { return end(); } // Leave argument untouched if not inserted
+        T tmp(std::forward<Args>(args)...); // args may refer to elements of this
+        iterator it = _open(position, 1);
+        if(!it) { return end(); }
+        new (it) T(std::move(tmp));
+        ++_size;
+        return it;
+    }
+
+    GOBLIB_INLINE iterator erase(const_iterator position) { return erase(position, position + 1); }
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        assert(first >= begin() && first <= last && last <= end() && "Out of range");
+        iterator ft = const_cast<iterator>(first);
+        iterator lt = const_cast<iterator>(last);
+        if(ft == lt) { return ft; }
+        _destroy(ft, lt, std::is_trivially_destructible<T>());
+        _relocate(ft, lt, static_cast<size_type>(end() - lt), trivial());
+        _size -= static_cast<size_type>(lt - ft);
+        return ft;
+    }
+
+    void push_back(const T& x)
+    {
+        assert(_size < Max && "size full");
+        if(_size < Max) { new (_ptr(_size++)) T(x); }
+    }
+    void push_back(T&& x)
+    {
+        assert(_size < Max && "size full");
+        if(_size < Max) { new (_ptr(_size++)) T(std::move(x)); }
+    }
+
+#if defined(GOBLIB_CPP17_OR_LATER)
+    template <class... Args> reference emplace_back(Args&&... args)
+#else
+    template <class... Args> void emplace_back(Args&&... args)
+#endif
+    {
+        assert(_size < Max && "size full");
+        if(_size < Max) { new (_ptr(_size++)) T(std::forward<Args>(args)...); }
+#if defined(GOBLIB_CPP17_OR_LATER)
+        return back();
+#endif
+    }
+
+    void pop_back() { if(!empty()) { data()[--_size].~T(); } }
+
+    void resize(size_type sz)
+    {
+        assert(sz <= Max && "Illegal size");
+        sz = std::min(Max, sz);
+        if(sz < _size) { erase(begin() + sz, end()); }
+        while(_size < sz) { new (_ptr(_size++)) T(); }
+    }
+    void resize(size_type sz, const T& c)
+    {
+        assert(sz <= Max && "Illegal size");
+        sz = std::min(Max, sz);
+        if(sz < _size) { erase(begin() + sz, end()); }
+        else { insert(end(), sz - _size, c); }
+    }
+
+    void swap(InlineVector& x)
+    {
+        InlineVector tmp(std::move(x));
+        x = std::move(*this);
+        *this = std::move(tmp);
+    }
+    /// @}
+
+  private:
+    GOBLIB_INLINE T* _ptr(size_type i) { return data() + i; }
+
+    // Copy/move n elements to empty this.
+    void _copy(const T* src, size_type n, std::true_type) { if(n) { std::memcpy(_buf, src, n * sizeof(T)); } _size = n; }
+    void _copy(const T* src, size_type n, std::false_type) { std::uninitialized_copy(src, src + n, data()); _size = n; }
+    void _move(T* src, size_type n, std::true_type) { _copy(src, n, std::true_type()); }
+    void _move(T* src, size_type n, std::false_type)
+    {
+        for(size_type i = 0; i < n; ++i) { new (_ptr(i)) T(std::move(src[i])); }
+        _size = n;
+    }
+
+    void _destroy(T*, T*, std::true_type) {}
+    void _destroy(T* first, T* last, std::false_type) { while(first != last) { (first++)->~T(); } }
+
+    // Move n live elements from src to raw dst, src becomes raw.
+    void _relocate(T* dst, T* src, size_type n, std::true_type) { if(n) { std::memmove(dst, src, n * sizeof(T)); } }
+    void _relocate(T* dst, T* src, size_type n, std::false_type)
+    {
+        if(dst < src)
+        {
+            for(size_type i = 0; i < n; ++i) { new (dst + i) T(std::move(src[i])); src[i].~T(); }
+        }
+        else
+        {
+            for(size_type i = n; i > 0; --i) { new (dst + i - 1) T(std::move(src[i - 1])); src[i - 1].~T(); }
+        }
+    }
+
+    // Open raw gap of n elements at position. Return nullptr if no space.
+    iterator _open(const_iterator position, size_type n)
+    {
+        assert(position >= begin() && position <= end() && "Out of range");
+        assert(_size + n <= Max && "size full");
+        if(_size + n > Max) { return nullptr; }
+        iterator it = const_cast<iterator>(position);
+        _relocate(it + n, it, static_cast<size_type>(end() - it), trivial());
+        return it;
+    }
+
+  private:
+    alignas(T) std::uint8_t _buf[sizeof(T) * Max];
+    size_type _size;
+};
+
+/// @name Compare
+/// @{
+template <class T, std::size_t Max>
+bool operator==(const InlineVector<T,Max>& x, const InlineVector<T,Max>& y)
+{
+    return &x == &y || (x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin()));
+}
+template <class T, std::size_t Max>
+bool operator!=(const InlineVector<T,Max>& x, const InlineVector<T,Max>& y) { return !(x == y); }
+template <class T, std::size_t Max>
+bool operator<(const InlineVector<T,Max>& x, const InlineVector<T,Max>& y)
+{
+    return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+template <class T, std::size_t Max>
+bool operator<=(const InlineVector<T,Max>& x, const InlineVector<T,Max>& y) { return !(y < x); }
+template <class T, std::size_t Max>
+bool operator>(const InlineVector<T,Max>& x, const InlineVector<T,Max>& y) { return y < x; }
+template <class T, std::size_t Max>
+bool operator>=(const InlineVector<T,Max>& x, const InlineVector<T,Max>& y) { return !(x < y); }
+/// @}
+//
+}
+
+namespace std
+{
+/// @name Specialization for std::swap
+/// @{
+template <class T, std::size_t Max> GOBLIB_INLINE
+void swap(goblib::InlineVector<T,Max>& x, goblib::InlineVector<T,Max>& y)
+{
+    x.swap(y);
+}
+/// @}
+//
+}
+
+#endif
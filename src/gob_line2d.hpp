@@ -58,7 +58,7 @@ template<typename T> class LineSegment
     }
     GOBLIB_INLINE LineSegment<T>& operator=(LineSegment<T>&& o)
     {
-        if(this != o)
+        if(this != &o)
         {
             _start = o._start; _end = o._end;
             o.zero();
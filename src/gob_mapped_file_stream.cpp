@@ -0,0 +1,186 @@
+/*!
+  Goblin Library
+
+  @file   gob_mapped_file_stream.cpp
+  @brief  Memory-mapped file stream.
+*/
+#include "gob_mapped_file_stream.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(GOBLIB_MAPPED_FILE_POSIX)
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#elif defined(GOBLIB_MAPPED_FILE_WIN32)
+# ifndef WIN32_LEAN_AND_MEAN
+#   define WIN32_LEAN_AND_MEAN
+# endif
+# ifndef NOMINMAX
+#   define NOMINMAX
+# endif
+# include <windows.h>
+#elif defined(GOBLIB_MAPPED_FILE_ESP32)
+# include <esp_partition.h>
+# include <esp_idf_version.h>
+# if ESP_IDF_VERSION_MAJOR < 5
+#   include <esp_spi_flash.h>
+# endif
+#endif
+
+namespace goblib
+{
+
+namespace
+{
+// Head of empty file. (Mapping of zero length is not allowed)
+const std::uint8_t empty_head[1] = {};
+//
+}
+
+MappedFileStream::MappedFileStream()
+        : Stream(), _head(nullptr), _size(0), _pos(0), _opened(false)
+#if defined(GOBLIB_MAPPED_FILE_WIN32)
+        , _file(nullptr), _mapping(nullptr)
+#elif defined(GOBLIB_MAPPED_FILE_ESP32)
+        , _handle(0)
+#endif
+{}
+
+MappedFileStream::MappedFileStream(const char* path) : MappedFileStream()
+{
+    open(path);
+}
+
+MappedFileStream::~MappedFileStream()
+{
+    close();
+}
+
+bool MappedFileStream::open(const char* path)
+{
+    close();
+    if(!path) { return false; }
+
+#if defined(GOBLIB_MAPPED_FILE_POSIX)
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0) { return false; }
+    struct stat st;
+    if(::fstat(fd, &st) != 0) { ::close(fd); return false; }
+    _size = static_cast<pos_type>(st.st_size);
+    if(_size)
+    {
+        void* p = ::mmap(nullptr, static_cast<std::size_t>(_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED) { ::close(fd); _size = 0; return false; }
+        ::madvise(p, static_cast<std::size_t>(_size), MADV_SEQUENTIAL);
+        _head = static_cast<const std::uint8_t*>(p);
+    }
+    ::close(fd); // Mapping is alive after close.
+
+#elif defined(GOBLIB_MAPPED_FILE_WIN32)
+    HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE) { return false; }
+    LARGE_INTEGER sz;
+    if(!::GetFileSizeEx(file, &sz)) { ::CloseHandle(file); return false; }
+    _size = static_cast<pos_type>(sz.QuadPart);
+    if(_size)
+    {
+        HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* p = mapping ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if(!p)
+        {
+            if(mapping) { ::CloseHandle(mapping); }
+            ::CloseHandle(file);
+            _size = 0;
+            return false;
+        }
+        _mapping = mapping;
+        _head = static_cast<const std::uint8_t*>(p);
+    }
+    _file = file;
+
+#elif defined(GOBLIB_MAPPED_FILE_ESP32)
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, path);
+    if(!part) { return false; }
+    const void* p = nullptr;
+# if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_mmap_handle_t handle;
+    if(esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &p, &handle) != ESP_OK) { return false; }
+# else
+    spi_flash_mmap_handle_t handle;
+    if(esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &p, &handle) != ESP_OK) { return false; }
+# endif
+    _handle = static_cast<std::uint32_t>(handle);
+    _size = part->size;
+    _head = static_cast<const std::uint8_t*>(p);
+
+#else
+    return false;
+#endif
+
+    if(!_head) { _head = empty_head; }
+    _pos = 0;
+    _opened = true;
+    return true;
+}
+
+void MappedFileStream::close()
+{
+    if(!_opened) { return; }
+
+#if defined(GOBLIB_MAPPED_FILE_POSIX)
+    if(_size) { ::munmap(const_cast<std::uint8_t*>(_head), static_cast<std::size_t>(_size)); }
+#elif defined(GOBLIB_MAPPED_FILE_WIN32)
+    if(_size) { ::UnmapViewOfFile(_head); }
+    if(_mapping) { ::CloseHandle(static_cast<HANDLE>(_mapping)); }
+    if(_file) { ::CloseHandle(static_cast<HANDLE>(_file)); }
+    _file = _mapping = nullptr;
+#elif defined(GOBLIB_MAPPED_FILE_ESP32)
+# if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_munmap(static_cast<esp_partition_mmap_handle_t>(_handle));
+# else
+    spi_flash_munmap(static_cast<spi_flash_mmap_handle_t>(_handle));
+# endif
+    _handle = 0;
+#endif
+
+    _head = nullptr;
+    _size = _pos = 0;
+    _opened = false;
+}
+
+Stream::pos_type MappedFileStream::read(std::uint8_t* buf, std::size_t len)
+{
+    if(is_tail() || len == 0) { return 0; }
+    auto clen = std::min(_size - _pos, static_cast<pos_type>(len));
+    std::memcpy(buf, _head + _pos, static_cast<std::size_t>(clen));
+    _pos += clen;
+    return clen;
+}
+
+StreamView MappedFileStream::view(std::size_t len)
+{
+    if(is_tail()) { return StreamView{ nullptr, 0 }; }
+    StreamView v{ _head + _pos, static_cast<std::size_t>(std::min(_size - _pos, static_cast<pos_type>(len))) };
+    _pos += v.size;
+    return v;
+}
+
+bool MappedFileStream::seek(off_type off, seekdir s)
+{
+    off_type base = 0;
+    switch(s)
+    {
+    case seekdir::beg: base = 0; break;
+    case seekdir::cur: base = static_cast<off_type>(_pos); break;
+    case seekdir::end: base = static_cast<off_type>(_size); break;
+    }
+    off_type np = base + off;
+    if(!_opened || np < 0 || np > static_cast<off_type>(_size)) { return false; }
+    _pos = static_cast<pos_type>(np);
+    return true;
+}
+
+//
+}
@@ -0,0 +1,97 @@
+/*!
+  Goblin Library
+
+  @file   gob_mapped_file_stream.hpp
+  @brief  Memory-mapped file stream.
+*/
+#pragma once
+#ifndef GOBLIB_MAPPED_FILE_STREAM_HPP
+#define GOBLIB_MAPPED_FILE_STREAM_HPP
+
+#include "gob_stream.hpp"
+#include <cstdint>
+#include <cstddef>
+
+/// @cond
+#if defined(ESP_PLATFORM)
+# define GOBLIB_MAPPED_FILE_ESP32
+#elif defined(_WIN32)
+# define GOBLIB_MAPPED_FILE_WIN32
+#elif defined(__unix__) || defined(__APPLE__)
+# define GOBLIB_MAPPED_FILE_POSIX
+#endif
+/// @endcond
+
+namespace goblib
+{
+
+/*!
+  @brief Read-only stream that maps the whole file into memory.
+  @details Uses mmap (POSIX), MapViewOfFile (Windows) or esp_partition_mmap (ESP32).<br>
+  On ESP32, path is the label of a data partition. (e.g. "assets")<br>
+  view() returns pointer into the mapping, so data can be consumed in place without copying.
+  @note open() fails on other targets.
+*/
+class MappedFileStream : public Stream
+{
+  public:
+    using pos_type = typename Stream::pos_type;
+    using off_type = typename Stream::off_type;
+
+    /// @name Constructor
+    /// @{
+    MappedFileStream();
+    /*! @brief Open file */
+    explicit MappedFileStream(const char* path);
+    /// @}
+
+    virtual ~MappedFileStream();
+
+    /// @name Open, Close
+    /// @{
+    virtual bool is_open() const override { return _opened; }
+    /*! @brief Map file (Mapping already opened is closed) */
+    virtual bool open(const char* path) override;
+    /*! @brief Unmap file */
+    virtual void close() override;
+    /// @}
+
+    /// @name Property
+    /// @{
+    virtual pos_type size() const override { return _size; }
+    /*! @brief Head of mapping */
+    const std::uint8_t* data() const { return _head; }
+    /// @}
+
+    /// @name Read
+    /// @{
+    template<typename U> pos_type read(U buf, std::size_t len)
+    {
+        return read(reinterpret_cast<std::uint8_t*>(buf), len);
+    }
+    virtual pos_type read(std::uint8_t* buf, std::size_t len) override;
+    virtual StreamView view(std::size_t len) override;
+    /// @}
+
+    /// @name Seek
+    /// @{
+    virtual bool seek(off_type off, seekdir s) override;
+    virtual pos_type position() const override { return _pos; }
+    virtual bool is_tail() const override { return _pos >= _size; }
+    /// @}
+
+  private:
+    const std::uint8_t* _head;
+    pos_type _size, _pos;
+    bool _opened;
+#if defined(GOBLIB_MAPPED_FILE_WIN32)
+    void* _file;    // HANDLE
+    void* _mapping; // HANDLE
+#elif defined(GOBLIB_MAPPED_FILE_ESP32)
+    std::uint32_t _handle; // esp_partition_mmap_handle_t
+#endif
+};
+
+//
+}
+#endif
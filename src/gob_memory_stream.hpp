@@ -86,6 +86,13 @@ class MemoryStream : public Stream
         _cur += clen;
         return clen;
     }
+    virtual StreamView view(std::size_t len) override
+    {
+        if(is_tail()) { return StreamView{ nullptr, 0 }; }
+        StreamView v{ _cur, static_cast<std::size_t>(std::min(static_cast<pos_type>(_tail - _cur), static_cast<pos_type>(len))) };
+        _cur += v.size;
+        return v;
+    }
     /// @}
 
     /// @name Seek
@@ -0,0 +1,131 @@
+/*!
+  Goblin Library
+
+  @file  gob_mpsc_queue.hpp
+  @brief Bounded lock-free multi-producer/single-consumer queue.
+*/
+#pragma once
+#ifndef GOBLIB_MPSC_QUEUE_HPP
+#define GOBLIB_MPSC_QUEUE_HPP
+
+#include "gob_macro.hpp"
+#include "gob_math.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <cassert>
+
+namespace goblib
+{
+
+/*!
+  @brief Bounded lock-free multi-producer/single-consumer queue.
+  @tparam T Type of element (Default constructible and copy assignable)
+  @details Each cell has a sequence number, producers reserve a cell by CAS of tail.<br>
+  push() never allocates, and fails if full. Capacity is rounded up to power of 2.
+  @note push() can be called from ISR if std::atomic<std::size_t> is lock-free on the target.
+  @warning pop() and clear() must be called from only one thread (consumer).
+*/
+template<typename T> class MpscQueue
+{
+    static_assert(std::is_default_constructible<T>::value, "T must be default constructible");
+    static_assert(std::is_copy_assignable<T>::value, "T must be copy assignable");
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    /*! @param capacity Max elements (rounded up to power of 2) */
+    explicit MpscQueue(const size_type capacity)
+            : _mask(goblib::math::roundUpPow2(capacity > 1 ? capacity : 2) - 1)
+            , _cell(new Cell[_mask + 1])
+            , _head(0), _tail(0)
+    {
+        for(size_type i = 0; i <= _mask; ++i) { _cell[i].seq.store(i, std::memory_order_relaxed); }
+    }
+
+    /// @name Capacity
+    /// @{
+    GOBLIB_INLINE size_type capacity() const { return _mask + 1; }
+    /*! @brief Number of elements. (Approximate value while pushing by other threads) */
+    GOBLIB_INLINE size_type size() const
+    {
+        size_type h = _head.load(std::memory_order_acquire);
+        size_type t = _tail.load(std::memory_order_acquire);
+        return t >= h ? t - h : 0;
+    }
+    GOBLIB_INLINE bool empty() const { return size() == 0; }
+    GOBLIB_INLINE bool full() const { return size() >= capacity(); }
+    /// @}
+
+    /*!
+      @brief Push element (Producer)
+      @retval true Success
+      @retval false Full
+    */
+    bool push(const T& v)
+    {
+        size_type pos = _tail.load(std::memory_order_relaxed);
+        Cell* c;
+        for(;;)
+        {
+            c = &_cell[pos & _mask];
+            size_type seq = c->seq.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if(diff == 0)
+            {
+                if(_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+            }
+            else if(diff < 0) { return false; } // full
+            else { pos = _tail.load(std::memory_order_relaxed); }
+        }
+        c->value = v;
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+      @brief Pop element (Consumer)
+      @retval true Success
+      @retval false Empty (or the front element is being pushed)
+    */
+    bool pop(T& out)
+    {
+        size_type pos = _head.load(std::memory_order_relaxed);
+        Cell& c = _cell[pos & _mask];
+        if(c.seq.load(std::memory_order_acquire) != pos + 1) { return false; }
+        out = c.value;
+        c.seq.store(pos + _mask + 1, std::memory_order_release);
+        _head.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*! @brief Remove all elements (Consumer) */
+    void clear() { T tmp; while(pop(tmp)) {} }
+
+  private:
+    struct Cell
+    {
+        std::atomic<size_type> seq;
+        T value;
+        Cell() : seq(0), value() {}
+    };
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue(MpscQueue&&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    MpscQueue& operator=(MpscQueue&&) = delete;
+
+  private:
+    const size_type _mask;
+    std::unique_ptr<Cell[]> _cell;
+    std::atomic<size_type> _head; // Only consumer writes.
+    char _padding[64 - sizeof(std::atomic<size_type>)]; // Avoid false sharing of head and tail.
+    std::atomic<size_type> _tail;
+};
+
+//
+}
+#endif
@@ -8,11 +8,13 @@
 #ifndef GOBLIB_NOTIFICATION_HPP
 #define GOBLIB_NOTIFICATION_HPP
 
+#include "gob_macro.hpp"
 #include <vector>
-#include <cassert>
-#ifndef NDEBUG
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include <algorithm>
-#endif
+#include <cassert>
 
 namespace goblib
 {
@@ -31,32 +33,130 @@ template<class T> class Observer
 };
 
 
+class NotificationQueue;
+
+/// @cond
+namespace detail
+{
+// Intrusive node of NotificationQueue.
+class QueuedSubject
+{
+  protected:
+    QueuedSubject() : _queued(false), _arg(nullptr), _next(nullptr) {}
+    virtual ~QueuedSubject() { assert(!_queued && "Destructed while queued"); }
+    virtual void deliverQueued(void* arg) = 0;
+
+    std::atomic<bool> _queued;
+    std::atomic<void*> _arg;
+    QueuedSubject* _next;
+
+    friend class goblib::NotificationQueue;
+};
+//
+}
+/// @endcond
+
+/*!
+  @brief Queue of coalesced notifications.
+  @details Subject::post() queues the subject once until flush(), and flush() notifies each queued subject once
+  with the latest arg, in order of the first post.<br>
+  post() is lock-free and can be called from any thread. flush() must be called from one thread at a time.
+*/
+class NotificationQueue
+{
+  public:
+    NotificationQueue() : _head(nullptr) {}
+    ~NotificationQueue() { flush(); }
+
+    GOBLIB_INLINE bool empty() const { return _head.load(std::memory_order_acquire) == nullptr; }
+
+    /*! @brief Deliver queued notifications. Posted while flushing are delivered on next flush. */
+    void flush()
+    {
+        detail::QueuedSubject* p = _head.exchange(nullptr, std::memory_order_acq_rel);
+        // Reverse to order of post.
+        detail::QueuedSubject* r = nullptr;
+        while(p)
+        {
+            auto n = p->_next;
+            p->_next = r;
+            r = p;
+            p = n;
+        }
+        while(r)
+        {
+            auto n = r->_next;
+            r->_queued.store(false, std::memory_order_release);
+            r->deliverQueued(r->_arg.load(std::memory_order_acquire));
+            r = n;
+        }
+    }
+
+  private:
+    NotificationQueue(const NotificationQueue&) = delete;
+    NotificationQueue& operator=(const NotificationQueue&) = delete;
+
+    void push(detail::QueuedSubject* s)
+    {
+        s->_next = _head.load(std::memory_order_relaxed);
+        while(!_head.compare_exchange_weak(s->_next, s, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    std::atomic<detail::QueuedSubject*> _head;
+
+    template<class> friend class Subject;
+};
+
 /*! @brief Subject(sender)
   The class you want to notify will be derived from this class.
+  @details Observer list is copy-on-write. notify() takes a snapshot without allocation,
+  so insert/remove from observers callback and from other threads are safe.
+  Changes are applied from the next notify().
   @tparam T Type of sender.
 */
-template<class T> class Subject
+template<class T> class Subject : public detail::QueuedSubject
 {
   public:
-    Subject() : _observers() {}
+    using List = std::vector<Observer<T>*>;
+
+    Subject() : _mutex(), _observers(std::make_shared<const List>()) {}
+    Subject(const Subject& o) : detail::QueuedSubject(), _mutex(), _observers(o.snapshot()) {}
+    Subject& operator=(const Subject& o)
+    {
+        if(this != &o)
+        {
+            auto snap = o.snapshot();
+            std::lock_guard<std::mutex> lock(_mutex);
+            _observers = std::move(snap);
+        }
+        return *this;
+    }
+    /*! @warning Must not be destructed while queued in NotificationQueue. */
     virtual ~Subject(){}
 
     /// @name Observer
     /// @{
     void insertObserver(Observer<T>& o)
     {
-#ifndef NDEBUG
-        assert(!std::any_of(_observers.begin(), _observers.end(), [&o](Observer<T>* e){ return &o == e; })
+        std::lock_guard<std::mutex> lock(_mutex);
+        assert(!std::any_of(_observers->begin(), _observers->end(), [&o](Observer<T>* e){ return &o == e; })
                && "Already inserted");
-#endif
-        _observers.push_back(&o);
+        auto v = std::make_shared<List>(*_observers);
+        v->push_back(&o);
+        _observers = std::move(v);
     }
     void removeObserver(Observer<T>& o)
     {
-        auto it = std::remove(_observers.begin(), _observers.end(), &o);
-        _observers.erase(it, _observers.end());
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto v = std::make_shared<List>(*_observers);
+        v->erase(std::remove(v->begin(), v->end(), &o), v->end());
+        _observers = std::move(v);
+    }
+    void clearObservers()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _observers = std::make_shared<const List>();
     }
-    void clearObservers() { _observers.clear(); }
     /// @}
     
     /*! 
@@ -65,14 +165,36 @@ template<class T> class Subject
     */
     void notify(void* arg = nullptr)
     {
-        for(auto& e : _observers)
+        auto snap = snapshot();
+        for(auto& e : *snap)
         {
             e->onNotify(static_cast<T*>(this), arg);
         }
     }
 
+    /*!
+      @brief Queue notification to be delivered on NotificationQueue::flush()
+      @details Posts until flush are coalesced to one notification with the latest arg.
+      @note Thread-safe and lock-free.
+    */
+    void post(NotificationQueue& q, void* arg = nullptr)
+    {
+        _arg.store(arg, std::memory_order_release);
+        if(!_queued.exchange(true, std::memory_order_acq_rel)) { q.push(this); }
+    }
+    /*! @brief Is queued in NotificationQueue? */
+    GOBLIB_INLINE bool isQueued() const { return _queued.load(std::memory_order_acquire); }
+
   private:
-    std::vector<Observer<T>*> _observers;
+    std::shared_ptr<const List> snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _observers;
+    }
+    virtual void deliverQueued(void* arg) override { notify(arg); }
+
+    mutable std::mutex _mutex; // Guards _observers pointer. (Not held while notifying)
+    std::shared_ptr<const List> _observers;
 };
 
 //
@@ -10,43 +10,46 @@
 
 #include "gob_macro.hpp"
 #include <cstddef>
-#include <array>
-#include <stack>
-#include <initializer_list>
+#include <cstdint>
+#include <new>
+#include <memory>
+#include <atomic>
+#include <utility>
 #include <type_traits>
 #include <cassert>
 
 namespace goblib
 {
 
-/*! 
+/*!
   @brief Object pool
   @tparam T Type of object
-  @tparam Max Max elements
+  @note Free list is intrusive (next pointer is stored in free slot), so the pool does not allocate after construction.
 */
 template<class T> class ObjectPool
 {
   public:
     /// @name Constructor
     /// @{
-    ObjectPool(std::size_t size) : _pool(nullptr), _size(size), _stack()
+    ObjectPool(std::size_t size)
+            : _pool(nullptr), _size(size), _free(nullptr), _available(0), _highWater(0), _failed(0)
     {
         assert(size > 0);
-        _pool = reinterpret_cast<T*>( new std::uint8_t[ sizeof(T) * _size ]);
+        _pool = new Slot[_size];
         assert(_pool);
 
-        for(std::size_t i = 0; i < _size; ++i)
+        for(std::size_t i = _size; i > 0; --i)
         {
-            push(_pool + i);
+            push(_pool + i - 1);
         }
-        assert(_size == _stack.size() && "illegl size of stack");
+        assert(_size == _available && "illegl size of stack");
     }
     /// @}
     ~ObjectPool()
     {
         if(_pool)
         {
-            delete[] reinterpret_cast<std::uint8_t*>(_pool);
+            delete[] _pool;
         }
     }
 
@@ -55,35 +58,45 @@ template<class T> class ObjectPool
     /*! @brief Capacity of pool */
     GOBLIB_INLINE std::size_t size() const { return _size; }
     /*! @brief Number of available objects in pool. */
-    GOBLIB_INLINE std::size_t available() const { return _stack.size(); }
+    GOBLIB_INLINE std::size_t available() const { return _available; }
     /*! @brief Empty pool? */
-    GOBLIB_INLINE bool empty() const { return _stack.empty(); }
+    GOBLIB_INLINE bool empty() const { return _free == nullptr; }
+    /// @}
+
+    /// @name Statistics
+    /// @{
+    /*! @brief Maximum number of objects in use at the same time */
+    GOBLIB_INLINE std::size_t highWaterMark() const { return _highWater; }
+    /*! @brief Number of construct() that failed because pool was empty */
+    GOBLIB_INLINE std::size_t failedConstructs() const { return _failed; }
+    /*! @brief Reset statistics */
+    GOBLIB_INLINE void resetStatistics() { _highWater = _size - _available; _failed = 0; }
     /// @}
 
     /// @name Construct/Destruct
     /// @{
-    /*! 
+    /*!
       @brief Get and construct
       @param params Construct parameters
       @retval != nullptr Constructed object pointer.
       @retval == nullptr Pool is empty.
       @code
-      class A { 
+      class A {
       public:
-      A(){}; 
-      A(int a, const char* b){} 
+      A(){};
+      A(int a, const char* b){}
       };
-      ObjectPool<A,8> pool;
+      ObjectPool<A> pool(8);
       auto p = pool.construct(1,"construct params"); // call A(int,const char*)
       @endcode
     */
     template<class... Params> GOBLIB_NODISCARD T* construct(Params&&... params)
     {
-        if(empty()) { return nullptr; }
-        T* ptr = top();
-        pop();
-        new (ptr) T(std::forward<Params>(params)...); // placement new idiom.
-        return ptr;
+        if(empty()) { ++_failed; return nullptr; }
+        Slot* s = pop();
+        std::size_t used = _size - _available;
+        if(used > _highWater) { _highWater = used; }
+        return new (s->storage) T(std::forward<Params>(params)...); // placement new idiom.
     }
     /*!
       @brief Return to pool and destruct.
@@ -94,32 +107,235 @@ template<class T> class ObjectPool
         if(ptr)
         {
             ptr->~T(); // call destructor of T.
-            push(ptr);
+            push(reinterpret_cast<Slot*>(ptr));
         }
     }
     /// @}
 
   private:
+    union Slot
+    {
+        Slot* next;
+        alignas(T) std::uint8_t storage[sizeof(T)];
+    };
+
     /// @name Operation
     /// @{
-    GOBLIB_INLINE T* top() { return _stack.empty() ? nullptr : _stack.top(); }
-    GOBLIB_INLINE void pop() { _stack.pop(); }
-    GOBLIB_INLINE void push(T* p)
+    GOBLIB_INLINE Slot* pop()
+    {
+        Slot* s = _free;
+        _free = s->next;
+        --_available;
+        return s;
+    }
+    GOBLIB_INLINE void push(Slot* p)
     {
         assert(p && "ptr is null");
-        assert(_stack.size() <= _size && "pool is full");
+        assert(_available < _size && "pool is full");
         assert( p >= _pool && "Illegal pointer:l");
         assert( p < _pool + _size && "Illegal pointer:g");
-        _stack.push(p);
+        p->next = _free;
+        _free = p;
+        ++_available;
     }
     /// @}
-    
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
   private:
-    T* _pool;
+    Slot* _pool;
     const std::size_t _size;
-    std::stack<T*> _stack;  // pointer of entity
+    Slot* _free;  // Head of free list.
+    std::size_t _available;
+    std::size_t _highWater, _failed;
 };
 
+
+/*!
+  @brief Thread-safe object pool
+  @tparam T Type of object
+  @tparam MagazineSize Number of slots cached per thread
+  @tparam MaxThreads Number of threads alive at the same time that have magazine. Other threads use the shared free list directly.
+  @details Shared free list is a lock-free stack (slot index with ABA tag in 64bit).<br>
+  Each thread keeps a small magazine of free slots, so construct/destruct usually touch no shared state.
+  @note Slots cached in a magazine are not available to other threads. Call flush() on the thread before it ends.
+  (Otherwise they are used by the next thread that takes over the magazine)
+*/
+template<class T, std::size_t MagazineSize = 16, std::size_t MaxThreads = 16> class ConcurrentObjectPool
+{
+    static_assert(MagazineSize > 1, "MagazineSize must be greater than 1");
+    static_assert(MaxThreads > 0, "MaxThreads must be greater than 0");
+
+  public:
+    /// @name Constructor
+    /// @{
+    ConcurrentObjectPool(std::size_t size)
+            : _pool(new Slot[size]), _next(new std::atomic<std::uint32_t>[size]), _size(size)
+            , _head(0), _inUse(0), _highWater(0), _failed(0), _magazine()
+    {
+        assert(size > 0 && size < UINT32_MAX && "Illegal size");
+        for(std::size_t i = _size; i > 0; --i) { push(static_cast<std::uint32_t>(i - 1)); }
+    }
+    /// @}
+
+    /// @name Property
+    /// @{
+    /*! @brief Capacity of pool */
+    GOBLIB_INLINE std::size_t size() const { return _size; }
+    /*! @brief Number of available objects in pool. (Include cached in magazines) */
+    GOBLIB_INLINE std::size_t available() const { return _size - _inUse.load(std::memory_order_relaxed); }
+    /// @}
+
+    /// @name Statistics
+    /// @{
+    /*! @brief Maximum number of objects in use at the same time */
+    GOBLIB_INLINE std::size_t highWaterMark() const { return _highWater.load(std::memory_order_relaxed); }
+    /*! @brief Number of construct() that failed because pool was empty */
+    GOBLIB_INLINE std::size_t failedConstructs() const { return _failed.load(std::memory_order_relaxed); }
+    /// @}
+
+    /// @name Construct/Destruct
+    /// @{
+    /*!
+      @brief Get and construct
+      @retval != nullptr Constructed object pointer.
+      @retval == nullptr Pool is empty (or all free slots are cached by other threads).
+    */
+    template<class... Params> GOBLIB_NODISCARD T* construct(Params&&... params)
+    {
+        std::uint32_t idx = NONE;
+        Magazine* m = magazine();
+        if(m)
+        {
+            if(!m->count)
+            {
+                // Refill half
+                std::uint32_t i;
+                while(m->count < MagazineSize / 2 && (i = pop()) != NONE) { m->item[m->count++] = i; }
+            }
+            if(m->count) { idx = m->item[--m->count]; }
+        }
+        else { idx = pop(); }
+
+        if(idx == NONE) { _failed.fetch_add(1, std::memory_order_relaxed); return nullptr; }
+
+        std::size_t used = _inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+        std::size_t hw = _highWater.load(std::memory_order_relaxed);
+        while(used > hw && !_highWater.compare_exchange_weak(hw, used, std::memory_order_relaxed)) {}
+
+        return new (_pool[idx].storage) T(std::forward<Params>(params)...);
+    }
+    /*!
+      @brief Return to pool and destruct.
+      @param ptr pointer of object
+    */
+    void destruct(T* ptr)
+    {
+        if(!ptr) { return; }
+        Slot* s = reinterpret_cast<Slot*>(ptr);
+        assert(s >= _pool.get() && s < _pool.get() + _size && "Illegal pointer");
+        ptr->~T();
+        _inUse.fetch_sub(1, std::memory_order_relaxed);
+
+        std::uint32_t idx = static_cast<std::uint32_t>(s - _pool.get());
+        Magazine* m = magazine();
+        if(!m) { push(idx); return; }
+        if(m->count == MagazineSize)
+        {
+            // Return half
+            while(m->count > MagazineSize / 2) { push(m->item[--m->count]); }
+        }
+        m->item[m->count++] = idx;
+    }
+    /*! @brief Return slots cached by this thread to shared free list */
+    void flush()
+    {
+        Magazine* m = magazine();
+        while(m && m->count) { push(m->item[--m->count]); }
+    }
+    /// @}
+
+  private:
+    struct Slot { alignas(T) std::uint8_t storage[sizeof(T)]; };
+    struct Magazine
+    {
+        std::size_t count;
+        std::uint32_t item[MagazineSize];
+        Magazine() : count(0), item() {}
+        // Avoid false sharing
+        char padding[64 - (sizeof(std::size_t) + sizeof(std::uint32_t) * MagazineSize) % 64];
+    };
+    constexpr static std::uint32_t NONE = UINT32_MAX;
+
+    // Index of magazine owned by this thread. (Assigned on first use, returned on exit of thread)
+    struct ThreadIndex
+    {
+        std::size_t index;
+        ThreadIndex() : index(MaxThreads)
+        {
+            for(std::size_t i = 0; i < MaxThreads; ++i)
+            {
+                // Acquire pairs with release by the previous owner, so its magazine is visible.
+                if(!used()[i].load(std::memory_order_relaxed) && !used()[i].exchange(true, std::memory_order_acquire)) { index = i; break; }
+            }
+        }
+        ~ThreadIndex() { if(index < MaxThreads) { used()[index].store(false, std::memory_order_release); } }
+        static std::atomic<bool>* used()
+        {
+            static std::atomic<bool> u[MaxThreads]; // Zero initialized (Static storage)
+            return u;
+        }
+    };
+    static std::size_t threadIndex()
+    {
+        static thread_local ThreadIndex ti;
+        return ti.index;
+    }
+    GOBLIB_INLINE Magazine* magazine()
+    {
+        std::size_t ti = threadIndex();
+        return ti < MaxThreads ? &_magazine[ti] : nullptr;
+    }
+
+    // Lock-free stack. head is (tag << 32) | (index + 1), 0 is empty.
+    void push(const std::uint32_t idx)
+    {
+        std::uint64_t h = _head.load(std::memory_order_relaxed);
+        std::uint64_t n;
+        do
+        {
+            _next[idx].store(static_cast<std::uint32_t>(h), std::memory_order_relaxed);
+            n = ((h >> 32) + 1) << 32 | (idx + 1);
+        }while(!_head.compare_exchange_weak(h, n, std::memory_order_release, std::memory_order_relaxed));
+    }
+    std::uint32_t pop()
+    {
+        std::uint64_t h = _head.load(std::memory_order_acquire);
+        std::uint64_t n;
+        do
+        {
+            std::uint32_t top = static_cast<std::uint32_t>(h);
+            if(!top) { return NONE; }
+            n = ((h >> 32) + 1) << 32 | _next[top - 1].load(std::memory_order_relaxed);
+        }while(!_head.compare_exchange_weak(h, n, std::memory_order_acquire, std::memory_order_acquire));
+        return static_cast<std::uint32_t>(h) - 1;
+    }
+
+    ConcurrentObjectPool(const ConcurrentObjectPool&) = delete;
+    ConcurrentObjectPool& operator=(const ConcurrentObjectPool&) = delete;
+
+  private:
+    std::unique_ptr<Slot[]> _pool;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> _next; // Next index + 1 of free slot. (Atomic, because a stale pop may read it)
+    const std::size_t _size;
+    std::atomic<std::uint64_t> _head;
+    std::atomic<std::size_t> _inUse, _highWater, _failed;
+    Magazine _magazine[MaxThreads];
+};
+
+template<class T, std::size_t MS, std::size_t MT> constexpr std::uint32_t ConcurrentObjectPool<T, MS, MT>::NONE;
+
 //
 }
 #endif
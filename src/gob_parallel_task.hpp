@@ -0,0 +1,199 @@
+/*!
+  Goblin Library
+
+  @file  gob_parallel_task.hpp
+  @brief Task system that pumps independent subtrees in parallel.
+  @warning Tasks in independent subtrees are pumped on worker threads.
+*/
+#pragma once
+#ifndef GOBLIB_PARALLEL_TASK_HPP
+#define GOBLIB_PARALLEL_TASK_HPP
+
+#include "gob_macro.hpp"
+#include "gob_task.hpp"
+#include "gob_thread_pool.hpp"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+namespace goblib
+{
+
+/*!
+  @brief Parent-child task system with opt-in parallel pump.
+  @details Subtrees marked as independent are pumped as jobs on the work-stealing pool,
+  after other tasks are pumped serially on the caller thread. Priority order inside a subtree is kept.<br>
+  While pumped on worker thread, reserveInsertNode(), postMessage() and postBroadcastMessage() (also through TaskTree)
+  and kill() of this class are deferred per job, and applied in job order before insertReservedNodes() / remove_if() of pump().
+  @warning Tasks in independent subtree must not touch outside of own subtree except by deferred functions above.<br>
+  Use this->kill(task) instead of Task::kill() for tasks other than itself. sendMessage() is not deferred.
+  @note Derived class that overrides onRemoveNode must call that of ParallelTaskTree.
+*/
+template<class  T>
+class ParallelTaskTree : public TaskTree<T>
+{
+  public:
+    /*!
+      @param threads Number of threads include caller.
+      @param qreserve Message queue max size for post message.
+    */
+    explicit ParallelTaskTree(std::size_t threads = std::thread::hardware_concurrency(),
+                              std::size_t qreserve = TaskTree<T>::QUEUE_RESERVE_SIZE)
+            : TaskTree<T>(qreserve), _pool(threads), _independent(), _independentChildren(), _jobs(), _deferred()
+    {}
+
+    void pump(const float delta = 1.0f)
+    {
+        if(this->isPauseGlobal()) { return; }
+
+        GOBLIB_TRACE_SCOPE("ParallelTaskTree::pump");
+        this->deliverMessage();
+
+        _jobs.clear();
+        pumpSerial(this->root(), delta);
+
+        if(_deferred.size() < _jobs.size()) { _deferred.resize(_jobs.size()); }
+        _pool.run(_jobs.size(), [this, delta](const std::size_t idx)
+        {
+            Deferred& d = _deferred[idx];
+            d.owner = this;
+            _current = &d;
+
+            T* top = _jobs[idx];
+            top->pump(delta);
+            T* child = this->firstChild(top);
+            if(child) { this->visit([delta](T* t) { t->pump(delta); }, child); }
+
+            _current = nullptr;
+        });
+
+        // Barrier
+        for(std::size_t i = 0; i < _jobs.size(); ++i) { apply(_deferred[i]); }
+        this->insertReservedNodes();
+        this->remove_if([](const T* t) { return t->isKill(); });
+    }
+
+    /// @name Independent
+    /// @{
+    /*! @brief Set/unset top and its descendants as a job */
+    void setIndependent(T* top, bool b = true) { mark(_independent, top, b); }
+    /*! @brief Set/unset each child subtree of parent as a job */
+    void setIndependentChildren(T* parent, bool b = true) { mark(_independentChildren, parent, b); }
+    GOBLIB_INLINE bool isIndependent(const T* t) const { return contains(_independent, t); }
+    GOBLIB_INLINE bool isIndependentChildren(const T* t) const { return contains(_independentChildren, t); }
+    /*! @brief Number of threads include caller */
+    GOBLIB_INLINE std::size_t threads() const { return _pool.threads(); }
+    /// @}
+
+    /// @name Deferred on worker thread
+    /// @{
+    void kill(T* t, bool includeChildren = false)
+    {
+        assert(t);
+        if(inJob()) { _current->kill.emplace_back(t, includeChildren); return; }
+        t->kill(includeChildren);
+    }
+    /// @}
+
+  protected:
+    virtual void onRemoveNode(T* node) override
+    {
+        mark(_independent, node, false);
+        mark(_independentChildren, node, false);
+        TaskTree<T>::onRemoveNode(node);
+    }
+
+    /// @name Deferral
+    /// @{
+    virtual bool deferReserveInsertNode(T* node, T* parent) override
+    {
+        if(!inJob()) { return false; }
+        _current->reserve.emplace_back(node, parent);
+        return true;
+    }
+    virtual bool deferPostMessage(const TaskMessage& m, goblib::Task* target) override
+    {
+        if(!inJob()) { return false; }
+        _current->post.emplace_back(m, target);
+        return true;
+    }
+    virtual bool deferPostBroadcastMessage(const TaskMessage& m, T* top) override
+    {
+        if(!inJob()) { return false; }
+        _current->broadcast.emplace_back(m, top);
+        return true;
+    }
+    /// @}
+
+  private:
+    // Deferred changes by a job.
+    struct Deferred
+    {
+        const ParallelTaskTree* owner;
+        std::vector<std::pair<T*, T*>> reserve;
+        std::vector<std::pair<T*, bool>> kill;
+        std::vector<std::pair<TaskMessage, goblib::Task*>> post;
+        std::vector<std::pair<TaskMessage, T*>> broadcast;
+        Deferred() : owner(nullptr), reserve(), kill(), post(), broadcast() {}
+    };
+
+    GOBLIB_INLINE bool inJob() const { return _current && _current->owner == this; }
+
+    void pumpSerial(T* p, const float delta)
+    {
+        for(; p; p = this->nextSibling(p))
+        {
+            if(isIndependent(p)) { _jobs.push_back(p); continue; }
+
+            p->pump(delta);
+            T* child = this->firstChild(p);
+            if(isIndependentChildren(p))
+            {
+                for(; child; child = this->nextSibling(child)) { _jobs.push_back(child); }
+                continue;
+            }
+            if(child) { pumpSerial(child, delta); }
+        }
+    }
+
+    void apply(Deferred& d)
+    {
+        for(auto& e : d.kill) { e.first->kill(e.second); }
+        for(auto& e : d.reserve) { FamilyTree<T>::reserveInsertNode(e.first, e.second); }
+        for(auto& e : d.post) { TaskTree<T>::postMessage(e.first, e.second); }
+        for(auto& e : d.broadcast) { TaskTree<T>::postBroadcastMessage(e.first, e.second); }
+        d.reserve.clear();
+        d.kill.clear();
+        d.post.clear();
+        d.broadcast.clear();
+    }
+
+    // Sorted vector of nodes
+    static bool contains(const std::vector<T*>& v, const T* t)
+    {
+        auto it = std::lower_bound(v.begin(), v.end(), t, std::less<const T*>());
+        return it != v.end() && *it == t;
+    }
+    static void mark(std::vector<T*>& v, T* t, bool b)
+    {
+        auto it = std::lower_bound(v.begin(), v.end(), t, std::less<const T*>());
+        bool exists = it != v.end() && *it == t;
+        if(b && !exists) { v.insert(it, t); }
+        if(!b && exists) { v.erase(it); }
+    }
+
+  private:
+    ThreadPool _pool;
+    std::vector<T*> _independent;           // Top of independent subtree.
+    std::vector<T*> _independentChildren;   // Parent of independent subtrees.
+    std::vector<T*> _jobs;                  // Top of subtree pumped by job.
+    std::vector<Deferred> _deferred;        // Deferred changes for each job.
+    static thread_local Deferred* _current; // Deferred changes of job running on this thread.
+};
+
+template<class T> thread_local typename ParallelTaskTree<T>::Deferred* ParallelTaskTree<T>::_current = nullptr;
+
+//
+}
+#endif
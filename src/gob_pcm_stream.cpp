@@ -12,6 +12,7 @@ namespace goblib
 bool PcmStream::fetch()
 {
     _dataHead = _dataTail = _dataSize = 0;
+    _formatTag = 0;
     if(!_stream || !_stream->is_open()) { return false; }
 
     _stream->seek(0, goblib::seekdir::beg);
@@ -40,8 +41,24 @@ bool PcmStream::fetch()
     {
         return false;
     }
-    // Only support PCM
-    if(_format.format != wave::fmtSubChunk::WAVE_FORMAT_PCM)
+    _formatTag = _format.format;
+    // Extra of fmt chunk. (Chunks are aligned to 2 bytes)
+    std::uint32_t extra = _format.size > 16 ? (_format.size - 16 + (_format.size & 1)) : 0;
+    if(_format.format == wave::fmtSubChunk::WAVE_FORMAT_EXTENSIBLE && extra >= sizeof(wave::fmtExtensible))
+    {
+        wave::fmtExtensible ext;
+        if(_stream->read(&ext, sizeof(ext)) != sizeof(ext)) { return false; }
+        _formatTag = ext.subFormat;
+        extra -= sizeof(ext);
+    }
+    if(extra && !_stream->seek(extra, goblib::seekdir::cur)) { return false; }
+
+    // Only support PCM and IEEE float
+    if(_formatTag != wave::fmtSubChunk::WAVE_FORMAT_PCM && _formatTag != wave::fmtSubChunk::WAVE_FORMAT_IEEE_FLOAT)
+    {
+        return false;
+    }
+    if(!_format.channels || _format.blockAlign != _format.channels * ((_format.bits + 7) / 8))
     {
         return false;
     }
@@ -52,7 +69,7 @@ bool PcmStream::fetch()
     {
         if(_stream->read(&sub, sizeof(sub)) != sizeof(sub)) { return false; }
         if(sub.identifier == wave::SubChunk::DATA) { break; } // "data"
-        if(!_stream->seek(sub.size, goblib::seekdir::cur)) { return false; }
+        if(!_stream->seek(sub.size + (sub.size & 1), goblib::seekdir::cur)) { return false; }
     }
 
     if(sub.identifier == wave::SubChunk::DATA)
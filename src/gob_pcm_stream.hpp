@@ -60,6 +60,16 @@ struct fmtChunkExtra
     //    uint8_t _data[size];
 };
 
+/*! @brief Extra of fmt Sub-Chunk for WAVE_FORMAT_EXTENSIBLE */
+struct fmtExtensible
+{
+    uint16_t size;
+    uint16_t validBits;
+    uint32_t channelMask;
+    uint16_t subFormat; //!< Format code of sub format GUID
+    uint8_t guid[14];
+};
+
 /*! @brief Sub chunk */
 struct SubChunk
 {
@@ -80,7 +90,7 @@ class PcmStream
   public:
     PcmStream() : PcmStream(nullptr) {}
     explicit PcmStream(Stream* s)
-            : _stream(s), _format{}, _dataHead(0), _dataTail(0), _dataSize(0)
+            : _stream(s), _format{}, _formatTag(0), _dataHead(0), _dataTail(0), _dataSize(0)
     {
         if(s) { fetch(); }
     }
@@ -110,12 +120,25 @@ class PcmStream
     std::uint16_t channels() const { return _format.channels; }
     std::uint32_t sampleRate() const { return _format.rate; }
     std::uint16_t bitsPerSample() const { return _format.bits; }
+    /*! @brief Bytes per frame (all channels) */
+    std::uint16_t blockAlign() const { return _format.blockAlign; }
+    /*! @brief WAVE_FORMAT_PCM or WAVE_FORMAT_IEEE_FLOAT (Sub format if WAVE_FORMAT_EXTENSIBLE) */
+    std::uint16_t formatTag() const { return _formatTag; }
     /// @}
 
     std::size_t read(std::uint8_t* buf, std::size_t sz)
     {
-        if(!valid() || _stream->is_tail()) { return 0; }
-        return _stream->read(buf, sz);
+        if(!valid() || is_tail()) { return 0; }
+        return _stream->read(buf, static_cast<std::size_t>(std::min(static_cast<Stream::pos_type>(sz), _dataTail - _stream->position())));
+    }
+    /*!
+      @brief Zero-copy read of PCM data (Clamped to tail of data)
+      @note Returns { nullptr, 0 } if the stream does not support view.
+    */
+    StreamView view(std::size_t sz)
+    {
+        if(!valid() || is_tail()) { return StreamView{ nullptr, 0 }; }
+        return _stream->view(static_cast<std::size_t>(std::min(static_cast<Stream::pos_type>(sz), _dataTail - _stream->position())));
     }
     
     /// @name Seek
@@ -137,6 +160,7 @@ class PcmStream
   private:
     Stream* _stream;
     wave::fmtSubChunk _format;
+    std::uint16_t _formatTag;
     Stream::pos_type _dataHead, _dataTail;
     std::size_t _dataSize;
 };
@@ -11,6 +11,7 @@
 #include "gob_macro.hpp"
 #include "gob_math.hpp"
 #include "gob_fixed_point_number.hpp"
+#include "gob_fixed_point_math.hpp"
 #include <type_traits> // std::is_integral,...
 #include <utility> // std::rel_ops
 #include <initializer_list>
@@ -120,7 +121,7 @@ template<typename T> class Point
     /// @name Calculate
     /// @{
     /*! @brief Length from origin */
-    GOBLIB_INLINE T length() const { return std::sqrt(lengthSq()); }
+    GOBLIB_INLINE T length() const { return goblib::math::sqrt(lengthSq()); }
     /*! @brief Length squared from origin */
     constexpr GOBLIB_INLINE T lengthSq() const { return (_x * _x) + (_y * _y); }
     /*! @brief Angle from origin for arithmetic */
@@ -128,7 +129,7 @@ template<typename T> class Point
     GOBLIB_INLINE auto angle() const -> decltype(std::atan2(U(),U())) { return std::atan2(_y, _x); }
     /*! @brief Angle from origin for fixed point number */
     template <typename U = T, typename std::enable_if<goblib::is_fixed_point_number<U>::value, std::nullptr_t>::type = nullptr>
-    GOBLIB_INLINE float angle() const { return std::atan2(_y.template value<float>(), _x.template value<float>()); }
+    GOBLIB_INLINE U angle() const { return goblib::math::atan2(_y, _x); }
     /// @}
 
     GOBLIB_INLINE void zero() { _x = _y = T(0); }
@@ -2,7 +2,8 @@
   Goblin Library
 
   @file   gob_profile.hpp
-  @brief  Simple profiler.
+  @brief  Simple profiler and aggregating profiler.
+  @note Scopes are also recorded to TraceRecorder while recording.
   @attention To use them, you need to define GOBLIB_ENABLE_PROFILE.
 */
 #pragma once
@@ -12,10 +13,15 @@
 #if defined(GOBLIB_ENABLE_PROFILE)
 
 #include <chrono> // std::chrono
-#include <cstring> // std::strncpy
+#include <cstring> // std::strncpy, std::strcmp
+#include <cstdint>
+#include <algorithm> // std::nth_element
+#include <cassert>
 #include "gob_macro.hpp"
 #include "gob_utility.hpp" // for goblib::size
 #include "gob_template_helper.hpp"
+#include "gob_trace.hpp"
+#include "gob_cycle_clock.hpp"
 #include <cstdio>
 
 namespace goblib
@@ -49,7 +55,7 @@ template<class Clock, class Duration> class MeasuringInstrument
     using TimePoint = std::chrono::time_point<Clock>;
     
   public:
-    explicit MeasuringInstrument(const char* tag = "", bool prt = true) : _tag{}, _start(Duration(0)), _print(prt)
+    explicit MeasuringInstrument(const char* tag = "", bool prt = true) : _tag{}, _start(Duration(0)), _print(prt), _trace(_tag)
     {
         std::strncpy(_tag, tag, sizeof(_tag));
         _tag[goblib::size(_tag) - 1] = '\0';
@@ -78,11 +84,12 @@ template<class Clock, class Duration> class MeasuringInstrument
     char _tag[TAG_SIZE];
     TimePoint  _start;
     bool _print;
+    TraceScope _trace; // Destructed before _tag.
 
   protected:
     GOBLIB_INLINE void print(Duration t)
     {
-        printf("%*sProfile:[%s] %lld\n", _indent * 2, "", tag(), t.count());
+        printf("%*sProfile:[%s] %lld\n", _indent * 2, "", tag(), static_cast<long long>(t.count()));
     }
 
   private:
@@ -98,19 +105,273 @@ using Ordinary = MeasuringInstrument<std::chrono::steady_clock, std::chrono::mil
   High precision measuring instruments.
 */
 using HighPrecision = MeasuringInstrument<std::chrono::high_resolution_clock, std::chrono::nanoseconds>;
+/*! @typedef Cycle
+  Measuring instruments by hardware cycle counter. (Low overhead)
+*/
+using Cycle = MeasuringInstrument<goblib::CycleClock, std::chrono::nanoseconds>;
+
+/*!
+  @brief Aggregating profiler for each thread.
+  @tparam Clock any clock class in std::chrono.
+  @tparam Samples Max samples in a frame.
+  @tparam Nodes Max nodes of call tree.
+  @tparam History Number of frames for statistics.
+  @details Scopes record samples (tag, start, elapsed) into fixed buffer of the thread. No allocation and I/O.<br>
+  endFrame() builds call tree of tags (same tag under same parent is a node), and keeps inclusive time per frame of each node.
+  Statistics of node are calculated from the last History frames.
+  @note Tag must be alive until the profiler is reset. (e.g. string literal)
+  @attention To use them, you need to define GOBLIB_ENABLE_PROFILE.
+*/
+template<class Clock = std::chrono::steady_clock, std::size_t Samples = 256, std::size_t Nodes = 64, std::size_t History = 60>
+class AggregatingProfiler
+{
+#if defined(GOBLIB_CPP20_OR_LATER)
+    static_assert(std::chrono::is_clock<Clock>::value, "Clock must be any clock class in std::chrono.");
+#else
+    static_assert(goblib::template_helper::is_clock<Clock>::value, "Clock must be any clock class in std::chrono.");
+#endif
+    static_assert(Samples > 0 && Samples < 0xFFFF, "Samples must be 1 - 65534");
+    static_assert(Nodes > 0 && Nodes < 0xFFFF, "Nodes must be 1 - 65534");
+    static_assert(History > 0, "History must be greater than zero");
+
+  public:
+    using Duration = typename Clock::duration;
+    using TimePoint = typename Clock::time_point;
+    constexpr static std::uint16_t NONE = 0xFFFF;
+
+    /*! @brief Node of call tree */
+    struct Node
+    {
+        const char* tag;
+        std::uint16_t parent, child, sibling;   //!< Index of node or NONE.
+        std::uint16_t depth;                    //!< Zero is top level.
+    };
+    /*! @brief Statistics of inclusive time per frame (Frames that node appeared) */
+    struct Stats
+    {
+        Duration min, avg, max, p99;
+        std::uint32_t calls;    //!< Calls in the last frame.
+        std::uint32_t frames;   //!< Number of frames for statistics.
+    };
+
+    AggregatingProfiler() { reset(); }
+
+    /*! @brief Instance of this thread */
+    static AggregatingProfiler& instance()
+    {
+        static thread_local AggregatingProfiler p;
+        return p;
+    }
+
+    /// @name Sampling
+    /// @{
+    /*! @brief Begin sample. Return index of sample or NONE (buffer full) */
+    GOBLIB_INLINE std::uint16_t begin(const char* tag)
+    {
+        if(_samples >= Samples) { ++_dropped; return NONE; }
+        std::uint16_t idx = static_cast<std::uint16_t>(_samples++);
+        Sample& s = _sample[idx];
+        s.tag = tag;
+        s.parent = _current;
+        s.elapsed = -1;
+        _current = idx;
+        s.start = Clock::now();
+        return idx;
+    }
+    /*! @brief End sample. frame is frame() at begin */
+    GOBLIB_INLINE void end(const std::uint16_t idx, const std::uint32_t frame)
+    {
+        TimePoint now = Clock::now();
+        if(idx == NONE || frame != _frame) { return; }
+        Sample& s = _sample[idx];
+        s.elapsed = (now - s.start).count();
+        _current = s.parent;
+    }
+    /*! @brief Aggregate samples of this frame and start next frame */
+    void endFrame()
+    {
+        assert(_current == NONE && "endFrame in scope");
+        const std::size_t slot = _frame % History;
+        for(std::size_t i = 0; i < _nodes; ++i) { _history[i][slot] = ABSENT; _calls[i] = 0; }
+
+        for(std::size_t i = 0; i < _samples; ++i)
+        {
+            const Sample& s = _sample[i];
+            std::uint16_t parent = s.parent != NONE ? _nodeOf[s.parent] : NONE;
+            std::uint16_t n = (s.parent != NONE && parent == NONE) ? NONE : findOrAdd(parent, s.tag);
+            _nodeOf[i] = n;
+            if(n == NONE || s.elapsed < 0) { continue; } // Overflow or not ended.
+            std::uint32_t el = s.elapsed < static_cast<std::int64_t>(ABSENT) ? static_cast<std::uint32_t>(s.elapsed) : ABSENT - 1;
+            std::uint32_t& h = _history[n][slot];
+            h = (h == ABSENT) ? el : (ABSENT - 1 - h < el ? ABSENT - 1 : h + el);
+            ++_calls[n];
+        }
+        _samples = 0;
+        _current = NONE;
+        ++_frame;
+    }
+    /*! @brief Clear all samples, nodes and statistics */
+    void reset()
+    {
+        _samples = _nodes = 0;
+        _current = NONE;
+        _frame = 0;
+        _dropped = 0;
+    }
+    /// @}
+
+    /// @name Query
+    /// @{
+    /*! @brief Number of frames ended */
+    GOBLIB_INLINE std::uint32_t frame() const { return _frame; }
+    /*! @brief Number of samples dropped by full buffer */
+    GOBLIB_INLINE std::uint32_t dropped() const { return _dropped; }
+    GOBLIB_INLINE std::size_t nodes() const { return _nodes; }
+    GOBLIB_INLINE const Node& node(const std::size_t i) const { assert(i < _nodes); return _node[i]; }
+    /*! @brief Index of node or NONE */
+    std::uint16_t find(const char* tag, const std::uint16_t parent = NONE) const
+    {
+        std::uint16_t n = parent == NONE ? (_nodes ? 0 : NONE) : _node[parent].child;
+        while(n != NONE && std::strcmp(_node[n].tag, tag) != 0) { n = _node[n].sibling; }
+        return n;
+    }
+    /*! @brief Statistics of node */
+    Stats stats(const std::size_t i) const
+    {
+        assert(i < _nodes);
+        std::uint32_t v[History];
+        std::uint32_t num = 0;
+        std::uint64_t sum = 0;
+        std::size_t frames = std::min<std::size_t>(_frame, History);
+        for(std::size_t f = 0; f < frames; ++f)
+        {
+            std::uint32_t h = _history[i][f];
+            if(h != ABSENT) { v[num++] = h; sum += h; }
+        }
+        Stats st{ Duration(0), Duration(0), Duration(0), Duration(0), 0, num };
+        if(_frame) { st.calls = _calls[i]; }
+        if(!num) { return st; }
+        st.min = Duration(*std::min_element(v, v + num));
+        st.max = Duration(*std::max_element(v, v + num));
+        st.avg = Duration(static_cast<typename Duration::rep>(sum / num));
+        std::uint32_t k = (num * 99 + 99) / 100 - 1; // ceil(num * 0.99) - 1
+        std::nth_element(v, v + k, v + num);
+        st.p99 = Duration(v[k]);
+        return st;
+    }
+    /*! @brief Call func(index, node) in depth-first order */
+    template<typename F> void visit(F&& func) const { if(_nodes) { visit(std::forward<F>(func), 0); } }
+    /*! @brief Print call tree (Not for hot path) */
+    void print() const
+    {
+        visit([this](const std::size_t i, const Node& n)
+        {
+            Stats st = stats(i);
+            printf("%*s[%s] calls:%u min:%lld avg:%lld max:%lld p99:%lld\n", n.depth * 2, "", n.tag, st.calls,
+                   (long long)st.min.count(), (long long)st.avg.count(), (long long)st.max.count(), (long long)st.p99.count());
+        });
+    }
+    /// @}
+
+  private:
+    constexpr static std::uint32_t ABSENT = 0xFFFFFFFF; // Node is not appeared in the frame.
+
+    struct Sample
+    {
+        const char* tag;
+        TimePoint start;
+        std::int64_t elapsed;   // Ticks of Clock, negative if not ended.
+        std::uint16_t parent;   // Index of sample.
+    };
+
+    std::uint16_t findOrAdd(const std::uint16_t parent, const char* tag)
+    {
+        std::uint16_t last = NONE;
+        std::uint16_t n = parent == NONE ? (_nodes ? 0 : NONE) : _node[parent].child;
+        while(n != NONE)
+        {
+            if(_node[n].tag == tag || std::strcmp(_node[n].tag, tag) == 0) { return n; }
+            last = n;
+            n = _node[n].sibling;
+        }
+        if(_nodes >= Nodes) { return NONE; }
+
+        n = static_cast<std::uint16_t>(_nodes++);
+        _node[n] = Node{ tag, parent, NONE, NONE, static_cast<std::uint16_t>(parent == NONE ? 0 : _node[parent].depth + 1) };
+        if(last != NONE) { _node[last].sibling = n; }
+        else if(parent != NONE) { _node[parent].child = n; }
+        for(std::size_t f = 0; f < History; ++f) { _history[n][f] = ABSENT; }
+        _calls[n] = 0;
+        return n;
+    }
+
+    template<typename F> void visit(F&& func, std::uint16_t n) const
+    {
+        for(; n != NONE; n = _node[n].sibling)
+        {
+            func(static_cast<std::size_t>(n), _node[n]);
+            if(_node[n].child != NONE) { visit(func, _node[n].child); }
+        }
+    }
+
+  private:
+    Sample _sample[Samples];
+    std::uint16_t _nodeOf[Samples];         // Node of sample (at endFrame)
+    std::size_t _samples;
+    std::uint16_t _current;                 // Sample in progress.
+    Node _node[Nodes];                      // Node 0 is the first top level node, others are linked by sibling.
+    std::uint32_t _history[Nodes][History]; // Inclusive ticks per frame.
+    std::uint32_t _calls[Nodes];            // Calls in the last frame.
+    std::size_t _nodes;
+    std::uint32_t _frame, _dropped;
+};
+template<class C, std::size_t S, std::size_t N, std::size_t H> constexpr std::uint16_t AggregatingProfiler<C, S, N, H>::NONE;
+template<class C, std::size_t S, std::size_t N, std::size_t H> constexpr std::uint32_t AggregatingProfiler<C, S, N, H>::ABSENT;
+
+/*! @typedef FrameProfiler
+  Aggregating profiler used by GOBLIB_SCOPED_PROFILE.
+*/
+using FrameProfiler = AggregatingProfiler<std::chrono::steady_clock>;
+
+/*! @brief Record a sample to profiler of this thread while alive */
+template<class Profiler> class ScopedSample
+{
+  public:
+    explicit ScopedSample(const char* tag)
+            : _profiler(Profiler::instance()), _frame(_profiler.frame()), _idx(_profiler.begin(tag)), _trace(tag) {}
+    ~ScopedSample() { _profiler.end(_idx, _frame); }
+
+  private:
+    ScopedSample(const ScopedSample&) = delete;
+    ScopedSample& operator=(const ScopedSample&) = delete;
+
+    Profiler& _profiler;
+    std::uint32_t _frame;
+    std::uint16_t _idx;
+    TraceScope _trace;
+};
 
-/*! Simple profile in scope.*/
-#define GOBLIB_SCOPED_PROFILE(tag) goblib::profile::Ordinary GOBLIB_CONCAT(pf_,__LINE__)((#tag))
+/*! Profile in scope. (Aggregated by FrameProfiler) */
+#define GOBLIB_SCOPED_PROFILE(tag) goblib::profile::ScopedSample<goblib::profile::FrameProfiler> GOBLIB_CONCAT(pf_,__LINE__)((#tag))
+/*! Aggregate profile in this frame. (Call at end of frame on each profiled thread) */
+#define GOBLIB_PROFILE_END_FRAME() goblib::profile::FrameProfiler::instance().endFrame()
+/*! Simple profile in scope. (Print elapsed time at end of scope) */
+#define GOBLIB_SCOPED_PROFILE_PRINT(tag) goblib::profile::Ordinary GOBLIB_CONCAT(pf_,__LINE__)((#tag))
 /*! Simple profile in scope.(High precision) */
 #define GOBLIB_SCOPED_PROFILE_HIGH(tag) goblib::profile::HighPrecision GOBLIB_CONCAT(pf_,__LINE__)((#tag))
+/*! Simple profile in scope.(Cycle counter) */
+#define GOBLIB_SCOPED_PROFILE_CYCLE(tag) goblib::profile::Cycle GOBLIB_CONCAT(pf_,__LINE__)((#tag))
 
 //
 }}
 
 #else // defined(GOBLIB_ENABLE_PROFILE)
 
-#define GOBLIB_SCOPED_PROFILEK(tag) /* Nop */
+#define GOBLIB_SCOPED_PROFILE(tag) /* Nop */
+#define GOBLIB_PROFILE_END_FRAME() /* Nop */
+#define GOBLIB_SCOPED_PROFILE_PRINT(tag) /* Nop */
 #define GOBLIB_SCOPED_PROFILE_HIGH(tag) /* Nop */
+#define GOBLIB_SCOPED_PROFILE_CYCLE(tag) /* Nop */
 
 #endif // defined(GOBLIB_ENABLE_PROFILE)
 #endif
@@ -9,26 +9,236 @@
 #define GOBLIB_RANDOM_HPP
 
 #include <random>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <limits>
+#include <cassert>
 #include "gob_template_helper.hpp"
 #include "gob_macro.hpp"
 
+/// @cond
+#if !defined(GOBLIB_RANDOM_NO_SIMD)
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define GOBLIB_RANDOM_SSE2
+#   include <emmintrin.h>
+# elif defined(__ARM_NEON)
+#   define GOBLIB_RANDOM_NEON
+#   include <arm_neon.h>
+# endif
+#endif
+/// @endcond
+
 namespace goblib
 {
-/*! 
+
+/// @name Small-state engines
+/// @note Satisfy is_rng, so they can be used as Engine of Rng.
+/// @{
+/*!
+  @brief SplitMix64 (64-bit state)
+  @note Also used for seeding other engines.
+*/
+class SplitMix64
+{
+  public:
+    using result_type = std::uint64_t;
+    constexpr static result_type default_seed = 0x9E3779B97F4A7C15ULL;
+    constexpr static result_type GAMMA = 0x9E3779B97F4A7C15ULL;
+
+    explicit SplitMix64(const result_type s = default_seed) : _state(s) {}
+
+    GOBLIB_INLINE void seed(const result_type s = default_seed) { _state = s; }
+    GOBLIB_INLINE result_type operator()()
+    {
+        result_type z = (_state += GAMMA);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    /*! @brief Advances z steps (O(1)) */
+    GOBLIB_INLINE void discard(const unsigned long long z) { _state += GAMMA * z; }
+    /*! @brief Advances 2^48 steps for independent stream */
+    GOBLIB_INLINE void jump() { discard(1ULL << 48); }
+
+    constexpr static result_type min() { return 0; }
+    constexpr static result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    GOBLIB_INLINE bool operator==(const SplitMix64& o) const { return _state == o._state; }
+    GOBLIB_INLINE bool operator!=(const SplitMix64& o) const { return !(*this == o); }
+
+  private:
+    result_type _state;
+};
+
+/*!
+  @brief xoshiro128++ (128-bit state)
+  @note jump() is equivalent to 2^64 calls.
+*/
+class Xoshiro128pp
+{
+  public:
+    using result_type = std::uint32_t;
+    constexpr static std::uint64_t default_seed = 0x5EED5EED5EED5EEDULL;
+
+    explicit Xoshiro128pp(const std::uint64_t s = default_seed) { seed(s); }
+
+    /*! @brief Seeding by SplitMix64 */
+    void seed(const std::uint64_t s = default_seed)
+    {
+        SplitMix64 sm(s);
+        const std::uint64_t a = sm(), b = sm();
+        _s[0] = static_cast<std::uint32_t>(a);
+        _s[1] = static_cast<std::uint32_t>(a >> 32);
+        _s[2] = static_cast<std::uint32_t>(b);
+        _s[3] = static_cast<std::uint32_t>(b >> 32);
+        if(!(_s[0] | _s[1] | _s[2] | _s[3])) { _s[0] = 1; } // All zero state is invalid.
+    }
+
+    GOBLIB_INLINE result_type operator()()
+    {
+        const std::uint32_t r = rotl(_s[0] + _s[3], 7) + _s[0];
+        const std::uint32_t t = _s[1] << 9;
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = rotl(_s[3], 11);
+        return r;
+    }
+    void discard(unsigned long long z) { while(z--) { (*this)(); } }
+
+    /*! @brief Advances 2^64 steps for independent stream */
+    void jump()
+    {
+        constexpr std::uint32_t JUMP[] = { 0x8764000BU, 0xF542D2D3U, 0x6FA035C3U, 0x77F2DB5BU };
+        std::uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for(auto j : JUMP)
+        {
+            for(int b = 0; b < 32; ++b)
+            {
+                if(j & (1U << b)) { s0 ^= _s[0]; s1 ^= _s[1]; s2 ^= _s[2]; s3 ^= _s[3]; }
+                (*this)();
+            }
+        }
+        _s[0] = s0; _s[1] = s1; _s[2] = s2; _s[3] = s3;
+    }
+
+    constexpr static result_type min() { return 0; }
+    constexpr static result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    GOBLIB_INLINE bool operator==(const Xoshiro128pp& o) const
+    {
+        return _s[0] == o._s[0] && _s[1] == o._s[1] && _s[2] == o._s[2] && _s[3] == o._s[3];
+    }
+    GOBLIB_INLINE bool operator!=(const Xoshiro128pp& o) const { return !(*this == o); }
+
+  private:
+    friend class Xoshiro128ppX4;
+    GOBLIB_INLINE static std::uint32_t rotl(const std::uint32_t x, const int k) { return (x << k) | (x >> (32 - k)); }
+
+    std::uint32_t _s[4];
+};
+
+/*!
+  @brief PCG32 (XSH-RR, 64-bit state and stream)
+  @note discard() is O(log z).
+*/
+class Pcg32
+{
+  public:
+    using result_type = std::uint32_t;
+    constexpr static std::uint64_t default_seed = 0x853C49E6748FEA9BULL;
+    constexpr static std::uint64_t default_stream = 0xDA3E39CB94B95BDBULL;
+    constexpr static std::uint64_t MULTIPLIER = 6364136223846793005ULL;
+
+    explicit Pcg32(const std::uint64_t s = default_seed, const std::uint64_t stream = default_stream) { seed(s, stream); }
+
+    void seed(const std::uint64_t s = default_seed, const std::uint64_t stream = default_stream)
+    {
+        _state = 0;
+        _inc = (stream << 1) | 1U;
+        (*this)();
+        _state += s;
+        (*this)();
+    }
+
+    GOBLIB_INLINE result_type operator()()
+    {
+        const std::uint64_t old = _state;
+        _state = old * MULTIPLIER + _inc;
+        const std::uint32_t xs = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+        const std::uint32_t rot = static_cast<std::uint32_t>(old >> 59);
+        return (xs >> rot) | (xs << ((32 - rot) & 31));
+    }
+    /*! @brief Advances z steps (O(log z)) */
+    void discard(unsigned long long z)
+    {
+        std::uint64_t am = 1, ap = 0, cm = MULTIPLIER, cp = _inc;
+        while(z)
+        {
+            if(z & 1) { am *= cm; ap = ap * cm + cp; }
+            cp = (cm + 1) * cp;
+            cm *= cm;
+            z >>= 1;
+        }
+        _state = am * _state + ap;
+    }
+    /*! @brief Advances 2^48 steps for independent stream. (Or construct with other stream) */
+    GOBLIB_INLINE void jump() { discard(1ULL << 48); }
+
+    constexpr static result_type min() { return 0; }
+    constexpr static result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    GOBLIB_INLINE bool operator==(const Pcg32& o) const { return _state == o._state && _inc == o._inc; }
+    GOBLIB_INLINE bool operator!=(const Pcg32& o) const { return !(*this == o); }
+
+  private:
+    std::uint64_t _state, _inc;
+};
+/// @}
+
+/// @cond
+namespace detail
+{
+// Engine generates full 32 or 64 bits?
+template<class Engine> struct random_full_bits
+        : std::integral_constant<bool, Engine::min() == 0 &&
+                                 (Engine::max() == 0xFFFFFFFFULL || Engine::max() == 0xFFFFFFFFFFFFFFFFULL)> {};
+template<class Engine> struct random_bits64
+        : std::integral_constant<bool, Engine::min() == 0 && Engine::max() == 0xFFFFFFFFFFFFFFFFULL> {};
+
+template<class Engine> struct has_jump
+{
+    template<class U> static auto test(U* u) -> decltype(u->jump(), std::true_type{});
+    template<class U> static auto test(...) -> std::false_type;
+    using type = decltype(test<Engine>(nullptr));
+    constexpr static bool value = type::value;
+};
+//
+}
+/// @endcond
+
+/*!
   @brief Wrapper for RNG.
+  @details Engines generate full 32/64 bits (e.g. std::mt19937, Xoshiro128pp, Pcg32, SplitMix64) use
+  Lemire's multiply-shift for integer and bit conversion for floating point, without distribution objects.
   @tparam Engine pseudo-random number engine. (e.g. std::mt19937)
 */
 template<class Engine> class Rng
 {
     static_assert(goblib::template_helper::is_rng<Engine>::value, "Engine must be random number engine");
+    using SeedType = typename std::decay<decltype(Engine::default_seed)>::type;
+    constexpr static bool FULL = detail::random_full_bits<Engine>::value;
 
   public:
     /// @name Construction and Seeding
     /// @{
-    explicit Rng(typename Engine::result_type seed = Engine::default_seed) : _engine(seed) {}
+    explicit Rng(SeedType seed = Engine::default_seed) : _engine(seed) {}
     Rng(const Rng& o) : _engine(o._engine) {}
     Rng(Rng&& o) : _engine(std::move(o._engine)) {}
-    
+
     /*! Sets the current state of the engine  */
     GOBLIB_INLINE void seed(std::uint32_t seed) { _engine.seed(seed); }
     /// @}
@@ -49,10 +259,10 @@ template<class Engine> class Rng
         }
         return *this;
     }
-    
+
     /// @name  Generation
     /// @{
-    /*! 
+    /*!
       @brief Produces random values, uniformly distributed on the closed interval [a,b], that is, distributed according to the discrete probability function
       @tparam Type for range and return value.
       @param a Minimum value
@@ -62,36 +272,361 @@ template<class Engine> class Rng
     template<typename U, typename std::enable_if< std::is_integral<U>::value, std::nullptr_t>::type = nullptr>
     GOBLIB_INLINE U operator()(const U a, const U b)
     {
-        std::uniform_int_distribution<> d(a,b);
-        return d(_engine);
+        assert(a <= b && "a must be less than or equal b");
+        using UU = typename std::make_unsigned<U>::type;
+        const std::uint64_t span = static_cast<UU>(static_cast<UU>(b) - static_cast<UU>(a));
+        return static_cast<U>(static_cast<UU>(a) + static_cast<UU>(bounded(span)));
     }
 
+    /*! @brief Produces random values, uniformly distributed on the interval [a,b) */
     template<typename U, typename std::enable_if< std::is_floating_point<U>::value, std::nullptr_t>::type = nullptr>
     GOBLIB_INLINE U operator()(const U a, const U b)
     {
-        std::uniform_real_distribution<> d(a,b);
-        return d(_engine);
+        return a + (b - a) * unit<U>();
     }
 
     /*! @brief Advances the engine's state and returns the generated value */
     GOBLIB_INLINE typename Engine::result_type operator()() { return _engine(); }
-    
+
     /*! Advances the engine's state by a specified amount */
     GOBLIB_INLINE void discard(unsigned long long z)
     {
-        while(z--) { (*this)(); }
+        _engine.discard(z);
+    }
+
+    /*! @brief Fill n values in the range. (Same as operator()(a, b) each) */
+    template<typename U> void fill(U* out, std::size_t n, const U a, const U b)
+    {
+        while(n--) { *out++ = (*this)(a, b); }
     }
+    template<typename U> void fill(U* first, U* last, const U a, const U b) { fill(first, static_cast<std::size_t>(last - first), a, b); }
+
+    /*! @brief Jump ahead for independent stream each thread (Engine must have jump()) */
+    template<class E = Engine, typename std::enable_if<detail::has_jump<E>::value, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE void jump() { _engine.jump(); }
     /// @}
-    
+
     /// @name Characteristics
     /// @{
     typename Engine::result_type min() const { return Engine::min(); }
     typename Engine::result_type max() const { return Engine::max(); }
+    GOBLIB_INLINE Engine& engine() { return _engine; }
+    GOBLIB_INLINE const Engine& engine() const { return _engine; }
     /// @}
 
   private:
+    // 32 random bits
+    template<bool B = FULL, typename std::enable_if<B, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE std::uint32_t bits32()
+    {
+        return static_cast<std::uint32_t>(detail::random_bits64<Engine>::value ? (static_cast<std::uint64_t>(_engine()) >> 32) : _engine());
+    }
+    template<bool B = FULL, typename std::enable_if<B, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE std::uint64_t bits64()
+    {
+        return detail::random_bits64<Engine>::value ? static_cast<std::uint64_t>(_engine())
+                : (static_cast<std::uint64_t>(bits32()) << 32) | bits32();
+    }
+
+    // [0, span] by Lemire's nearly divisionless method
+    template<bool B = FULL, typename std::enable_if<B, std::nullptr_t>::type = nullptr>
+    std::uint64_t bounded(const std::uint64_t span)
+    {
+        if(span >= 0xFFFFFFFFULL)
+        {
+            if(span == 0xFFFFFFFFULL) { return bits32(); }
+            if(span == 0xFFFFFFFFFFFFFFFFULL) { return bits64(); }
+            std::uniform_int_distribution<std::uint64_t> d(0, span);
+            return d(_engine);
+        }
+        const std::uint32_t range = static_cast<std::uint32_t>(span + 1);
+        std::uint64_t m = static_cast<std::uint64_t>(bits32()) * range;
+        std::uint32_t l = static_cast<std::uint32_t>(m);
+        if(l < range)
+        {
+            const std::uint32_t t = static_cast<std::uint32_t>(-range) % range;
+            while(l < t)
+            {
+                m = static_cast<std::uint64_t>(bits32()) * range;
+                l = static_cast<std::uint32_t>(m);
+            }
+        }
+        return m >> 32;
+    }
+    template<bool B = FULL, typename std::enable_if<!B, std::nullptr_t>::type = nullptr>
+    std::uint64_t bounded(const std::uint64_t span)
+    {
+        std::uniform_int_distribution<std::uint64_t> d(0, span);
+        return d(_engine);
+    }
+
+    // [0, 1)
+    template<typename U, bool B = FULL, typename std::enable_if<B, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE U unit()
+    {
+        return (std::numeric_limits<U>::digits <= 24)
+                ? static_cast<U>(static_cast<float>(bits32() >> 8) * (1.0f / 16777216.0f))
+                : static_cast<U>(static_cast<double>(bits64() >> 11) * (1.0 / 9007199254740992.0));
+    }
+    template<typename U, bool B = FULL, typename std::enable_if<!B, std::nullptr_t>::type = nullptr>
+    GOBLIB_INLINE U unit()
+    {
+        std::uniform_real_distribution<U> d(U(0), U(1));
+        return d(_engine);
+    }
+
     Engine _engine;
 };
 
+/// @cond
+namespace detail
+{
+// Multi-lane kernels. (Return processed count)
+template<bool SIMD> struct RandomLanes
+{
+    static GOBLIB_INLINE std::size_t bits(std::uint32_t*, std::uint32_t*, std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t range(std::uint32_t*, std::int32_t*, std::size_t, std::int32_t, std::uint32_t) { return 0; }
+    static GOBLIB_INLINE std::size_t real(std::uint32_t*, float*, std::size_t, float, float) { return 0; }
+};
+
+#if defined(GOBLIB_RANDOM_SSE2)
+template<> struct RandomLanes<true>
+{
+    static GOBLIB_INLINE __m128i rotl(const __m128i x, const int k)
+    {
+        return _mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k));
+    }
+    struct State
+    {
+        __m128i s0, s1, s2, s3;
+        explicit State(const std::uint32_t* s)
+                : s0(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)))
+                , s1(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 4)))
+                , s2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 8)))
+                , s3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 12)))
+        {}
+        void store(std::uint32_t* s) const
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s), s0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s + 4), s1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s + 8), s2);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s + 12), s3);
+        }
+        GOBLIB_INLINE __m128i next()
+        {
+            const __m128i r = _mm_add_epi32(rotl(_mm_add_epi32(s0, s3), 7), s0);
+            const __m128i t = _mm_slli_epi32(s1, 9);
+            s2 = _mm_xor_si128(s2, s0);
+            s3 = _mm_xor_si128(s3, s1);
+            s1 = _mm_xor_si128(s1, s2);
+            s0 = _mm_xor_si128(s0, s3);
+            s2 = _mm_xor_si128(s2, t);
+            s3 = rotl(s3, 11);
+            return r;
+        }
+    };
+    static std::size_t bits(std::uint32_t* s, std::uint32_t* out, const std::size_t n)
+    {
+        State st(s);
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4) { _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), st.next()); }
+        st.store(s);
+        return i;
+    }
+    static std::size_t range(std::uint32_t* s, std::int32_t* out, const std::size_t n, const std::int32_t a, const std::uint32_t r)
+    {
+        State st(s);
+        const __m128i vr = _mm_set1_epi32(static_cast<int>(r));
+        const __m128i va = _mm_set1_epi32(a);
+        const __m128i odd = _mm_set_epi32(-1, 0, -1, 0);
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+            const __m128i x = st.next();
+            const __m128i e = _mm_srli_epi64(_mm_mul_epu32(x, vr), 32);
+            const __m128i o = _mm_and_si128(_mm_mul_epu32(_mm_srli_epi64(x, 32), vr), odd);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(va, _mm_or_si128(e, o)));
+        }
+        st.store(s);
+        return i;
+    }
+    static std::size_t real(std::uint32_t* s, float* out, const std::size_t n, const float a, const float b)
+    {
+        State st(s);
+        const __m128 scale = _mm_set1_ps((b - a) * (1.0f / 16777216.0f));
+        const __m128 va = _mm_set1_ps(a);
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+            const __m128 u = _mm_cvtepi32_ps(_mm_srli_epi32(st.next(), 8));
+            _mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(u, scale)));
+        }
+        st.store(s);
+        return i;
+    }
+};
+#elif defined(GOBLIB_RANDOM_NEON)
+template<> struct RandomLanes<true>
+{
+    struct State
+    {
+        uint32x4_t s0, s1, s2, s3;
+        explicit State(const std::uint32_t* s) : s0(vld1q_u32(s)), s1(vld1q_u32(s + 4)), s2(vld1q_u32(s + 8)), s3(vld1q_u32(s + 12)) {}
+        void store(std::uint32_t* s) const
+        {
+            vst1q_u32(s, s0);
+            vst1q_u32(s + 4, s1);
+            vst1q_u32(s + 8, s2);
+            vst1q_u32(s + 12, s3);
+        }
+        GOBLIB_INLINE uint32x4_t next()
+        {
+            const uint32x4_t x = vaddq_u32(s0, s3);
+            const uint32x4_t r = vaddq_u32(vsriq_n_u32(vshlq_n_u32(x, 7), x, 25), s0);
+            const uint32x4_t t = vshlq_n_u32(s1, 9);
+            s2 = veorq_u32(s2, s0);
+            s3 = veorq_u32(s3, s1);
+            s1 = veorq_u32(s1, s2);
+            s0 = veorq_u32(s0, s3);
+            s2 = veorq_u32(s2, t);
+            s3 = vsriq_n_u32(vshlq_n_u32(s3, 11), s3, 21);
+            return r;
+        }
+    };
+    static std::size_t bits(std::uint32_t* s, std::uint32_t* out, const std::size_t n)
+    {
+        State st(s);
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4) { vst1q_u32(out + i, st.next()); }
+        st.store(s);
+        return i;
+    }
+    static std::size_t range(std::uint32_t* s, std::int32_t* out, const std::size_t n, const std::int32_t a, const std::uint32_t r)
+    {
+        State st(s);
+        const uint32x2_t vr = vdup_n_u32(r);
+        const int32x4_t va = vdupq_n_s32(a);
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+            const uint32x4_t x = st.next();
+            const uint32x4_t h = vcombine_u32(vshrn_n_u64(vmull_u32(vget_low_u32(x), vr), 32),
+                                              vshrn_n_u64(vmull_u32(vget_high_u32(x), vr), 32));
+            vst1q_s32(out + i, vaddq_s32(va, vreinterpretq_s32_u32(h)));
+        }
+        st.store(s);
+        return i;
+    }
+    static std::size_t real(std::uint32_t* s, float* out, const std::size_t n, const float a, const float b)
+    {
+        State st(s);
+        const float32x4_t scale = vdupq_n_f32((b - a) * (1.0f / 16777216.0f));
+        const float32x4_t va = vdupq_n_f32(a);
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+            const float32x4_t u = vcvtq_f32_u32(vshrq_n_u32(st.next(), 8));
+            vst1q_f32(out + i, vmlaq_f32(va, u, scale));
+        }
+        st.store(s);
+        return i;
+    }
+};
+#endif
+
+#if defined(GOBLIB_RANDOM_SSE2) || defined(GOBLIB_RANDOM_NEON)
+constexpr bool random_simd = true;
+#else
+constexpr bool random_simd = false;
+#endif
+//
+}
+/// @endcond
+
+/*!
+  @brief Four lanes of xoshiro128++ for bulk generation.
+  @details Each lane is an independent stream (2^64 steps apart by jump()). Output is interleaved by lane.
+  Uses SSE2 or NEON if available.
+  @note Integer range uses multiply-shift without rejection. Bias is less than (b - a + 1) / 2^32.
+  @note Not an engine for Rng. Use Xoshiro128pp for single values.
+*/
+class Xoshiro128ppX4
+{
+  public:
+    constexpr static std::size_t LANES = 4;
+
+    explicit Xoshiro128ppX4(const std::uint64_t s = Xoshiro128pp::default_seed) { seed(s); }
+
+    void seed(const std::uint64_t s = Xoshiro128pp::default_seed)
+    {
+        Xoshiro128pp e(s);
+        for(std::size_t l = 0; l < LANES; ++l)
+        {
+            for(std::size_t k = 0; k < 4; ++k) { _s[k * LANES + l] = e._s[k]; }
+            e.jump();
+        }
+    }
+
+    /*! @brief Fill raw 32 bits */
+    void fill(std::uint32_t* out, const std::size_t n)
+    {
+        std::size_t i = detail::RandomLanes<detail::random_simd>::bits(_s, out, n);
+        while(i < n) { out[i] = next(i); ++i; }
+    }
+    /*! @brief Fill integer in [a, b] */
+    void fill(std::int32_t* out, const std::size_t n, const std::int32_t a, const std::int32_t b)
+    {
+        assert(a <= b && "a must be less than or equal b");
+        const std::uint32_t r = static_cast<std::uint32_t>(b) - static_cast<std::uint32_t>(a) + 1U; // 0 means full range
+        if(!r)
+        {
+            fill(reinterpret_cast<std::uint32_t*>(out), n);
+            return;
+        }
+        std::size_t i = detail::RandomLanes<detail::random_simd>::range(_s, out, n, a, r);
+        for(; i < n; ++i)
+        {
+            out[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(a) +
+                                               static_cast<std::uint32_t>((static_cast<std::uint64_t>(next(i)) * r) >> 32));
+        }
+    }
+    /*! @brief Fill float in [a, b) */
+    void fill(float* out, const std::size_t n, const float a, const float b)
+    {
+        std::size_t i = detail::RandomLanes<detail::random_simd>::real(_s, out, n, a, b);
+        const float scale = (b - a) * (1.0f / 16777216.0f);
+        for(; i < n; ++i) { out[i] = a + static_cast<float>(next(i) >> 8) * scale; }
+    }
+
+  private:
+    // Scalar step of lane (i % LANES). Lanes are stepped once per LANES outputs.
+    std::uint32_t next(const std::size_t i)
+    {
+        const std::size_t l = i % LANES;
+        std::uint32_t& s0 = _s[l];
+        std::uint32_t& s1 = _s[LANES + l];
+        std::uint32_t& s2 = _s[LANES * 2 + l];
+        std::uint32_t& s3 = _s[LANES * 3 + l];
+        const std::uint32_t r = rotl(s0 + s3, 7) + s0;
+        const std::uint32_t t = s1 << 9;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotl(s3, 11);
+        return r;
+    }
+    GOBLIB_INLINE static std::uint32_t rotl(const std::uint32_t x, const int k) { return (x << k) | (x >> (32 - k)); }
+
+    std::uint32_t _s[4 * LANES]; // s0[LANES], s1[LANES], s2[LANES], s3[LANES]
+};
+
+/// @cond
+template<class Engine> constexpr bool Rng<Engine>::FULL;
+/// @endcond
+
+//
+
 }
 #endif
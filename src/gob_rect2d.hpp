@@ -102,7 +102,7 @@ template<typename T> class Rectangle
     constexpr GOBLIB_INLINE bool overlaps(const Rectangle& r) const
     {
         return valid() && r.valid() &&
-                right() >= r.left() && r.right() >= left() && bottom() >= r.top() && r.bottom() > top();
+                right() >= r.left() && r.right() >= left() && bottom() >= r.top() && r.bottom() >= top();
     }
     /// @}
 
@@ -0,0 +1,406 @@
+/*!
+  Goblin Library
+
+  @file   gob_rect2d_array.hpp
+  @brief  Structure-of-arrays container of rectangles with batch hit-test.
+*/
+#pragma once
+#ifndef GOBLIB_RECT2D_ARRAY_HPP
+#define GOBLIB_RECT2D_ARRAY_HPP
+
+#include "gob_macro.hpp"
+#include "gob_point2d.hpp"
+#include "gob_rect2d.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include <cassert>
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+/// @cond
+#if !defined(GOBLIB_RECT_ARRAY_NO_SIMD)
+# if defined(__AVX2__)
+#   define GOBLIB_RECT_ARRAY_AVX2
+#   include <immintrin.h>
+# elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define GOBLIB_RECT_ARRAY_SSE2
+#   include <emmintrin.h>
+# elif defined(__ARM_NEON)
+#   define GOBLIB_RECT_ARRAY_NEON
+#   include <arm_neon.h>
+# endif
+#endif
+/// @endcond
+
+namespace goblib { namespace shape2d {
+
+/// @cond
+namespace detail
+{
+GOBLIB_INLINE int count_trailing_zero(const std::uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(v);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, v);
+    return static_cast<int>(idx);
+#else
+    int n = 0;
+    while(!(v & (1U << n))) { ++n; }
+    return n;
+#endif
+}
+
+// Lane operations (lt returns lane mask of a < b, bits returns the mask as integer)
+template<typename T> struct RectLanes { constexpr static bool enable = false; };
+
+#if defined(GOBLIB_RECT_ARRAY_AVX2)
+template<> struct RectLanes<std::int32_t>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 8;
+    using V = __m256i; using M = __m256i;
+    static GOBLIB_INLINE V load(const std::int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static GOBLIB_INLINE V splat(const std::int32_t v) { return _mm256_set1_epi32(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return _mm256_cmpgt_epi32(b, a); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return _mm256_or_si256(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m))); }
+};
+template<> struct RectLanes<std::int16_t>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 16;
+    using V = __m256i; using M = __m256i;
+    static GOBLIB_INLINE V load(const std::int16_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static GOBLIB_INLINE V splat(const std::int16_t v) { return _mm256_set1_epi16(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return _mm256_cmpgt_epi16(b, a); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return _mm256_or_si256(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m)
+    {
+        // Pack to 8bit (per 128bit lane), then gather the low quadwords.
+        const __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi16(m, _mm256_setzero_si256()), 0xD8);
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(p)) & 0xFFFFU;
+    }
+};
+template<> struct RectLanes<float>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 8;
+    using V = __m256; using M = __m256;
+    static GOBLIB_INLINE V load(const float* p) { return _mm256_loadu_ps(p); }
+    static GOBLIB_INLINE V splat(const float v) { return _mm256_set1_ps(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return _mm256_or_ps(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m) { return static_cast<std::uint32_t>(_mm256_movemask_ps(m)); }
+};
+
+#elif defined(GOBLIB_RECT_ARRAY_SSE2)
+template<> struct RectLanes<std::int32_t>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 4;
+    using V = __m128i; using M = __m128i;
+    static GOBLIB_INLINE V load(const std::int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static GOBLIB_INLINE V splat(const std::int32_t v) { return _mm_set1_epi32(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return _mm_cmplt_epi32(a, b); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return _mm_or_si128(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m) { return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(m))); }
+};
+template<> struct RectLanes<std::int16_t>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 8;
+    using V = __m128i; using M = __m128i;
+    static GOBLIB_INLINE V load(const std::int16_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static GOBLIB_INLINE V splat(const std::int16_t v) { return _mm_set1_epi16(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return _mm_cmplt_epi16(a, b); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return _mm_or_si128(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m) { return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(m, _mm_setzero_si128()))) & 0xFFU; }
+};
+template<> struct RectLanes<float>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 4;
+    using V = __m128; using M = __m128;
+    static GOBLIB_INLINE V load(const float* p) { return _mm_loadu_ps(p); }
+    static GOBLIB_INLINE V splat(const float v) { return _mm_set1_ps(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return _mm_cmplt_ps(a, b); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return _mm_or_ps(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m) { return static_cast<std::uint32_t>(_mm_movemask_ps(m)); }
+};
+
+#elif defined(GOBLIB_RECT_ARRAY_NEON)
+GOBLIB_INLINE std::uint32_t neon_bits(const uint32x4_t m)
+{
+    static const std::uint32_t w[4] = { 1, 2, 4, 8 };
+    const uint32x4_t v = vandq_u32(m, vld1q_u32(w));
+# if defined(__aarch64__)
+    return vaddvq_u32(v);
+# else
+    const uint32x2_t s = vpadd_u32(vget_low_u32(v), vget_high_u32(v));
+    return vget_lane_u32(vpadd_u32(s, s), 0);
+# endif
+}
+template<> struct RectLanes<std::int32_t>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 4;
+    using V = int32x4_t; using M = uint32x4_t;
+    static GOBLIB_INLINE V load(const std::int32_t* p) { return vld1q_s32(p); }
+    static GOBLIB_INLINE V splat(const std::int32_t v) { return vdupq_n_s32(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return vcltq_s32(a, b); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return vorrq_u32(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m) { return neon_bits(m); }
+};
+template<> struct RectLanes<std::int16_t>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 8;
+    using V = int16x8_t; using M = uint16x8_t;
+    static GOBLIB_INLINE V load(const std::int16_t* p) { return vld1q_s16(p); }
+    static GOBLIB_INLINE V splat(const std::int16_t v) { return vdupq_n_s16(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return vcltq_s16(a, b); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return vorrq_u16(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m)
+    {
+        static const std::uint16_t w[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+        const uint16x8_t v = vandq_u16(m, vld1q_u16(w));
+# if defined(__aarch64__)
+        return vaddvq_u16(v);
+# else
+        const uint32x4_t s = vpaddlq_u16(v);
+        const uint32x2_t t = vpadd_u32(vget_low_u32(s), vget_high_u32(s));
+        return vget_lane_u32(vpadd_u32(t, t), 0);
+# endif
+    }
+};
+template<> struct RectLanes<float>
+{
+    constexpr static bool enable = true;
+    constexpr static std::size_t WIDTH = 4;
+    using V = float32x4_t; using M = uint32x4_t;
+    static GOBLIB_INLINE V load(const float* p) { return vld1q_f32(p); }
+    static GOBLIB_INLINE V splat(const float v) { return vdupq_n_f32(v); }
+    static GOBLIB_INLINE M lt(const V a, const V b) { return vcltq_f32(a, b); }
+    static GOBLIB_INLINE M or_(const M a, const M b) { return vorrq_u32(a, b); }
+    static GOBLIB_INLINE std::uint32_t bits(const M m) { return neon_bits(m); }
+};
+#endif
+
+// Scalar kernels. (Return processed count)
+template<typename T, bool SIMD> struct RectKernel
+{
+    static GOBLIB_INLINE std::size_t overlap(std::uint32_t*, const T*, const T*, const T*, const T*, const std::size_t, const T, const T, const T, const T) { return 0; }
+    static GOBLIB_INLINE std::size_t contain(std::uint32_t*, const T*, const T*, const T*, const T*, const std::size_t, const T, const T) { return 0; }
+};
+
+// SIMD kernels. (Process per 32 elements = 1 word of mask)
+template<typename T> struct RectKernel<T, true>
+{
+    using L = RectLanes<T>;
+    static_assert(32 % L::WIDTH == 0, "Illegal lane width");
+    constexpr static std::uint32_t LANE_MASK = static_cast<std::uint32_t>((1ULL << L::WIDTH) - 1);
+
+    static std::size_t overlap(std::uint32_t* mask, const T* l, const T* t, const T* r, const T* b, const std::size_t n,
+                               const T ql, const T qt, const T qr, const T qb)
+    {
+        const auto vl = L::splat(ql), vt = L::splat(qt), vr = L::splat(qr), vb = L::splat(qb);
+        std::size_t i = 0;
+        for(; i + 32 <= n; i += 32)
+        {
+            std::uint32_t w = 0;
+            for(std::size_t k = 0; k < 32; k += L::WIDTH)
+            {
+                const std::size_t j = i + k;
+                const auto fail = L::or_(L::or_(L::lt(L::load(r + j), vl), L::lt(vr, L::load(l + j))),
+                                         L::or_(L::lt(L::load(b + j), vt), L::lt(vb, L::load(t + j))));
+                w |= (~L::bits(fail) & LANE_MASK) << k;
+            }
+            mask[i / 32] = w;
+        }
+        return i;
+    }
+    static std::size_t contain(std::uint32_t* mask, const T* l, const T* t, const T* r, const T* b, const std::size_t n,
+                               const T px, const T py)
+    {
+        const auto vx = L::splat(px), vy = L::splat(py);
+        std::size_t i = 0;
+        for(; i + 32 <= n; i += 32)
+        {
+            std::uint32_t w = 0;
+            for(std::size_t k = 0; k < 32; k += L::WIDTH)
+            {
+                const std::size_t j = i + k;
+                const auto fail = L::or_(L::or_(L::lt(vx, L::load(l + j)), L::lt(L::load(r + j), vx)),
+                                         L::or_(L::lt(vy, L::load(t + j)), L::lt(L::load(b + j), vy)));
+                w |= (~L::bits(fail) & LANE_MASK) << k;
+            }
+            mask[i / 32] = w;
+        }
+        return i;
+    }
+};
+//
+}
+/// @endcond
+
+/*!
+  @brief Structure-of-arrays container of Rectangle for batch hit-test
+  @details Left, top, right and bottom are stored in separate contiguous arrays.
+  Tests one rectangle or point against all elements, results are a bitmask or a list of indices.<br>
+  std::int32_t, std::int16_t and float use AVX2, SSE2 or NEON if available, others use scalar comparisons.
+  Results are the same as Rectangle::overlaps and Rectangle::contains (invalid rectangles never hit).
+  @tparam T type of value.
+  @note Define GOBLIB_RECT_ARRAY_NO_SIMD to disable SIMD.
+*/
+template<typename T> class RectangleArray
+{
+    static_assert(goblib::is_fixed_point_number<T>::value || std::is_arithmetic<T>::value, "T must be arithmetic type");
+    using kernel = detail::RectKernel<T, detail::RectLanes<T>::enable>;
+
+  public:
+    using pos_type = T;
+
+    /// @name Constructor
+    /// @{
+    RectangleArray() : _l(), _t(), _r(), _b() {}
+    /// @}
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE std::size_t size() const { return _l.size(); }
+    GOBLIB_INLINE bool empty() const { return _l.empty(); }
+    /*! @brief Number of std::uint32_t required for mask */
+    GOBLIB_INLINE std::size_t maskWords() const { return (size() + 31) / 32; }
+    GOBLIB_INLINE const T* lefts() const { return _l.data(); }
+    GOBLIB_INLINE const T* tops() const { return _t.data(); }
+    GOBLIB_INLINE const T* rights() const { return _r.data(); }
+    GOBLIB_INLINE const T* bottoms() const { return _b.data(); }
+    /*! @brief Get rectangle (Invalid rectangle is returned as empty) */
+    Rectangle<T> operator[](const std::size_t i) const
+    {
+        return _l[i] > _r[i] ? Rectangle<T>() : Rectangle<T>(Point<T>(_l[i], _t[i]), Point<T>(_r[i], _b[i]));
+    }
+    /// @}
+
+    /// @name Modify
+    /// @{
+    void reserve(const std::size_t n) { _l.reserve(n); _t.reserve(n); _r.reserve(n); _b.reserve(n); }
+    void clear() { _l.clear(); _t.clear(); _r.clear(); _b.clear(); }
+    void push_back(const Rectangle<T>& r)
+    {
+        _l.push_back(T(0)); _t.push_back(T(0)); _r.push_back(T(0)); _b.push_back(T(0));
+        set(size() - 1, r);
+    }
+    void set(const std::size_t i, const Rectangle<T>& r)
+    {
+        if(r.valid())
+        {
+            _l[i] = r.left(); _t[i] = r.top(); _r[i] = r.right(); _b[i] = r.bottom();
+            return;
+        }
+        // Never hit
+        _l[i] = _t[i] = std::numeric_limits<T>::max();
+        _r[i] = _b[i] = std::numeric_limits<T>::lowest();
+    }
+    /// @}
+
+    /// @name Hit-test
+    /// @{
+    /*!
+      @brief Bitmask of elements overlapping r
+      @param r Rectangle
+      @param[out] mask Bit i is set if element i overlaps r (maskWords() words)
+    */
+    void overlapMask(const Rectangle<T>& r, std::uint32_t* mask) const
+    {
+        if(!r.valid()) { clearMask(mask); return; }
+        const T ql = r.left(), qt = r.top(), qr = r.right(), qb = r.bottom();
+        const std::size_t n = size();
+        const T* lp = lefts(); const T* tp = tops(); const T* rp = rights(); const T* bp = bottoms();
+        std::size_t i = kernel::overlap(mask, lp, tp, rp, bp, n, ql, qt, qr, qb);
+        for(; i < n; ++i)
+        {
+            if(!(i & 31)) { mask[i / 32] = 0; }
+            const bool hit = !(rp[i] < ql) && !(qr < lp[i]) && !(bp[i] < qt) && !(qb < tp[i]);
+            mask[i / 32] |= static_cast<std::uint32_t>(hit) << (i & 31);
+        }
+    }
+    /*!
+      @brief Bitmask of elements containing p
+      @param p Point
+      @param[out] mask Bit i is set if element i contains p (maskWords() words)
+    */
+    void containMask(const Point<T>& p, std::uint32_t* mask) const
+    {
+        const T px = p.x(), py = p.y();
+        const std::size_t n = size();
+        const T* lp = lefts(); const T* tp = tops(); const T* rp = rights(); const T* bp = bottoms();
+        std::size_t i = kernel::contain(mask, lp, tp, rp, bp, n, px, py);
+        for(; i < n; ++i)
+        {
+            if(!(i & 31)) { mask[i / 32] = 0; }
+            const bool hit = !(px < lp[i]) && !(rp[i] < px) && !(py < tp[i]) && !(bp[i] < py);
+            mask[i / 32] |= static_cast<std::uint32_t>(hit) << (i & 31);
+        }
+    }
+    /*!
+      @brief Indices of elements overlapping r
+      @param r Rectangle
+      @param[out] out Indices in ascending order (size() elements required)
+      @return Number of indices
+    */
+    std::size_t overlapIndices(const Rectangle<T>& r, std::uint32_t* out) const
+    {
+        return compact(out, [this, &r](std::uint32_t* m) { overlapMask(r, m); });
+    }
+    /*!
+      @brief Indices of elements containing p
+      @param p Point
+      @param[out] out Indices in ascending order (size() elements required)
+      @return Number of indices
+    */
+    std::size_t containIndices(const Point<T>& p, std::uint32_t* out) const
+    {
+        return compact(out, [this, &p](std::uint32_t* m) { containMask(p, m); });
+    }
+    /// @}
+
+  private:
+    GOBLIB_INLINE void clearMask(std::uint32_t* mask) const
+    {
+        for(std::size_t i = 0; i < maskWords(); ++i) { mask[i] = 0; }
+    }
+    // Make mask per block and expand to indices.
+    template<class F> std::size_t compact(std::uint32_t* out, F fill) const
+    {
+        const std::size_t words = maskWords();
+        if(!words) { return 0; }
+        // Use the tail of out as work. Indices written never reach the unread words (size() >= 32 * (words - 1) + 1).
+        std::uint32_t* mask = out + size() - words;
+        fill(mask);
+        std::size_t cnt = 0;
+        for(std::size_t w = 0; w < words; ++w)
+        {
+            std::uint32_t bits = mask[w];
+            const std::uint32_t base = static_cast<std::uint32_t>(w * 32);
+            while(bits)
+            {
+                out[cnt++] = base + static_cast<std::uint32_t>(detail::count_trailing_zero(bits));
+                bits &= bits - 1;
+            }
+        }
+        return cnt;
+    }
+
+    std::vector<T> _l, _t, _r, _b;
+};
+
+//
+}}
+#endif
@@ -9,8 +9,119 @@
 
 namespace goblib { namespace graph {
 
+constexpr std::uint16_t RenderCommand2D::IMMEDIATE;
+constexpr std::uint8_t RenderCommand2D::FLIP_H;
+constexpr std::uint8_t RenderCommand2D::FLIP_V;
+constexpr std::size_t Renderer2D::MAX_DIRTY_RECTS;
+
+void RenderCommandBuffer2D::sort()
+{
+    // seq makes it stable without buffer of std::stable_sort.
+    std::sort(_commands.begin(), _commands.end(), [](const RenderCommand2D& a, const RenderCommand2D& b)
+    {
+        if(a.zorder != b.zorder) { return a.zorder > b.zorder; }
+        if(a.texture != b.texture) { return a.texture < b.texture; }
+        return a.seq < b.seq;
+    });
+}
+
+void Renderer2D::renderCommands(void* arg)
+{
+    _commands.clear();
+    _immediate.clear();
+    for(auto& e : _objects)
+    {
+        if(e->_culled || e->emit(_commands)) { continue; }
+        assert(_immediate.size() < RenderCommand2D::IMMEDIATE && "Too many immediate objects");
+        _commands.push(e->zorder(), RenderCommand2D::IMMEDIATE, static_cast<std::uint16_t>(_immediate.size()), 0, 0);
+        _immediate.push_back(e);
+    }
+    _commands.sort();
+
+    const RenderCommand2D* cmd = _commands.data();
+    std::size_t sz = _commands.size();
+    std::size_t i = 0;
+    while(i < sz)
+    {
+        if(cmd[i].texture == RenderCommand2D::IMMEDIATE)
+        {
+            _immediate[cmd[i].cell]->render(arg);
+            ++i;
+            continue;
+        }
+        std::size_t j = i + 1;
+        while(j < sz && cmd[j].texture == cmd[i].texture) { ++j; }
+        _backend(cmd + i, j - i, arg);
+        i = j;
+    }
+}
+
+// Cull objects and collect dirty rectangles.
+void Renderer2D::prepare()
+{
+    _dirtyRects.clear();
+    if(_viewport.empty())
+    {
+        for(auto& e : _objects) { e->_culled = !e->visible(); }
+        return;
+    }
+
+    for(auto& r : _invalid) { addDirty(r); }
+    _invalid.clear();
+
+    RectType b;
+    for(auto& e : _objects)
+    {
+        if(!e->bounds(b)) { b = _viewport; }
+        bool draw = e->visible() && b.overlaps(_viewport);
+        if(draw)
+        {
+            if(!e->_drawn || e->_dirty || b != e->_drawnBounds)
+            {
+                if(e->_drawn) { addDirty(e->_drawnBounds); }
+                addDirty(b);
+            }
+            e->_drawnBounds = b;
+        }
+        else if(e->_drawn) { addDirty(e->_drawnBounds); }
+        e->_drawn = draw;
+        e->_dirty = false;
+        e->_culled = !draw;
+    }
+}
+
+// Add rectangle clipped by viewport, merging overlapped rectangles.
+void Renderer2D::addDirty(RectType r)
+{
+    r &= _viewport;
+    if(r.empty()) { return; }
+
+    auto it = _dirtyRects.begin();
+    while(it != _dirtyRects.end())
+    {
+        if(it->contains(r)) { return; }
+        if(it->overlaps(r))
+        {
+            r |= *it;
+            _dirtyRects.erase(it);
+            it = _dirtyRects.begin(); // Merged rectangle may overlap others.
+            continue;
+        }
+        ++it;
+    }
+    _dirtyRects.push_back(r);
+
+    if(_dirtyRects.size() > MAX_DIRTY_RECTS)
+    {
+        RectType u = dirtyBounds();
+        _dirtyRects.clear();
+        _dirtyRects.push_back(u);
+    }
+}
+
 void Renderer2D::print()
 {
+    compact(); // Removed objects may be deleted already.
     printf("Renderer: %zu\n", size());
     for(auto& e : _objects)
     {
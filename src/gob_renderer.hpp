@@ -9,18 +9,82 @@
 #define GOB_RENDERER_HPP
 
 #include <gob_macro.hpp>
+#include <gob_allocator.hpp>
+#include <gob_rect2d.hpp>
+#include <gob_trace.hpp>
 #include <cstdint>
 #include <vector>
-#include <algorithm> // std::sort
+#include <algorithm> // std::upper_bound, std::stable_sort
+#include <functional>
 #include <cassert>
 
 namespace goblib { namespace graph {
 
+/*!
+  @brief Compact draw command (POD)
+  @details Emitted by RenderObj2D::emit() and passed to backend of Renderer2D in batches of same texture.
+*/
+struct RenderCommand2D
+{
+    constexpr static std::uint16_t IMMEDIATE = 0xFFFF; //!< Texture id of object that is rendered by RenderObj2D::render
+    constexpr static std::uint8_t FLIP_H = 0x01;
+    constexpr static std::uint8_t FLIP_V = 0x02;
+
+    std::uint32_t zorder;   //!< Greater is rendered first
+    std::uint32_t seq;      //!< Order of emission (Set by RenderCommandBuffer2D)
+    std::int16_t x, y;      //!< Position
+    std::uint16_t texture;  //!< Texture or sheet id
+    std::uint16_t cell;     //!< Cell in texture
+    std::uint8_t flip;      //!< FLIP_H | FLIP_V
+    std::uint8_t param;     //!< Free for backend
+};
+
+/*! @brief Command buffer for a frame */
+class RenderCommandBuffer2D
+{
+  public:
+    explicit RenderCommandBuffer2D(std::size_t reserve) : _commands(reserve) { _commands.clear(); }
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE std::size_t size() const { return _commands.size(); }
+    GOBLIB_INLINE bool empty() const { return _commands.empty(); }
+    GOBLIB_INLINE const RenderCommand2D* data() const { return _commands.data(); }
+    GOBLIB_INLINE const RenderCommand2D& operator[](std::size_t i) const { return _commands[i]; }
+    GOBLIB_INLINE std::vector<RenderCommand2D>::const_iterator begin() const { return _commands.begin(); }
+    GOBLIB_INLINE std::vector<RenderCommand2D>::const_iterator end() const { return _commands.end(); }
+    /// @}
+
+    /// @name Emit
+    /// @{
+    GOBLIB_INLINE void push(const RenderCommand2D& c)
+    {
+        _commands.push_back(c);
+        _commands.back().seq = static_cast<std::uint32_t>(_commands.size() - 1);
+    }
+    GOBLIB_INLINE void push(const std::uint32_t zorder, const std::uint16_t texture, const std::uint16_t cell,
+                            const std::int16_t x, const std::int16_t y, const std::uint8_t flip = 0, const std::uint8_t param = 0)
+    {
+        push(RenderCommand2D{ zorder, 0, x, y, texture, cell, flip, param });
+    }
+    /// @}
+
+    GOBLIB_INLINE void clear() { _commands.clear(); }
+    /*! @brief Exchange commands (For double buffering. e.g. App::swapRenderState) */
+    GOBLIB_INLINE void swap(RenderCommandBuffer2D& o) { _commands.swap(o._commands); }
+    /*! @brief Sort by greater zorder, texture, and order of emission */
+    void sort();
+
+  private:
+    std::vector<RenderCommand2D> _commands;
+};
+
 /*! @brief Rendering interface */
 class RenderObj2D
 {
   public:
     using OrderType = std::uint32_t;
+    using RectType = goblib::shape2d::Rectangle<std::int32_t>;
 
     virtual ~RenderObj2D(){}
 
@@ -35,67 +99,203 @@ class RenderObj2D
 
     GOBLIB_INLINE std::uint32_t zorder() const { return _zorder; }
 
+    /*! @brief Content changed without change of bounds (For dirty rectangle) */
+    GOBLIB_INLINE void markDirty() { _dirty = true; }
+
     /// @name Override
     /// @{
     virtual void render(void* arg) = 0;
+    /*!
+      @brief Emit commands instead of render (When Renderer2D has backend)
+      @retval true Emitted. render() is not called.
+      @retval false Not supported. render() is called.
+    */
+    virtual bool emit(RenderCommandBuffer2D& /*buffer*/) { return false; }
+    /*!
+      @brief Bounds on screen (For culling and dirty rectangle)
+      @retval true out is bounds.
+      @retval false Not supported. Treated as whole of viewport.
+    */
+    virtual bool bounds(RectType& /*out*/) const { return false; }
     /// @}
 
   protected:
-    explicit RenderObj2D(OrderType order = 0) : _zorder(order), _visible(true) {}
+    explicit RenderObj2D(OrderType order = 0)
+            : _zorder(order), _visible(true), _drawn(false), _dirty(false), _culled(false), _drawnBounds() {}
     
   private:
+    friend class Renderer2D; // Renderer2D::changeZorder, dirty rectangle
     OrderType _zorder;
     bool _visible;
+    bool _drawn, _dirty, _culled;   // Managed by Renderer2D
+    RectType _drawnBounds;          // Bounds at last render
 };
 
-/*! @brief Renderer for RenderObj2D */
+/*!
+  @brief Renderer for RenderObj2D
+  @details Objects are kept in order of greater zorder. Objects that have same zorder are rendered in order of insertion.<br>
+  insert() and changeZorder() place the object by binary search. remove() is batched, and removed objects are compacted
+  in one pass before next insert(), changeZorder() or zsort() (render).<br>
+  If backend is set, render() collects commands by RenderObj2D::emit(), sorts them by (zorder, texture),
+  and calls backend for each run of same texture. Objects that do not emit are rendered by RenderObj2D::render()
+  at their position in order (after commands of same zorder).<br>
+  If viewport is set, objects that do not overlap it are culled, and rectangles changed since last render
+  are collected to dirtyRects() before rendering. Changes are detected by RenderObj2D::bounds(), visibility,
+  insert, remove, changeZorder and RenderObj2D::markDirty().
+*/
 class Renderer2D
 {
     constexpr static std::size_t RESERVE = 64;
 
   public:
+    using RectType = RenderObj2D::RectType;
+    constexpr static std::size_t MAX_DIRTY_RECTS = 8; //!< Dirty rectangles are merged into one if exceeded.
+
+    /*! @brief Backend receives commands of same texture. (commands, number of commands, arg of render) */
+    using Backend = std::function<void(const RenderCommand2D*, std::size_t, void*)>;
+
     /*! @param reserve Reserve size for registration of rendering objectes */
     explicit Renderer2D(std::size_t reserve = RESERVE)
-            : _objects(reserve), _initializedSize(reserve), _dirty(false)
-    { _objects.clear(); }
+            : _objects(reserve), _removed(), _initializedSize(reserve), _allocator(nullptr)
+            , _backend(), _commands(reserve), _immediate(reserve), _viewport(), _dirtyRects(), _invalid()
+    { _objects.clear(); _immediate.clear(); }
     virtual ~Renderer2D() {}
 
-    std::size_t size() const { return _objects.size(); }
+    std::size_t size() const { return _objects.size() - _removed.size(); }
 
+    /*! @brief Insert after objects that have same zorder */
     void insert(RenderObj2D* o)
     {
+        assert(o);
+        compact(); // Removed objects may be deleted already, so they can not be compared.
 #ifdef DEBUG
         auto it = std::find_if(_objects.begin(), _objects.end(), [&o](RenderObj2D* p) { return p == o; });
         assert(it == _objects.end() && "RenderObj2D already inserted");
 #endif
-        _objects.push_back(o); _dirty = true;
+        _objects.insert(std::upper_bound(_objects.begin(), _objects.end(), o, compare_greater), o);
 
         assert(_objects.size() <= _initializedSize && "Expnad occur!");
     }
 
+    /*!
+      @brief Remove
+      @details Compacted at next insert, changeZorder or zsort. o need not be alive after this.
+      @warning o must be inserted.
+    */
     void remove(RenderObj2D* o)
     {
-        auto it = std::remove_if(_objects.begin(), _objects.end(), [&o](RenderObj2D* p) { return p == o; });
-        _objects.erase(it, _objects.end());
+#ifdef DEBUG
+        auto ot = std::find_if(_objects.begin(), _objects.end(), [&o](RenderObj2D* p) { return p == o; });
+        assert(ot != _objects.end() && "RenderObj2D not inserted");
+#endif
+        auto it = std::lower_bound(_removed.begin(), _removed.end(), o, std::less<RenderObj2D*>());
+        if(it == _removed.end() || *it != o) { _removed.insert(it, o); }
+        if(o->_drawn) { invalidate(o->_drawnBounds); o->_drawn = false; }
     }
 
-    void clear() { _objects.clear(); _dirty = false; }
+    void clear() { _objects.clear(); _removed.clear(); invalidate(); }
 
-    void zsort(bool force = false)
+    /*!
+      @brief Change zorder of object
+      @details Object is moved to after objects that have the new zorder.
+    */
+    void changeZorder(RenderObj2D* o, const RenderObj2D::OrderType z)
     {
-        if(_dirty || force)
+        assert(o);
+        compact();
+        auto it = findObject(o);
+        if(it == _objects.end()) { o->_zorder = z; return; }
+        if(o->_zorder == z) { return; }
+
+        o->_dirty = true;
+        bool up = z > o->_zorder;
+        o->_zorder = z;
+        if(up)
+        {
+            auto pos = std::upper_bound(_objects.begin(), it, o, compare_greater);
+            std::rotate(pos, it, it + 1);
+        }
+        else
         {
-            std::sort(_objects.begin(), _objects.end(), compare_greater);
-            _dirty = false;
+            auto pos = std::upper_bound(it + 1, _objects.end(), o, compare_greater);
+            std::rotate(it, it + 1, pos);
         }
     }
 
+    /// @name Allocator
+    /// @{
+    /*! @brief Set allocator for create() */
+    GOBLIB_INLINE void setAllocator(SlabAllocator* a) { _allocator = a; }
+    GOBLIB_INLINE SlabAllocator* allocator() const { return _allocator; }
+    /*!
+      @brief Create U by allocator and insert
+      @retval != nullptr Created object
+      @retval == nullptr No allocator or allocation failed.
+    */
+    template<class U, class... Args> U* create(Args&&... args)
+    {
+        static_assert(std::is_base_of<RenderObj2D, U>::value, "U must be derived of RenderObj2D");
+        assert(_allocator && "Allocator not set");
+        U* o = _allocator ? _allocator->create<U>(std::forward<Args>(args)...) : nullptr;
+        if(o) { insert(o); }
+        return o;
+    }
+    /*! @brief Remove and destroy if o was created by allocator */
+    void destroy(RenderObj2D* o)
+    {
+        remove(o);
+        if(_allocator && _allocator->owns(o)) { _allocator->destroy(o); }
+    }
+    /// @}
+
+    /*!
+      @brief Compact removed objects
+      @param force Sort all objects again (stable)
+    */
+    void zsort(bool force = false)
+    {
+        compact();
+        if(force) { std::stable_sort(_objects.begin(), _objects.end(), compare_greater); }
+    }
+
+    /// @name Viewport and dirty rectangle
+    /// @{
+    /*! @brief Set viewport. Empty rectangle disables culling and dirty rectangle */
+    void setViewport(const RectType& r) { _viewport = r; _invalid.clear(); invalidate(); }
+    GOBLIB_INLINE const RectType& viewport() const { return _viewport; }
+    /*! @brief Redraw whole of viewport at next render */
+    GOBLIB_INLINE void invalidate() { invalidate(_viewport); }
+    /*! @brief Redraw r at next render */
+    GOBLIB_INLINE void invalidate(const RectType& r) { if(!_viewport.empty()) { _invalid.push_back(r); } }
+    /*! @brief Changed rectangles in viewport (Updated at start of render, not overlapped each other) */
+    GOBLIB_INLINE const std::vector<RectType>& dirtyRects() const { return _dirtyRects; }
+    /*! @brief Union of dirtyRects() */
+    RectType dirtyBounds() const
+    {
+        RectType u;
+        for(auto& r : _dirtyRects) { u |= r; }
+        return u;
+    }
+    /// @}
+
+    /// @name Backend
+    /// @{
+    /*! @brief Set backend for command rendering. (nullptr: call RenderObj2D::render for each object) */
+    GOBLIB_INLINE void setBackend(Backend b) { _backend = std::move(b); }
+    GOBLIB_INLINE bool hasBackend() const { return static_cast<bool>(_backend); }
+    /*! @brief Commands of last render() */
+    GOBLIB_INLINE const RenderCommandBuffer2D& commands() const { return _commands; }
+    /// @}
+
     virtual void render(void* arg)
     {
+        GOBLIB_TRACE_SCOPE("Renderer2D::render");
         zsort();
+        prepare();
+        if(_backend) { renderCommands(arg); return; }
         for(auto& e : _objects)
         {
-            if(e->visible()) { e->render(arg); }
+            if(!e->_culled) { e->render(arg); }
         }
     }
 
@@ -105,12 +305,42 @@ class Renderer2D
     Renderer2D(const Renderer2D&) = delete;
     Renderer2D& operator=(const Renderer2D&) = delete;
 
+    void renderCommands(void* arg);
+    void prepare();
+    void addDirty(RectType r);
+
     static bool compare_greater(const RenderObj2D* left, const RenderObj2D* right) { return left->zorder() > right->zorder(); }
+
+    // Search o in range of same zorder.
+    std::vector<RenderObj2D*>::iterator findObject(RenderObj2D* o)
+    {
+        auto r = std::equal_range(_objects.begin(), _objects.end(), o, compare_greater);
+        auto it = std::find(r.first, r.second, o);
+        return it != r.second ? it : _objects.end();
+    }
+    // Erase removed objects in one pass. (Compare addresses only)
+    void compact()
+    {
+        if(_removed.empty()) { return; }
+        auto it = std::remove_if(_objects.begin(), _objects.end(), [this](RenderObj2D* p)
+        {
+            return std::binary_search(_removed.begin(), _removed.end(), p, std::less<RenderObj2D*>());
+        });
+        _objects.erase(it, _objects.end());
+        _removed.clear();
+    }
     
   private:
-    std::vector<RenderObj2D*> _objects;
+    std::vector<RenderObj2D*> _objects; // Sorted by greater zorder, stable.
+    std::vector<RenderObj2D*> _removed; // Sorted by address, removed but not compacted.
     const std::size_t _initializedSize;
-    bool _dirty;
+    SlabAllocator* _allocator;
+    Backend _backend;
+    RenderCommandBuffer2D _commands;
+    std::vector<RenderObj2D*> _immediate; // Objects that do not emit. (Index is cell of IMMEDIATE command)
+    RectType _viewport;
+    std::vector<RectType> _dirtyRects;
+    std::vector<RectType> _invalid; // Invalidated between renders.
 };
 
 //
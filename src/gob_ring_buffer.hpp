@@ -17,6 +17,9 @@
 #include <cstring>
 #include <cassert>
 #include <iterator>
+#include <atomic>
+#include <utility>
+#include <algorithm>
 #if defined(GOBLIB_CPP17_OR_LATER)
 #include <optional>
 #endif
@@ -24,54 +27,64 @@
 namespace goblib
 {
 
+/*! @brief Contiguous range in ring buffer */
+template<typename U> struct RingBufferSpan
+{
+    U* data;
+    std::size_t size;
+    GOBLIB_INLINE U* begin() const { return data; }
+    GOBLIB_INLINE U* end() const { return data + size; }
+};
+
 /// @cond
-template<class RB> class RingBufferIterator
+template<class RB, bool Const = true> class RingBufferIterator
 {
   public:
     using value_type = typename RB::value_type;
     using difference_type = std::ptrdiff_t;
-    using pointer = typename RB::value_type*;
-    using reference = typename RB::reference;
-    //    using iterator_category = std::random_access_iterator_tag;
-    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = typename std::conditional<Const, const value_type*, value_type*>::type;
+    using reference = typename std::conditional<Const, typename RB::const_reference, typename RB::reference>::type;
+    using iterator_category = std::random_access_iterator_tag;
 
-    RingBufferIterator(RB& rb, std::size_t tail) : _rb(&rb), _idx(tail) {}
+    RingBufferIterator() : _buf(nullptr), _idx(0) {}
+    // idx is position in [0, 2N), (tail + offset) that is not wrapped.
+    RingBufferIterator(pointer buf, std::size_t idx) : _buf(buf), _idx(idx) {}
     RingBufferIterator(const RingBufferIterator& o) = default;
     RingBufferIterator& operator=(const RingBufferIterator& o) = default;
-    
-    GOBLIB_INLINE typename RB::const_reference operator*() { return this->_rb->_buf[_idx % _rb->capacity()]; }
+    // iterator to const_iterator
+    template<bool C, typename std::enable_if<Const && !C, std::nullptr_t>::type = nullptr>
+    RingBufferIterator(const RingBufferIterator<RB, C>& o) : _buf(o._buf), _idx(o._idx) {}
+
+    GOBLIB_INLINE reference operator*() const { return _buf[_idx < RB::CAPACITY ? _idx : _idx - RB::CAPACITY]; }
+    GOBLIB_INLINE pointer operator->() const { return &**this; }
+    GOBLIB_INLINE reference operator[](difference_type n) const { return *(*this + n); }
 
     GOBLIB_INLINE RingBufferIterator& operator++() { ++_idx; return *this; }
     GOBLIB_INLINE RingBufferIterator& operator--() { --_idx; return *this; }
     GOBLIB_INLINE RingBufferIterator operator++(int) { RingBufferIterator it = *this; ++*this; return it; }
     GOBLIB_INLINE RingBufferIterator operator--(int) { RingBufferIterator it = *this; --*this; return it; }
 
-    GOBLIB_INLINE RingBufferIterator& operator+=(std::size_t n) { _idx += n; return *this; }
-    GOBLIB_INLINE RingBufferIterator& operator-=(std::size_t n) { _idx -= n; return *this; }
-    GOBLIB_INLINE RingBufferIterator operator+(std::size_t n) const
+    GOBLIB_INLINE RingBufferIterator& operator+=(difference_type n) { _idx += n; return *this; }
+    GOBLIB_INLINE RingBufferIterator& operator-=(difference_type n) { _idx -= n; return *this; }
+    GOBLIB_INLINE RingBufferIterator operator+(difference_type n) const { return RingBufferIterator(*this) += n; }
+    GOBLIB_INLINE RingBufferIterator operator-(difference_type n) const { return RingBufferIterator(*this) -= n; }
+    GOBLIB_INLINE friend RingBufferIterator operator+(difference_type n, const RingBufferIterator& it) { return it + n; }
+    GOBLIB_INLINE difference_type operator-(const RingBufferIterator& o) const
     {
-        return RingBufferIterator(*this) += n;
+        assert(_buf == o._buf && "Diffrent iterators of container");
+        return static_cast<difference_type>(_idx) - static_cast<difference_type>(o._idx);
     }
-    GOBLIB_INLINE RingBufferIterator operator-(std::size_t n) const
-    {
-        return RingBufferIterator(*this) -= n;
-    }
-    GOBLIB_INLINE std::size_t operator-(const RingBufferIterator& o)
-    {
-        assert(_rb == o._rb && "Diffrent iterators of container");
-        assert(_idx >= o._idx && "o must be lesser than this.");
-        return _idx - o._idx;
-    }
-    
-    GOBLIB_INLINE bool operator==(const RingBufferIterator& b) const { return (_rb == b._rb) && _idx == b._idx; }
+
+    GOBLIB_INLINE bool operator==(const RingBufferIterator& b) const { return (_buf == b._buf) && _idx == b._idx; }
     GOBLIB_INLINE bool operator<(const RingBufferIterator& b) const { return _idx < b._idx; }
     GOBLIB_INLINE bool operator!=(const RingBufferIterator& b) const { return !(*this == b); }
     GOBLIB_INLINE bool operator>(const RingBufferIterator& b) const { return b < (*this); }
     GOBLIB_INLINE bool operator<=(const RingBufferIterator& b) const { return !(*this > b); }
     GOBLIB_INLINE bool operator>=(const RingBufferIterator& b) const { return !(*this < b); }
-    
+
   private:
-    RB* _rb;
+    friend class RingBufferIterator<RB, !Const>;
+    pointer _buf;
     std::size_t _idx;
 };
 /// @endcond
@@ -95,8 +108,13 @@ template<typename T, std::size_t N> class RingBuffer
 #if defined(GOBLIB_CPP17_OR_LATER)
     using optional_type = std::optional<T>;
 #endif
-    friend class RingBufferIterator<RingBuffer>;
-    using const_iterator = RingBufferIterator<RingBuffer>;
+    using iterator = RingBufferIterator<RingBuffer, false>;
+    using const_iterator = RingBufferIterator<RingBuffer, true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using Span = RingBufferSpan<value_type>;
+    using ConstSpan = RingBufferSpan<const value_type>;
+    constexpr static size_type CAPACITY = N;
     
     /// @name Constructor
     /// @{
@@ -203,16 +221,13 @@ template<typename T, std::size_t N> class RingBuffer
         return !empty() ? _buf[(_head - 1 + N) % N] : T();
     }
 
-    #if 0
     /*! @brief Access specified element (R/W)*/
-    GOBLIB_INLINE reference operator[] (size_type i) const&
+    GOBLIB_INLINE reference operator[] (size_type i) &
     {
         assert(size() > 0 && "container empty");
         assert(i < size() && "index overflow");
         return _buf[ (_tail + i) % N ];
     }
-    #endif
-    
     /*! @brief Access specified element */
     GOBLIB_INLINE const_reference operator[] (size_type i) const&
     {
@@ -254,12 +269,46 @@ template<typename T, std::size_t N> class RingBuffer
     /// @}
 
     /// @name Iterators
-    /// @brief This class has const_iterator only.
+    /// @brief Random access iterators. Invalidated by push, pop and write.
     /// @{
-    const_iterator begin() noexcept { return const_iterator(*this, _tail); }
-    const_iterator end()   noexcept { return const_iterator(*this, _tail + size()); }
-    const_iterator cbegin()noexcept { return const_iterator(*this, _tail); }
-    const_iterator cend()  noexcept { return const_iterator(*this, _tail + size()); }
+    iterator begin() noexcept { return iterator(_buf.data(), _tail); }
+    iterator end()   noexcept { return iterator(_buf.data(), _tail + size()); }
+    const_iterator begin() const noexcept { return const_iterator(_buf.data(), _tail); }
+    const_iterator end()   const noexcept { return const_iterator(_buf.data(), _tail + size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend()   const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend()   noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend()   const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend()   const noexcept { return rend(); }
+    /// @}
+
+    /// @name Segments
+    /// @{
+    /*!
+      @brief Elements as two contiguous spans (first is older)
+      @details second is empty if elements are not wrapped.
+      @code
+      float sum = 0.0f;
+      auto sg = rb.segments();
+      for(auto& v : sg.first)  { sum += v; }
+      for(auto& v : sg.second) { sum += v; }
+      @endcode
+     */
+    std::pair<Span, Span> segments()
+    {
+        size_type sz = size();
+        size_type n1 = std::min(sz, N - _tail);
+        return std::make_pair(Span{ _buf.data() + _tail, n1 }, Span{ _buf.data(), sz - n1 });
+    }
+    std::pair<ConstSpan, ConstSpan> segments() const
+    {
+        size_type sz = size();
+        size_type n1 = std::min(sz, N - _tail);
+        return std::make_pair(ConstSpan{ _buf.data() + _tail, n1 }, ConstSpan{ _buf.data(), sz - n1 });
+    }
     /// @}
     
     /// @name Read,Write
@@ -351,6 +400,143 @@ template<typename T, std::size_t N> class RingBuffer
     bool _full;
 };
 
+template<typename T, std::size_t N> constexpr typename RingBuffer<T, N>::size_type RingBuffer<T, N>::CAPACITY;
+
+/*!
+  @brief Lock-free ring buffer for single producer and single consumer.
+  @tparam T type of data
+  @tparam N capacity (Power of 2)
+  @details Producer calls push(), write(), writeSpans() and commit().<br>
+  Consumer calls pop(), read(), readSpans() and consume().<br>
+  Positions are free running counters masked by N - 1, published by release and observed by acquire.
+  @note Unlike RingBuffer, does not overwrite if buffer is full.
+  @note Can be used between thread and ISR (or DMA callback) if std::atomic<std::size_t> is lock-free on the target.
+*/
+template<typename T, std::size_t N> class SpscRingBuffer
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be power of 2");
+    constexpr static std::size_t MASK = N - 1;
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    template<typename U> using SpanT = RingBufferSpan<U>;
+    using Span = SpanT<value_type>;
+    using ConstSpan = SpanT<const value_type>;
+
+    SpscRingBuffer() : _buf(), _head(0), _tail(0) {}
+
+    /// @name Property
+    /// @{
+    /*! @brief Number of elements (Approximate value on the other side) */
+    GOBLIB_INLINE size_type size() const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+    GOBLIB_NODISCARD GOBLIB_INLINE bool empty() const { return size() == 0; }
+    GOBLIB_NODISCARD GOBLIB_INLINE bool full() const { return size() >= N; }
+    GOBLIB_INLINE constexpr size_type capacity() const { return N; }
+    /// @}
+
+    /// @name Producer
+    /// @{
+    /*! @brief Push element. Return false if full */
+    bool push(const value_type& v)
+    {
+        size_type h = _head.load(std::memory_order_relaxed);
+        if(h - _tail.load(std::memory_order_acquire) >= N) { return false; }
+        _buf[h & MASK] = v;
+        _head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    /*! @brief Write to buffer
+      @param inbuf Input buffer
+      @param num Number of elements
+      @return Number of written elements (Less than num if not enough space)
+     */
+    size_type write(const value_type* inbuf, const size_type num)
+    {
+        auto sp = writeSpans();
+        size_type n1 = std::min(num, sp.first.size);
+        size_type n2 = std::min(num - n1, sp.second.size);
+        std::copy(inbuf, inbuf + n1, sp.first.data);
+        std::copy(inbuf + n1, inbuf + n1 + n2, sp.second.data);
+        commit(n1 + n2);
+        return n1 + n2;
+    }
+    /*! @brief Writable space as two contiguous spans. Write to them and call commit() */
+    std::pair<Span, Span> writeSpans()
+    {
+        size_type h = _head.load(std::memory_order_relaxed);
+        size_type space = N - (h - _tail.load(std::memory_order_acquire));
+        size_type idx = h & MASK;
+        size_type n1 = std::min(space, N - idx);
+        return std::make_pair(Span{ &_buf[idx], n1 }, Span{ &_buf[0], space - n1 });
+    }
+    /*! @brief Publish n elements written to writeSpans() */
+    GOBLIB_INLINE void commit(const size_type n)
+    {
+        size_type h = _head.load(std::memory_order_relaxed);
+        assert(n <= N - (h - _tail.load(std::memory_order_acquire)) && "Overflow");
+        _head.store(h + n, std::memory_order_release);
+    }
+    /// @}
+
+    /// @name Consumer
+    /// @{
+    /*! @brief Pop element. Return false if empty */
+    bool pop(value_type& out)
+    {
+        size_type t = _tail.load(std::memory_order_relaxed);
+        if(_head.load(std::memory_order_acquire) == t) { return false; }
+        out = _buf[t & MASK];
+        _tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    /*! @brief Read from buffer
+      @param outbuf Output buffer
+      @param num Max elements of output buffer
+      @return Number of output elements
+     */
+    size_type read(value_type* outbuf, const size_type num)
+    {
+        auto sp = readSpans();
+        size_type n1 = std::min(num, sp.first.size);
+        size_type n2 = std::min(num - n1, sp.second.size);
+        std::copy(sp.first.data, sp.first.data + n1, outbuf);
+        std::copy(sp.second.data, sp.second.data + n2, outbuf + n1);
+        consume(n1 + n2);
+        return n1 + n2;
+    }
+    /*! @brief Readable elements as two contiguous spans (Zero-copy). Call consume() after use */
+    std::pair<ConstSpan, ConstSpan> readSpans() const
+    {
+        size_type t = _tail.load(std::memory_order_relaxed);
+        size_type avail = _head.load(std::memory_order_acquire) - t;
+        size_type idx = t & MASK;
+        size_type n1 = std::min(avail, N - idx);
+        return std::make_pair(ConstSpan{ &_buf[idx], n1 }, ConstSpan{ &_buf[0], avail - n1 });
+    }
+    /*! @brief Release n elements read by readSpans() */
+    GOBLIB_INLINE void consume(const size_type n)
+    {
+        size_type t = _tail.load(std::memory_order_relaxed);
+        assert(n <= _head.load(std::memory_order_acquire) - t && "Underflow");
+        _tail.store(t + n, std::memory_order_release);
+    }
+    /*! @brief Remove all elements */
+    GOBLIB_INLINE void clear() { _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release); }
+    /// @}
+
+  private:
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+  private:
+    std::array<value_type, N> _buf;
+    std::atomic<size_type> _head; // Written by producer.
+    char _padding[64 - sizeof(std::atomic<size_type>)]; // Avoid false sharing of head and tail.
+    std::atomic<size_type> _tail; // Written by consumer.
+};
+
 //
 }
 #endif
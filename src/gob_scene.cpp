@@ -27,17 +27,38 @@ void SceneTask::popScene()
 
 SceneManageTask::SceneManageTask(goblib::TaskTree<goblib::Task>& tree, goblib::Task::PriorityType pri, goblib::Task* parent)
         : goblib::Task(pri, "scene manager")
-        , _tree(tree), _parent(parent), _stack()
+        , _tree(tree), _parent(parent), _stack(), _preloads(), _pending()
 {
     tree.reserveInsertNode(this, parent);
     _stack.reserve(16);
 }
 
+SceneManageTask::~SceneManageTask()
+{
+    while(!_preloads.empty()) { cancelPreload(_preloads.back().scene); }
+}
+
 void SceneManageTask::push(SceneTask* st)
 {
     assert(st);
     assert(st->_manager == nullptr && "st already used by managers");
-    
+    assert(std::find(_pending.begin(), _pending.end(), st) == _pending.end() && "st already pending");
+
+    auto it = std::find_if(_preloads.begin(), _preloads.end(), [st](const Preload& p) { return p.scene == st; });
+    if(it != _preloads.end() || !_pending.empty())
+    {
+        // Complete on onExecute. (Keep the order of push)
+        if(it == _preloads.end()) { preload(st, false); }
+        _pending.push_back(st);
+        flushPending();
+        return;
+    }
+    while(!st->stepPreload()) {}
+    _push(st);
+}
+
+void SceneManageTask::_push(SceneTask* st)
+{
     SceneTask::SceneType pid = 0;
     if(!_stack.empty())
     {
@@ -90,8 +111,67 @@ void SceneManageTask::pop()
     onChangeScene(cid, pid);
 }
 
+void SceneManageTask::preload(SceneTask* st, bool async)
+{
+    assert(st);
+    assert(st->_manager == nullptr && "st already used by managers");
+    if(isPreloading(st)) { return; }
+
+    st->_cancel = false;
+    _preloads.push_back(Preload{ st, std::thread() });
+    if(async && !st->isPreloaded())
+    {
+        _preloads.back().thread = std::thread([st]()
+        {
+            while(!st->_cancel && !st->stepPreload()) { std::this_thread::yield(); }
+        });
+    }
+}
+
+void SceneManageTask::cancelPreload(SceneTask* st)
+{
+    auto it = std::find_if(_preloads.begin(), _preloads.end(), [st](const Preload& p) { return p.scene == st; });
+    if(it == _preloads.end()) { return; }
+    st->_cancel = true;
+    finishPreload(it);
+    _pending.erase(std::remove(_pending.begin(), _pending.end(), st), _pending.end());
+}
+
+bool SceneManageTask::isPreloading(const SceneTask* st) const
+{
+    return std::any_of(_preloads.begin(), _preloads.end(), [st](const Preload& p) { return p.scene == st; });
+}
+
+void SceneManageTask::finishPreload(PreloadIterator it)
+{
+    if(it->thread.joinable()) { it->thread.join(); }
+    _preloads.erase(it);
+}
+
+void SceneManageTask::onExecute(const float)
+{
+    for(auto& p : _preloads)
+    {
+        if(!p.thread.joinable()) { p.scene->stepPreload(); }
+    }
+    flushPending();
+}
+
+void SceneManageTask::flushPending()
+{
+    while(!_pending.empty() && _pending.front()->isPreloaded())
+    {
+        SceneTask* st = _pending.front();
+        _pending.erase(_pending.begin());
+        finishPreload(std::find_if(_preloads.begin(), _preloads.end(), [st](const Preload& p) { return p.scene == st; }));
+        _push(st);
+    }
+}
+
 bool SceneManageTask::onRelease()
 {
+    while(!_preloads.empty()) { cancelPreload(_preloads.back().scene); }
+
     // Release all children.
     release(true); 
     // Wait until children has been killed.
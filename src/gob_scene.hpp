@@ -10,6 +10,8 @@
 
 #include "gob_task.hpp"
 #include <vector>
+#include <thread>
+#include <atomic>
 #include <type_traits>
 
 namespace goblib
@@ -26,10 +28,17 @@ class SceneTask : public goblib::Task
             : goblib::Task(pri, tag)
             , _sceneId(sid)
             , _manager(nullptr)
+            , _preloaded(false)
+            , _cancel(false)
+            , _progress(0.0f)
     { assert(sid !=0 && "sid must be not zero"); }
     virtual ~SceneTask() {}
 
     SceneType sceneId() const { return _sceneId; }
+    /*! @brief Has onPreload() been done? */
+    GOBLIB_INLINE bool isPreloaded() const { return _preloaded; }
+    /*! @brief Progress of preload [0.0 - 1.0] (For loading bar) */
+    GOBLIB_INLINE float preloadProgress() const { return _progress; }
 
     void pushScene(SceneTask* st);
     void popScene();
@@ -47,10 +56,34 @@ class SceneTask : public goblib::Task
     */
     virtual void onLeaveCurrentScene(SceneType cur){ (void)cur; }
     /// @}
+
+    /// @name Override if you want load before to be current scene.
+    /// @{
+    /*!
+      @brief Step of loading. Called repeatedly until returns true.
+      @retval true Done
+      @warning Called on worker thread if preloaded asynchronously. Do not touch the task tree, and use thread-safe resources.
+    */
+    virtual bool onPreload() { return true; }
+    /// @}
+    /*! @brief Report progress of preload [0.0 - 1.0] in onPreload() */
+    GOBLIB_INLINE void setPreloadProgress(const float p) { _progress = p; }
  
   private:
+    bool stepPreload()
+    {
+        if(!_preloaded && onPreload())
+        {
+            _progress = 1.0f;
+            _preloaded = true;
+        }
+        return _preloaded;
+    }
+
     const SceneType _sceneId;
     SceneManageTask* _manager;
+    std::atomic<bool> _preloaded, _cancel;
+    std::atomic<float> _progress;
     
     friend class SceneManageTask;
 };
@@ -63,24 +96,58 @@ class SceneManageTask : public goblib::Task
 {
   public:
     SceneManageTask(goblib::TaskTree<goblib::Task>& tree, goblib::Task::PriorityType pri, goblib::Task* parent = nullptr);
-    virtual~ SceneManageTask(){}
+    virtual~ SceneManageTask();
 
     goblib::Task* parent() { return _parent; }
     
+    /*!
+      @brief Push scene to be current.
+      @details If st is preloading and not yet done, push is completed on the pump of this task when preload has been done.<br>
+      If st is not preloading, st->onPreload() is called synchronously until done.
+     */
     void push(SceneTask* st);
     void pop();
 
+    /// @name Preload
+    /// @{
+    /*!
+      @brief Start preload while current scene keeps running.
+      @param st Scene (Not inserted to tree until push)
+      @param async Call onPreload() on worker thread if true, otherwise step once per pump of this task.
+    */
+    void preload(SceneTask* st, bool async = false);
+    /*! @brief Cancel preload (Wait for worker thread if async) */
+    void cancelPreload(SceneTask* st);
+    bool isPreloading(const SceneTask* st) const;
+    /*! @brief Is push waiting for preload? */
+    GOBLIB_INLINE bool isPushPending() const { return !_pending.empty(); }
+    /// @}
+
     void print();
     
   protected:
+    virtual void onExecute(const float delta) override;
     virtual bool onRelease() override;
     /*! @brief Called when scene has been changed. */
     virtual void onChangeScene(SceneTask::SceneType to, SceneTask::SceneType from){ (void)to, (void)from; }
 
   private:
+    struct Preload
+    {
+        SceneTask* scene;
+        std::thread thread; // Not joinable if stepped on pump
+    };
+    using PreloadIterator = std::vector<Preload>::iterator;
+
+    void _push(SceneTask* st);
+    void finishPreload(PreloadIterator it);
+    void flushPending();
+
     goblib::TaskTree<goblib::Task>& _tree;
     goblib::Task* _parent;
     std::vector<SceneTask*> _stack; // back() is current scene
+    std::vector<Preload> _preloads;
+    std::vector<SceneTask*> _pending; // Waiting push in requested order
 };
 
 //
@@ -0,0 +1,192 @@
+/*!
+  Goblin Library
+
+  @file  gob_snapshot.hpp
+  @brief Binary buffer for state snapshot and delta.
+*/
+#pragma once
+#ifndef GOBLIB_SNAPSHOT_HPP
+#define GOBLIB_SNAPSHOT_HPP
+
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <type_traits>
+#include <algorithm>
+#include <cassert>
+
+namespace goblib
+{
+
+/*!
+  @brief Contiguous binary buffer of snapshot.
+  @details Values are written in native byte order, so snapshots are not portable between platforms.<br>
+  Capacity is kept on clear(), so writing the same amount every frame does not allocate.
+*/
+class SnapshotBuffer
+{
+  public:
+    SnapshotBuffer() : _buf() {}
+    explicit SnapshotBuffer(const std::size_t reserve) : _buf() { _buf.reserve(reserve); }
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE const std::uint8_t* data() const { return _buf.data(); }
+    GOBLIB_INLINE std::uint8_t* data() { return _buf.data(); }
+    GOBLIB_INLINE std::size_t size() const { return _buf.size(); }
+    GOBLIB_INLINE bool empty() const { return _buf.empty(); }
+    GOBLIB_INLINE std::size_t capacity() const { return _buf.capacity(); }
+    /// @}
+
+    /// @name Write
+    /// @{
+    GOBLIB_INLINE void clear() { _buf.clear(); }
+    GOBLIB_INLINE void reserve(const std::size_t sz) { _buf.reserve(sz); }
+    GOBLIB_INLINE void resize(const std::size_t sz) { _buf.resize(sz); }
+    void write(const void* p, const std::size_t len)
+    {
+        const std::uint8_t* b = static_cast<const std::uint8_t*>(p);
+        _buf.insert(_buf.end(), b, b + len);
+    }
+    /*! @brief Write trivially copyable value */
+    template<typename U> GOBLIB_INLINE void write(const U& v)
+    {
+        static_assert(std::is_trivially_copyable<U>::value, "U must be trivially copyable");
+        write(&v, sizeof(U));
+    }
+    /*! @brief Overwrite value at offset (for size fields written later) */
+    template<typename U> GOBLIB_INLINE void patch(const std::size_t offset, const U& v)
+    {
+        static_assert(std::is_trivially_copyable<U>::value, "U must be trivially copyable");
+        assert(offset + sizeof(U) <= _buf.size() && "Out of range");
+        std::memcpy(_buf.data() + offset, &v, sizeof(U));
+    }
+    /// @}
+
+    /// @name Delta
+    /// @{
+    /*!
+      @brief Make delta of full against base
+      @details Delta consists of runs of bytes that differ from base. Same layout between frames makes delta small.
+      @param[out] out Delta
+    */
+    static void diff(const SnapshotBuffer& base, const SnapshotBuffer& full, SnapshotBuffer& out);
+    /*!
+      @brief Reconstruct full from base and delta
+      @param[out] out Full snapshot (Must not be base)
+      @retval false Delta is malformed or not made against base
+    */
+    static bool apply(const SnapshotBuffer& base, const SnapshotBuffer& delta, SnapshotBuffer& out);
+    /// @}
+
+  private:
+    // Delta: Header, { skip, length, bytes[length] }...
+    struct DeltaHeader
+    {
+        std::uint32_t magic, baseSize, fullSize;
+    };
+    constexpr static std::uint32_t DELTA_MAGIC = 0x444E5347; // "GSND"
+    constexpr static std::size_t MERGE_GAP = 8; // Equal bytes shorter than this are included in the run.
+
+    std::vector<std::uint8_t> _buf;
+};
+
+/*!
+  @brief Reader of SnapshotBuffer.
+  @note Reading past the end fails and leaves the value unchanged.
+*/
+class SnapshotReader
+{
+  public:
+    SnapshotReader(const std::uint8_t* p, const std::size_t len) : _cur(p), _tail(p + len) {}
+    explicit SnapshotReader(const SnapshotBuffer& b) : SnapshotReader(b.data(), b.size()) {}
+
+    GOBLIB_INLINE std::size_t remain() const { return static_cast<std::size_t>(_tail - _cur); }
+    GOBLIB_INLINE const std::uint8_t* current() const { return _cur; }
+
+    bool read(void* p, const std::size_t len)
+    {
+        if(len > remain()) { _cur = _tail; return false; }
+        std::memcpy(p, _cur, len);
+        _cur += len;
+        return true;
+    }
+    /*! @brief Read trivially copyable value */
+    template<typename U> GOBLIB_INLINE bool read(U& v)
+    {
+        static_assert(std::is_trivially_copyable<U>::value, "U must be trivially copyable");
+        return read(&v, sizeof(U));
+    }
+    bool skip(const std::size_t len)
+    {
+        if(len > remain()) { _cur = _tail; return false; }
+        _cur += len;
+        return true;
+    }
+
+  private:
+    const std::uint8_t* _cur;
+    const std::uint8_t* _tail;
+};
+
+/// @cond
+inline void SnapshotBuffer::diff(const SnapshotBuffer& base, const SnapshotBuffer& full, SnapshotBuffer& out)
+{
+    out.clear();
+    const DeltaHeader h{ DELTA_MAGIC, static_cast<std::uint32_t>(base.size()), static_cast<std::uint32_t>(full.size()) };
+    out.write(h);
+
+    const std::uint8_t* b = base.data();
+    const std::uint8_t* f = full.data();
+    const std::size_t common = std::min(base.size(), full.size());
+    std::size_t i = 0, last = 0; // last: End of previous run
+    while(i < full.size())
+    {
+        // Skip equal bytes.
+        while(i < common && b[i] == f[i]) { ++i; }
+        if(i >= full.size()) { break; }
+
+        // Run of different bytes. Short equal gaps are absorbed.
+        std::size_t e = i;
+        for(;;)
+        {
+            while(e < full.size() && (e >= common || b[e] != f[e])) { ++e; }
+            std::size_t g = e;
+            while(g < common && b[g] == f[g] && g - e < MERGE_GAP) { ++g; }
+            if(g >= full.size() || g - e >= MERGE_GAP) { break; }
+            e = g;
+        }
+        out.write(static_cast<std::uint32_t>(i - last));
+        out.write(static_cast<std::uint32_t>(e - i));
+        out.write(f + i, e - i);
+        i = last = e;
+    }
+}
+
+inline bool SnapshotBuffer::apply(const SnapshotBuffer& base, const SnapshotBuffer& delta, SnapshotBuffer& out)
+{
+    SnapshotReader r(delta);
+    DeltaHeader h{};
+    if(!r.read(h) || h.magic != DELTA_MAGIC || h.baseSize != base.size()) { return false; }
+
+    out.resize(h.fullSize);
+    const std::size_t common = std::min<std::size_t>(h.baseSize, h.fullSize);
+    if(common) { std::memcpy(out.data(), base.data(), common); }
+    std::size_t pos = 0;
+    while(r.remain())
+    {
+        std::uint32_t skip = 0, len = 0;
+        if(!r.read(skip) || !r.read(len)) { return false; }
+        pos += skip;
+        if(pos + len > h.fullSize || !r.read(out.data() + pos, len)) { return false; }
+        pos += len;
+    }
+    return true;
+}
+/// @endcond
+
+//
+}
+#endif
@@ -0,0 +1,641 @@
+/*!
+  Goblin Library
+
+  @file   gob_spatial_index.hpp
+  @brief  Broad-phase spatial index for 2D shapes.
+  @details Uniform grid (SpatialGrid) and loose quadtree (LooseQuadtree) of Rectangle bounds.
+  All storage is fixed size arrays in the object, so no heap allocation.
+*/
+#pragma once
+#ifndef GOBLIB_SPATIAL_INDEX_HPP
+#define GOBLIB_SPATIAL_INDEX_HPP
+
+#include "gob_macro.hpp"
+#include "gob_point2d.hpp"
+#include "gob_rect2d.hpp"
+#include "gob_line2d.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+
+namespace goblib { namespace shape2d {
+
+/// @cond
+namespace detail
+{
+// Clip segment (sx,sy)-(ex,ey) by [l,r]x[t,b] (Liang-Barsky)
+GOBLIB_INLINE bool clip_segment(const float sx, const float sy, const float ex, const float ey,
+                                const float l, const float t, const float r, const float b, float& t0, float& t1)
+{
+    const float dx = ex - sx, dy = ey - sy;
+    const float p[4] = { -dx, dx, -dy, dy };
+    const float q[4] = { sx - l, r - sx, sy - t, b - sy };
+    t0 = 0.0f;
+    t1 = 1.0f;
+    for(int i = 0; i < 4; ++i)
+    {
+        if(p[i] == 0.0f)
+        {
+            if(q[i] < 0.0f) { return false; }
+            continue;
+        }
+        const float u = q[i] / p[i];
+        if(p[i] < 0.0f)
+        {
+            if(u > t1) { return false; }
+            t0 = std::max(t0, u);
+        }
+        else
+        {
+            if(u < t0) { return false; }
+            t1 = std::min(t1, u);
+        }
+    }
+    return true;
+}
+
+template<typename T> GOBLIB_INLINE bool segment_overlaps(const LineSegment<T>& s, const Rectangle<T>& r)
+{
+    float t0, t1;
+    return r.valid() &&
+            clip_segment(static_cast<float>(s.sx()), static_cast<float>(s.sy()), static_cast<float>(s.ex()), static_cast<float>(s.ey()),
+                         static_cast<float>(r.left()), static_cast<float>(r.top()), static_cast<float>(r.right()), static_cast<float>(r.bottom()), t0, t1);
+}
+
+template<std::size_t N> using spatial_index_type = typename std::conditional<(N < 0xFFFFU), std::uint16_t, std::uint32_t>::type;
+//
+}
+/// @endcond
+
+// -------------------------------------------------------------------
+/*!
+  @brief Uniform grid of Rectangle bounds
+  @details The world is divided into Cols x Rows cells. An object is linked into every cell its bounds overlaps,
+  so it suits objects of similar size (bullets, enemies).<br>
+  Objects are identified by id [0, MaxObjects) given by the user (e.g. index of your object array).
+  @tparam T type of value.
+  @tparam MaxObjects Maximum number of objects.
+  @tparam Cols Number of cells horizontally.
+  @tparam Rows Number of cells vertically.
+  @tparam MaxEntries Maximum number of (object, cell) links.
+  @note Objects outside the world are stored in the border cells.
+  @warning Queries are not thread-safe (they update the visit stamp), and callbacks must not modify the index.
+*/
+template<typename T, std::size_t MaxObjects, std::size_t Cols = 16, std::size_t Rows = 16, std::size_t MaxEntries = MaxObjects * 4>
+class SpatialGrid
+{
+    static_assert(goblib::is_fixed_point_number<T>::value || std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(MaxObjects > 0 && Cols > 0 && Rows > 0, "Invalid size");
+    static_assert(Cols < 0xFFFFU && Rows < 0xFFFFU, "Too many cells");
+    static_assert(MaxEntries >= MaxObjects, "MaxEntries must be greater than or equal to MaxObjects");
+
+  public:
+    using pos_type = T;
+    using index_type = detail::spatial_index_type<(MaxEntries > MaxObjects ? MaxEntries : MaxObjects)>;
+
+    /*! @param world Area of the world */
+    explicit SpatialGrid(const Rectangle<T>& world) : _world(world)
+    {
+        assert(world.valid() && "Invalid world");
+        _invCellW = static_cast<float>(Cols) / static_cast<float>(world.width());
+        _invCellH = static_cast<float>(Rows) / static_cast<float>(world.height());
+        clear();
+    }
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE const Rectangle<T>& world() const { return _world; }
+    GOBLIB_INLINE std::size_t size() const { return _count; }
+    GOBLIB_INLINE bool empty() const { return _count == 0; }
+    constexpr static std::size_t capacity() { return MaxObjects; }
+    /*! @brief Number of free (object, cell) links */
+    GOBLIB_INLINE std::size_t freeEntries() const { return _freeCount; }
+    GOBLIB_INLINE bool exists(const std::size_t id) const { return id < MaxObjects && _objects[id].active; }
+    GOBLIB_INLINE const Rectangle<T>& bounds(const std::size_t id) const { return _objects[id].rect; }
+    /// @}
+
+    /// @name Modify
+    /// @{
+    /*! @brief Remove all objects */
+    void clear()
+    {
+        _cellHead.fill(NIL);
+        for(std::size_t i = 0; i < MaxEntries; ++i) { _entries[i].link = static_cast<index_type>(i + 1 < MaxEntries ? i + 1 : NIL); }
+        _freeEntry = 0;
+        _freeCount = MaxEntries;
+        for(auto& o : _objects) { o.active = false; o.head = NIL; }
+        _stamps.fill(0);
+        _stamp = 0;
+        _count = 0;
+    }
+    /*!
+      @brief Insert object
+      @retval false Already exists, out of range or not enough entries
+    */
+    bool insert(const std::size_t id, const Rectangle<T>& r)
+    {
+        assert(id < MaxObjects && "Out of range");
+        if(id >= MaxObjects || _objects[id].active) { return false; }
+        auto& o = _objects[id];
+        o.rect = r;
+        cellRange(r, o.c0, o.r0, o.c1, o.r1);
+        if(!link(id)) { return false; }
+        o.active = true;
+        ++_count;
+        return true;
+    }
+    /*!
+      @brief Update bounds of object
+      @details Relinks only if the covered cells are changed.
+      @retval false Not exists, or removed because of not enough entries
+    */
+    bool update(const std::size_t id, const Rectangle<T>& r)
+    {
+        if(!exists(id)) { return false; }
+        auto& o = _objects[id];
+        o.rect = r;
+        std::uint16_t c0, r0, c1, r1;
+        cellRange(r, c0, r0, c1, r1);
+        if(c0 == o.c0 && r0 == o.r0 && c1 == o.c1 && r1 == o.r1) { return true; }
+
+        unlink(id);
+        o.c0 = c0; o.r0 = r0; o.c1 = c1; o.r1 = r1;
+        if(!link(id))
+        {
+            o.active = false;
+            --_count;
+            return false;
+        }
+        return true;
+    }
+    /*! @brief Remove object */
+    void remove(const std::size_t id)
+    {
+        if(!exists(id)) { return; }
+        unlink(id);
+        _objects[id].active = false;
+        --_count;
+    }
+    /// @}
+
+    /// @name Query
+    /// @{
+    /*!
+      @brief Call fn(id) for each object overlapping r
+      @note Each object is called once.
+    */
+    template<class F> void query(const Rectangle<T>& r, F fn) const
+    {
+        if(!_count || !r.valid()) { return; }
+        std::uint16_t c0, r0, c1, r1;
+        cellRange(r, c0, r0, c1, r1);
+        const std::uint32_t stamp = nextStamp();
+        for(std::size_t y = r0; y <= r1; ++y)
+        {
+            for(std::size_t x = c0; x <= c1; ++x)
+            {
+                for(index_type e = _cellHead[y * Cols + x]; e != NIL; e = _entries[e].next)
+                {
+                    const index_type id = _entries[e].object;
+                    if(_stamps[id] == stamp) { continue; }
+                    _stamps[id] = stamp;
+                    if(_objects[id].rect.overlaps(r)) { fn(static_cast<std::size_t>(id)); }
+                }
+            }
+        }
+    }
+    /*! @brief Call fn(id) for each object containing p */
+    template<class F> void query(const Point<T>& p, F fn) const
+    {
+        if(!_count) { return; }
+        const std::size_t cell = cellY(p.y()) * Cols + cellX(p.x());
+        for(index_type e = _cellHead[cell]; e != NIL; e = _entries[e].next)
+        {
+            const index_type id = _entries[e].object;
+            if(_objects[id].rect.contains(p)) { fn(static_cast<std::size_t>(id)); }
+        }
+    }
+    /*!
+      @brief Call fn(id) for each object intersecting segment s
+      @details Walks the cells along the segment (DDA), so cost is proportional to the length.
+      @note Segment is clipped by the world.
+    */
+    template<class F> void query(const LineSegment<T>& s, F fn) const
+    {
+        if(!_count) { return; }
+        const float wl = static_cast<float>(_world.left()), wt = static_cast<float>(_world.top());
+        const float sx = (static_cast<float>(s.sx()) - wl) * _invCellW, sy = (static_cast<float>(s.sy()) - wt) * _invCellH;
+        const float ex = (static_cast<float>(s.ex()) - wl) * _invCellW, ey = (static_cast<float>(s.ey()) - wt) * _invCellH;
+        float t0, t1;
+        if(!detail::clip_segment(sx, sy, ex, ey, 0.0f, 0.0f, static_cast<float>(Cols), static_cast<float>(Rows), t0, t1)) { return; }
+
+        const float dx = ex - sx, dy = ey - sy;
+        const float px = sx + dx * t0, py = sy + dy * t0;
+        int cx = clampCell(px, Cols), cy = clampCell(py, Rows);
+        const int lx = clampCell(sx + dx * t1, Cols), ly = clampCell(sy + dy * t1, Rows);
+        const int stepX = dx > 0.0f ? 1 : -1, stepY = dy > 0.0f ? 1 : -1;
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        const float adx = std::fabs(dx), ady = std::fabs(dy);
+        float tMaxX = adx > 0.0f ? (stepX > 0 ? (cx + 1 - px) : (px - cx)) / adx : inf;
+        float tMaxY = ady > 0.0f ? (stepY > 0 ? (cy + 1 - py) : (py - cy)) / ady : inf;
+        const float tDeltaX = adx > 0.0f ? 1.0f / adx : inf, tDeltaY = ady > 0.0f ? 1.0f / ady : inf;
+
+        const std::uint32_t stamp = nextStamp();
+        for(std::size_t steps = 0; steps < Cols + Rows + 2; ++steps)
+        {
+            for(index_type e = _cellHead[cy * Cols + cx]; e != NIL; e = _entries[e].next)
+            {
+                const index_type id = _entries[e].object;
+                if(_stamps[id] == stamp) { continue; }
+                _stamps[id] = stamp;
+                if(detail::segment_overlaps(s, _objects[id].rect)) { fn(static_cast<std::size_t>(id)); }
+            }
+            if(cx == lx && cy == ly) { break; }
+            if(tMaxX < tMaxY) { cx += stepX; tMaxX += tDeltaX; }
+            else              { cy += stepY; tMaxY += tDeltaY; }
+            if(cx < 0 || cy < 0 || cx >= static_cast<int>(Cols) || cy >= static_cast<int>(Rows)) { break; }
+        }
+    }
+    /*!
+      @brief Call fn(a, b) for each overlapping pair (a < b)
+      @details A pair sharing multiple cells is reported only in the first shared cell.
+    */
+    template<class F> void pairs(F fn) const
+    {
+        if(_count < 2) { return; }
+        for(std::size_t y = 0; y < Rows; ++y)
+        {
+            for(std::size_t x = 0; x < Cols; ++x)
+            {
+                for(index_type e = _cellHead[y * Cols + x]; e != NIL; e = _entries[e].next)
+                {
+                    const index_type a = _entries[e].object;
+                    const auto& oa = _objects[a];
+                    for(index_type f = _entries[e].next; f != NIL; f = _entries[f].next)
+                    {
+                        const index_type b = _entries[f].object;
+                        const auto& ob = _objects[b];
+                        if(std::max(oa.c0, ob.c0) != x || std::max(oa.r0, ob.r0) != y) { continue; }
+                        if(!oa.rect.overlaps(ob.rect)) { continue; }
+                        fn(static_cast<std::size_t>(std::min(a, b)), static_cast<std::size_t>(std::max(a, b)));
+                    }
+                }
+            }
+        }
+    }
+    /// @}
+
+  private:
+    constexpr static index_type NIL = std::numeric_limits<index_type>::max();
+
+    struct Object
+    {
+        Rectangle<T> rect;
+        std::uint16_t c0, r0, c1, r1; // Covered cells (inclusive)
+        index_type head; // First entry of this object
+        bool active;
+    };
+    struct Entry
+    {
+        index_type object;
+        index_type prev, next; // In the cell
+        index_type link; // Next entry of same object, or next free entry
+        std::uint32_t cell;
+    };
+
+    GOBLIB_INLINE static int clampCell(const float v, const std::size_t n)
+    {
+        return v < 0.0f ? 0 : std::min(static_cast<int>(v), static_cast<int>(n) - 1);
+    }
+    GOBLIB_INLINE std::size_t cellX(const T x) const { return clampCell((static_cast<float>(x) - static_cast<float>(_world.left())) * _invCellW, Cols); }
+    GOBLIB_INLINE std::size_t cellY(const T y) const { return clampCell((static_cast<float>(y) - static_cast<float>(_world.top())) * _invCellH, Rows); }
+    void cellRange(const Rectangle<T>& r, std::uint16_t& c0, std::uint16_t& r0, std::uint16_t& c1, std::uint16_t& r1) const
+    {
+        c0 = static_cast<std::uint16_t>(cellX(r.left()));
+        r0 = static_cast<std::uint16_t>(cellY(r.top()));
+        c1 = static_cast<std::uint16_t>(cellX(r.right()));
+        r1 = static_cast<std::uint16_t>(cellY(r.bottom()));
+        if(c1 < c0) { c1 = c0; } // Empty rectangle
+        if(r1 < r0) { r1 = r0; }
+    }
+
+    bool link(const std::size_t id)
+    {
+        auto& o = _objects[id];
+        const std::size_t need = static_cast<std::size_t>(o.c1 - o.c0 + 1) * static_cast<std::size_t>(o.r1 - o.r0 + 1);
+        if(need > _freeCount) { return false; }
+        o.head = NIL;
+        for(std::size_t y = o.r0; y <= o.r1; ++y)
+        {
+            for(std::size_t x = o.c0; x <= o.c1; ++x)
+            {
+                const index_type e = _freeEntry;
+                auto& en = _entries[e];
+                _freeEntry = en.link;
+                const std::uint32_t cell = static_cast<std::uint32_t>(y * Cols + x);
+                en.object = static_cast<index_type>(id);
+                en.cell = cell;
+                en.prev = NIL;
+                en.next = _cellHead[cell];
+                if(en.next != NIL) { _entries[en.next].prev = e; }
+                _cellHead[cell] = e;
+                en.link = o.head;
+                o.head = e;
+            }
+        }
+        _freeCount -= need;
+        return true;
+    }
+    void unlink(const std::size_t id)
+    {
+        auto& o = _objects[id];
+        index_type e = o.head;
+        while(e != NIL)
+        {
+            auto& en = _entries[e];
+            const index_type nx = en.link;
+            if(en.prev != NIL) { _entries[en.prev].next = en.next; }
+            else               { _cellHead[en.cell] = en.next; }
+            if(en.next != NIL) { _entries[en.next].prev = en.prev; }
+            en.link = _freeEntry;
+            _freeEntry = e;
+            ++_freeCount;
+            e = nx;
+        }
+        o.head = NIL;
+    }
+    std::uint32_t nextStamp() const
+    {
+        if(++_stamp == 0)
+        {
+            _stamps.fill(0);
+            _stamp = 1;
+        }
+        return _stamp;
+    }
+
+    Rectangle<T> _world;
+    float _invCellW, _invCellH;
+    std::array<index_type, Cols * Rows> _cellHead;
+    std::array<Entry, MaxEntries> _entries;
+    std::array<Object, MaxObjects> _objects;
+    mutable std::array<std::uint32_t, MaxObjects> _stamps;
+    mutable std::uint32_t _stamp;
+    index_type _freeEntry;
+    std::size_t _freeCount, _count;
+};
+
+template<typename T, std::size_t MO, std::size_t C, std::size_t R, std::size_t ME>
+constexpr typename SpatialGrid<T, MO, C, R, ME>::index_type SpatialGrid<T, MO, C, R, ME>::NIL;
+
+// -------------------------------------------------------------------
+/*!
+  @brief Loose quadtree of Rectangle bounds
+  @details Each object is stored in exactly one node, chosen by its size and center.
+  Node bounds are loosened to twice the size, so the object fits without splitting.
+  Suits objects of very uneven size (a boss and many bullets).<br>
+  The tree is a full tree of Depth levels in a flat array, nodes are never allocated.
+  @tparam T type of value.
+  @tparam MaxObjects Maximum number of objects.
+  @tparam Depth Number of levels (Level N has 2^N x 2^N nodes).
+  @note Objects outside the world are stored in the border nodes, and may be missed by queries.
+  @warning Callbacks must not modify the index.
+*/
+template<typename T, std::size_t MaxObjects, std::size_t Depth = 5>
+class LooseQuadtree
+{
+    static_assert(goblib::is_fixed_point_number<T>::value || std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(MaxObjects > 0, "Invalid size");
+    static_assert(Depth >= 1 && Depth <= 10, "Depth must be 1...10");
+
+  public:
+    using pos_type = T;
+    using index_type = detail::spatial_index_type<MaxObjects>;
+
+    /*! @param world Area of the world */
+    explicit LooseQuadtree(const Rectangle<T>& world) : _world(world)
+    {
+        assert(world.valid() && "Invalid world");
+        _wl = static_cast<float>(world.left());
+        _wt = static_cast<float>(world.top());
+        _ww = static_cast<float>(world.width());
+        _wh = static_cast<float>(world.height());
+        clear();
+    }
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE const Rectangle<T>& world() const { return _world; }
+    GOBLIB_INLINE std::size_t size() const { return _count; }
+    GOBLIB_INLINE bool empty() const { return _count == 0; }
+    constexpr static std::size_t capacity() { return MaxObjects; }
+    GOBLIB_INLINE bool exists(const std::size_t id) const { return id < MaxObjects && _objects[id].active; }
+    GOBLIB_INLINE const Rectangle<T>& bounds(const std::size_t id) const { return _objects[id].rect; }
+    /// @}
+
+    /// @name Modify
+    /// @{
+    /*! @brief Remove all objects */
+    void clear()
+    {
+        _head.fill(NIL);
+        _levelCount.fill(0);
+        for(auto& o : _objects) { o.active = false; }
+        _count = 0;
+    }
+    /*!
+      @brief Insert object
+      @retval false Already exists or out of range
+    */
+    bool insert(const std::size_t id, const Rectangle<T>& r)
+    {
+        assert(id < MaxObjects && "Out of range");
+        if(id >= MaxObjects || _objects[id].active) { return false; }
+        auto& o = _objects[id];
+        o.rect = r;
+        locate(r, o.level, o.node);
+        link(id);
+        o.active = true;
+        ++_count;
+        return true;
+    }
+    /*!
+      @brief Update bounds of object
+      @details Relinks only if the node is changed.
+      @retval false Not exists
+    */
+    bool update(const std::size_t id, const Rectangle<T>& r)
+    {
+        if(!exists(id)) { return false; }
+        auto& o = _objects[id];
+        o.rect = r;
+        std::uint8_t level;
+        std::uint32_t node;
+        locate(r, level, node);
+        if(node == o.node) { return true; }
+        unlink(id);
+        o.level = level;
+        o.node = node;
+        link(id);
+        return true;
+    }
+    /*! @brief Remove object */
+    void remove(const std::size_t id)
+    {
+        if(!exists(id)) { return; }
+        unlink(id);
+        _objects[id].active = false;
+        --_count;
+    }
+    /// @}
+
+    /// @name Query
+    /// @{
+    /*! @brief Call fn(id) for each object overlapping r */
+    template<class F> void query(const Rectangle<T>& r, F fn) const
+    {
+        if(!_count || !r.valid()) { return; }
+        visit(static_cast<float>(r.left()), static_cast<float>(r.top()), static_cast<float>(r.right()), static_cast<float>(r.bottom()),
+              [this, &r, &fn](const index_type id)
+              {
+                  if(_objects[id].rect.overlaps(r)) { fn(static_cast<std::size_t>(id)); }
+              });
+    }
+    /*! @brief Call fn(id) for each object containing p */
+    template<class F> void query(const Point<T>& p, F fn) const
+    {
+        if(!_count) { return; }
+        const float x = static_cast<float>(p.x()), y = static_cast<float>(p.y());
+        visit(x, y, x, y, [this, &p, &fn](const index_type id)
+        {
+            if(_objects[id].rect.contains(p)) { fn(static_cast<std::size_t>(id)); }
+        });
+    }
+    /*! @brief Call fn(id) for each object intersecting segment s */
+    template<class F> void query(const LineSegment<T>& s, F fn) const
+    {
+        if(!_count) { return; }
+        const float sx = static_cast<float>(s.sx()), sy = static_cast<float>(s.sy());
+        const float ex = static_cast<float>(s.ex()), ey = static_cast<float>(s.ey());
+        visit(std::min(sx, ex), std::min(sy, ey), std::max(sx, ex), std::max(sy, ey), [this, &s, &fn](const index_type id)
+        {
+            if(detail::segment_overlaps(s, _objects[id].rect)) { fn(static_cast<std::size_t>(id)); }
+        });
+    }
+    /*! @brief Call fn(a, b) for each overlapping pair (a < b) */
+    template<class F> void pairs(F fn) const
+    {
+        if(_count < 2) { return; }
+        for(std::size_t a = 0; a < MaxObjects; ++a)
+        {
+            const auto& oa = _objects[a];
+            if(!oa.active || !oa.rect.valid()) { continue; }
+            visit(static_cast<float>(oa.rect.left()), static_cast<float>(oa.rect.top()),
+                  static_cast<float>(oa.rect.right()), static_cast<float>(oa.rect.bottom()),
+                  [this, a, &oa, &fn](const index_type b)
+                  {
+                      if(b > a && _objects[b].rect.overlaps(oa.rect)) { fn(a, static_cast<std::size_t>(b)); }
+                  });
+        }
+    }
+    /// @}
+
+  private:
+    constexpr static index_type NIL = std::numeric_limits<index_type>::max();
+    constexpr static std::size_t NODES = ((std::size_t(1) << (Depth * 2)) - 1) / 3;
+
+    struct Object
+    {
+        Rectangle<T> rect;
+        std::uint32_t node;
+        index_type prev, next; // In the node
+        std::uint8_t level;
+        bool active;
+    };
+
+    // First node index of level
+    GOBLIB_INLINE constexpr static std::size_t levelOffset(const std::size_t level) { return ((std::size_t(1) << (level * 2)) - 1) / 3; }
+
+    void locate(const Rectangle<T>& r, std::uint8_t& level, std::uint32_t& node) const
+    {
+        // Deepest level that node size >= object size
+        const float ratio = std::max(static_cast<float>(r.width()) / _ww, static_cast<float>(r.height()) / _wh);
+        std::size_t lv = 0;
+        while(lv + 1 < Depth && ratio <= 1.0f / static_cast<float>(1U << (lv + 1))) { ++lv; }
+
+        const int n = 1 << lv;
+        const float cx = static_cast<float>(r.left()) + static_cast<float>(r.width()) * 0.5f;
+        const float cy = static_cast<float>(r.top()) + static_cast<float>(r.height()) * 0.5f;
+        const int nx = clampNode((cx - _wl) * n / _ww, n);
+        const int ny = clampNode((cy - _wt) * n / _wh, n);
+        level = static_cast<std::uint8_t>(lv);
+        node = static_cast<std::uint32_t>(levelOffset(lv) + ny * n + nx);
+    }
+    GOBLIB_INLINE static int clampNode(const float v, const int n)
+    {
+        return v < 0.0f ? 0 : std::min(static_cast<int>(v), n - 1);
+    }
+
+    // Call fn(id) for each object in the loose nodes overlapping [l,r]x[t,b]
+    template<class F> void visit(const float l, const float t, const float r, const float b, F fn) const
+    {
+        for(std::size_t lv = 0; lv < Depth; ++lv)
+        {
+            if(!_levelCount[lv]) { continue; }
+            const int n = 1 << lv;
+            const float nw = _ww / n, nh = _wh / n;
+            // Loose node i covers [(i - 0.5) * size, (i + 1.5) * size]
+            const int x0 = std::max(0, static_cast<int>(std::ceil((l - _wl) / nw - 1.5f)));
+            const int x1 = std::min(n - 1, static_cast<int>(std::floor((r - _wl) / nw + 0.5f)));
+            const int y0 = std::max(0, static_cast<int>(std::ceil((t - _wt) / nh - 1.5f)));
+            const int y1 = std::min(n - 1, static_cast<int>(std::floor((b - _wt) / nh + 0.5f)));
+            const std::size_t base = levelOffset(lv);
+            for(int y = y0; y <= y1; ++y)
+            {
+                for(int x = x0; x <= x1; ++x)
+                {
+                    for(index_type id = _head[base + y * n + x]; id != NIL; id = _objects[id].next) { fn(id); }
+                }
+            }
+        }
+    }
+
+    void link(const std::size_t id)
+    {
+        auto& o = _objects[id];
+        o.prev = NIL;
+        o.next = _head[o.node];
+        if(o.next != NIL) { _objects[o.next].prev = static_cast<index_type>(id); }
+        _head[o.node] = static_cast<index_type>(id);
+        ++_levelCount[o.level];
+    }
+    void unlink(const std::size_t id)
+    {
+        auto& o = _objects[id];
+        if(o.prev != NIL) { _objects[o.prev].next = o.next; }
+        else              { _head[o.node] = o.next; }
+        if(o.next != NIL) { _objects[o.next].prev = o.prev; }
+        --_levelCount[o.level];
+    }
+
+    Rectangle<T> _world;
+    float _wl, _wt, _ww, _wh;
+    std::array<index_type, NODES> _head;
+    std::array<std::uint32_t, Depth> _levelCount;
+    std::array<Object, MaxObjects> _objects;
+    std::size_t _count;
+};
+
+template<typename T, std::size_t MO, std::size_t D>
+constexpr typename LooseQuadtree<T, MO, D>::index_type LooseQuadtree<T, MO, D>::NIL;
+template<typename T, std::size_t MO, std::size_t D>
+constexpr std::size_t LooseQuadtree<T, MO, D>::NODES;
+
+//
+}}
+#endif
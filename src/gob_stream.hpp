@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <type_traits> // std::make_signed
+#include "gob_endianness.hpp"
 
 namespace goblib
 {
@@ -23,6 +24,13 @@ enum seekdir : std::int_fast8_t
     end,    //!< Based on the [end] of the stream.
 };
 
+/*! @brief Zero-copy view of data in stream */
+struct StreamView
+{
+    const std::uint8_t* data;   //!< Head of view (nullptr if not supported)
+    std::size_t size;           //!< Length of view (0 if not supported or tail)
+};
+
 /*!
   @brief stream base
   @tparam type of stream position. (std::uint64_t as default)
@@ -74,6 +82,40 @@ class Stream
         read(reinterpret_cast<std::uint8_t*>(&b32), 4);
         return b32;
     }
+    /*!
+      @brief Read value stored in byte order O
+      @tparam T Trivially copyable type of size 1, 2, 4 or 8
+      @tparam O Byte order of stored data
+      @note Value is indeterminate if could not read sizeof(T) bytes.
+    */
+    template<typename T, endian::Order O = endian::Order::Native> T readValue()
+    {
+        T v{};
+        read(reinterpret_cast<std::uint8_t*>(&v), sizeof(T));
+        return endian::convert<O>(v);
+    }
+    /*!
+      @brief Bulk read count values stored in byte order O
+      @details Reads one block by read() and converts in place. (No conversion if O is native)
+      @tparam T Trivially copyable type of size 1, 2, 4 or 8
+      @tparam O Byte order of stored data
+      @return Number of elements read completely
+    */
+    template<typename T, endian::Order O = endian::Order::Native> std::size_t readArray(T* dst, const std::size_t count)
+    {
+        auto rsz = read(reinterpret_cast<std::uint8_t*>(dst), count * sizeof(T));
+        std::size_t n = static_cast<std::size_t>(rsz / sizeof(T));
+        endian::convert<O>(dst, n);
+        return n;
+    }
+    /*!
+      @brief Zero-copy read
+      @details Returns pointer and length into the underlying storage and advances the position, without copying.
+      @param len Maximum length
+      @note Default implementation is not supported, returns { nullptr, 0 } and position is not changed.
+      @warning View is valid while the stream is open and the storage is alive.
+    */
+    virtual StreamView view(std::size_t /*len*/) { return StreamView{ nullptr, 0 }; }
     /// @}
 
     /// @name Seek
@@ -16,7 +16,7 @@ namespace goblib
 Task::Task(PriorityType pri, const char* tag)
         : goblib::Node()
         , _tag("")
-        , _priority(pri), _status(Status::Initialize)
+        , _priority(pri), _status(Status::Initialize), _uid(0)
 {
     std::strncpy(_tag, tag, sizeof(_tag) - 1);
     _tag[sizeof(_tag) - 1] = '\0';
@@ -26,6 +26,7 @@ void Task::pump(const float delta)
 {
     if(isKill()) { return; }
 
+    GOBLIB_TRACE_SCOPE(tag());
     switch(status() & MASK_STATUS)
     {
     case Status::Execute:
@@ -3,7 +3,7 @@
 
   @file  gob_task.hpp
   @brief Task system.
-  @warning This is NOT THREAD.
+  @warning This is NOT THREAD. (Except postMessage and postBroadcastMessage)
 */
 #pragma once
 #ifndef GOBLIB_TASK_HPP
@@ -11,8 +11,18 @@
 
 #include "gob_macro.hpp"
 #include "gob_tree.hpp"
+#include "gob_mpsc_queue.hpp"
+#include "gob_allocator.hpp"
+#include "gob_trace.hpp"
+#include "gob_snapshot.hpp"
+#include <atomic>
 #include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
 #include <cstdio>
+#include <cstddef>
+#include <cstring>
 
 namespace goblib
 {
@@ -87,6 +97,8 @@ class Task : public goblib::Node
     GOBLIB_INLINE bool isRelease() const { return (status() & MASK_STATUS) == Status::Release; }
     GOBLIB_INLINE bool isPause() const { return status() & Status::Pause; }
     GOBLIB_INLINE bool isKill() const { return status() & Status::Kill; }
+    /*! @brief Unique id in TaskTree (Assigned on insert, 0 if never inserted) */
+    GOBLIB_INLINE std::uint32_t uid() const { return _uid; }
     /// @}
 
     /// @name Operation
@@ -132,6 +144,19 @@ class Task : public goblib::Node
     virtual void onReceive(const TaskMessage& /*msg*/) {}
     /// @}
 
+    /*!
+      @name Override for snapshot
+      @brief Opt-in. Default has no payload, so only the structure and status are restored.
+    */
+    /// @{
+    /*! @brief Type id passed to the factory of TaskTree::restore */
+    virtual std::uint32_t snapshotType() const { return 0; }
+    /*! @brief Write state to out */
+    virtual void onSnapshot(SnapshotBuffer& /*out*/) const {}
+    /*! @brief Read state written by onSnapshot. Return false if failed */
+    virtual bool onRestore(SnapshotReader& /*in*/) { return true; }
+    /// @}
+
   private:
     void _release(bool includeChildren)
     {
@@ -168,6 +193,7 @@ class Task : public goblib::Node
     char _tag[16];
     PriorityType  _priority;
     StatusType _status;
+    std::uint32_t _uid;
 
     template<typename> friend class TaskTree;
 };
@@ -175,22 +201,33 @@ class Task : public goblib::Node
 
 /*!
   @brief Parent-child task system.
+  @note Derived class that overrides onInsertNode / onRemoveNode must call those of TaskTree.
 */
 template<class  T>
 class TaskTree : public FamilyTree<T>
 {
     static_assert(std::is_base_of<Task, T>::value, "T muse be Task or derived of Task");
-    constexpr static std::size_t QUEUE_RESERVE_SIZE = 16;
+
+  protected:
+    constexpr static std::size_t QUEUE_RESERVE_SIZE = 256;
 
   public:
     /*!
-      @param qreserve Message queue max size for post message.
+      @param qreserve Message queue max size for post message per pump. (Rounded up to power of 2)
+      @note Queues do not grow. Messages posted to a full queue are dropped and counted (dropped(), droppedBroadcast()).
     */
     explicit TaskTree(std::size_t qreserve = QUEUE_RESERVE_SIZE)
-            : FamilyTree<T>(), _message(qreserve), _broadcastMessage(qreserve), _pause(false)
+            : FamilyTree<T>(), _message(qreserve), _broadcastMessage(qreserve)
+            , _dropped(0), _droppedBroadcast(0), _lastDropped(0), _lastDroppedBroadcast(0)
+            , _pending(), _targets(), _active(), _unvisited(0), _subscription()
+            , _routeOrder(), _routeEnd(), _routeIndex(), _routes(), _wildcard(), _events(), _routeStack(), _routing(0), _routeDirty(true)
+            , _allocator(nullptr), _pause(false)
+            , _serial(0), _records(), _uids(), _live(), _nodes(), _parents(), _created(), _depthStack(), _scratch()
     {
         assert(qreserve > 0 && "qreserve muset be greater than zero");
-        _message.clear(); _broadcastMessage.clear();
+        _pending.reserve(_broadcastMessage.capacity());
+        _targets.reserve(_broadcastMessage.capacity());
+        _active.reserve(_broadcastMessage.capacity());
     }
     
     /// @name Pause global
@@ -207,8 +244,7 @@ class TaskTree : public FamilyTree<T>
     /*! @brief Pause each task */
     void pause(bool b, bool includeChildren)
     {
-        typename FamilyTree<T>::Callback f = [&b, &includeChildren](T* t){ t->pause(b, includeChildren); };
-        this->callback(f);
+        this->visit([b, includeChildren](T* t){ t->pause(b, includeChildren); });
     }
     void pause()  { pause( true, true); }
     void resume() { pause(false, true); }
@@ -218,12 +254,21 @@ class TaskTree : public FamilyTree<T>
     {
         if(isPauseGlobal()) { return; }
 
-        typename FamilyTree<T>::Callback callback_pump = [&delta](T* t){ t->pump(delta); };    
-
+        GOBLIB_TRACE_SCOPE("TaskTree::pump");
         this->deliverMessage();
-        this->callback(callback_pump);
+        this->visit([delta](T* t){ t->pump(delta); });
         this->insertReservedNodes();
-        this->removeNode_if(is_kill);
+        this->remove_if(is_kill);
+    }
+
+    /*!
+      @brief Reserve node registration
+      @note Deferred if a derived tree defers it. (e.g. Called on worker thread of ParallelTaskTree)
+    */
+    void reserveInsertNode(T* node, T* parent = nullptr)
+    {
+        if(deferReserveInsertNode(node, parent)) { return; }
+        FamilyTree<T>::reserveInsertNode(node, parent);
     }
 
     /// @name Message
@@ -241,9 +286,10 @@ class TaskTree : public FamilyTree<T>
     void postMessage(const TaskMessage& m, U* target)
     {
         assert(target);
+        if(deferPostMessage(m, static_cast<goblib::Task*>(target))) { return; }
         TaskMessage msg(m);
         msg.target = static_cast<goblib::Task*>(target);
-        _message.push_back(msg);
+        if(!_message.push(msg)) { _dropped.fetch_add(1, std::memory_order_relaxed); }
     }
 
     void sendBroadcastMessage(const TaskMessage& m)
@@ -256,8 +302,18 @@ class TaskTree : public FamilyTree<T>
     void sendBroadcastMessage(const TaskMessage& m, U* top)
     {
         T* t = static_cast<T*>(top ? top : this->root());
-        typename FamilyTree<T>::Callback f = [&m](T* t){ t->onReceive(m); };
-        this->callback(f, t);
+        if(_subscription.empty())
+        {
+            this->visit_subtree([&m](T* t){ t->onReceive(m); }, t);
+            return;
+        }
+        // Index cannot be rebuilt while it is being iterated by outer delivery.
+        if(_routeDirty && _routing)
+        {
+            this->visit_subtree([this, &m](T* t){ if(accepts(t, m.msg)) { t->onReceive(m); } }, t);
+            return;
+        }
+        routeBroadcast(m, t);
     }
 
     void postBroadcastMessage(const TaskMessage& m)
@@ -269,53 +325,520 @@ class TaskTree : public FamilyTree<T>
     template<class U, typename std::enable_if<std::is_base_of<T, U>::value, std::nullptr_t>::type = nullptr>
     void postBroadcastMessage(const TaskMessage& m, U* top)
     {
+        if(deferPostBroadcastMessage(m, static_cast<T*>(top))) { return; }
         TaskMessage msg(m);
         msg.target = static_cast<T*>(top ? top : this->root());
-        _broadcastMessage.push_back(msg);
+        if(!_broadcastMessage.push(msg)) { _droppedBroadcast.fetch_add(1, std::memory_order_relaxed); }
     }
     
     /*! Underivered messages */
     GOBLIB_INLINE std::size_t undelivered() const { return _message.size(); }
     /*! Underivered broadcast messages */
     GOBLIB_INLINE std::size_t undeliveredBroadcast() const { return _broadcastMessage.size(); }
+    /*! Messages dropped by full queue in previous frame (Counted until last pump) */
+    GOBLIB_INLINE std::size_t dropped() const { return _lastDropped; }
+    /*! Broadcast messages dropped by full queue in previous frame (Counted until last pump) */
+    GOBLIB_INLINE std::size_t droppedBroadcast() const { return _lastDroppedBroadcast; }
     /// @}
-    
+
+    /*!
+      @name Subscription
+      @brief Task that subscribed receives only broadcast messages of subscribed msg.
+      @details While any subscription exists, broadcast messages are routed by the index of msg,
+      so only subscribers and tasks without subscription in the target subtree are visited (in preorder).
+      The index is rebuilt on the next broadcast after the tree or subscriptions changed.
+      @note Task that has no subscription receives all broadcast messages.
+    */
+    /// @{
+    void subscribe(const T* t, const std::uint32_t msg)
+    {
+        auto e = std::make_pair(static_cast<const Task*>(t), msg);
+        auto it = std::lower_bound(_subscription.begin(), _subscription.end(), e, subscription_less);
+        if(it == _subscription.end() || *it != e) { _subscription.insert(it, e); _routeDirty = true; }
+    }
+    void unsubscribe(const T* t, const std::uint32_t msg)
+    {
+        auto e = std::make_pair(static_cast<const Task*>(t), msg);
+        auto it = std::lower_bound(_subscription.begin(), _subscription.end(), e, subscription_less);
+        if(it != _subscription.end() && *it == e) { _subscription.erase(it); _routeDirty = true; }
+    }
+    void unsubscribeAll(const T* t)
+    {
+        auto r = subscriptionOf(t);
+        if(r.first != r.second) { _subscription.erase(r.first, r.second); _routeDirty = true; }
+    }
+    bool isSubscribed(const T* t, const std::uint32_t msg) const
+    {
+        auto e = std::make_pair(static_cast<const Task*>(t), msg);
+        return std::binary_search(_subscription.begin(), _subscription.end(), e, subscription_less);
+    }
+    /*! @brief Does t receive broadcast message msg? */
+    bool accepts(const T* t, const std::uint32_t msg) const
+    {
+        if(_subscription.empty()) { return true; }
+        auto r = subscriptionOf(t);
+        return r.first == r.second ||
+                std::binary_search(r.first, r.second, std::make_pair(static_cast<const Task*>(t), msg), subscription_less);
+    }
+    /// @}
+
+    /// @name Allocator
+    /// @{
+    /*! @brief Set allocator for createTask(). Tasks in allocator are destroyed when removed from tree. */
+    GOBLIB_INLINE void setAllocator(SlabAllocator* a) { _allocator = a; }
+    GOBLIB_INLINE SlabAllocator* allocator() const { return _allocator; }
+    /*!
+      @brief Create U by allocator and reserve insert
+      @retval != nullptr Created task
+      @retval == nullptr No allocator or allocation failed.
+    */
+    template<class U, class... Args> U* createTask(T* parent, Args&&... args)
+    {
+        static_assert(std::is_base_of<T, U>::value, "U must be T or derived of T");
+        assert(_allocator && "Allocator not set");
+        U* t = _allocator ? _allocator->create<U>(std::forward<Args>(args)...) : nullptr;
+        if(t) { this->reserveInsertNode(t, parent); }
+        return t;
+    }
+    /// @}
+
+    /*!
+      @name Snapshot
+      @brief Snapshot and restore structure (parent, priority, status, tag) and payload of tasks.
+      @details Tasks are identified by Task::uid(). Restore reuses live tasks and relinks them without allocation.
+      Live tasks not in the snapshot are removed, and tasks in the snapshot but removed are created by the factory.<br>
+      Working buffers are kept, so repeated snapshot/restore do not allocate once they are large enough.
+      @note Call between pumps with no reserved nodes. Messages and subscriptions are not included.
+    */
+    /// @{
+    /*!
+      @brief Factory for tasks removed after the snapshot
+      @details Returns task not in tree. (e.g. allocator()->create<U>()) Tag, priority and payload are restored after creation.
+    */
+    using Factory = std::function<T*(const std::uint32_t type, const char* tag, const Task::PriorityType pri)>;
+
+    /*! @brief Full snapshot */
+    void snapshot(SnapshotBuffer& out);
+    /*! @brief Delta snapshot against base (full snapshot) */
+    void snapshot(SnapshotBuffer& out, const SnapshotBuffer& base)
+    {
+        snapshot(_scratch);
+        SnapshotBuffer::diff(base, _scratch, out);
+    }
+    /*!
+      @brief Restore from full snapshot
+      @retval false Malformed, factory failed or Task::onRestore failed. (Restored as far as possible)
+      @note Tasks below a task that the factory failed to create are removed by onRemoveNode.
+    */
+    bool restore(const SnapshotBuffer& in, const Factory& factory = nullptr);
+    /*! @brief Restore from delta against base */
+    bool restore(const SnapshotBuffer& base, const SnapshotBuffer& delta, const Factory& factory = nullptr)
+    {
+        return SnapshotBuffer::apply(base, delta, _scratch) && restore(_scratch, factory);
+    }
+    /// @}
+
     virtual void print();
 
-  private:
+  protected:
+    virtual void onInsertNode(T* node) override
+    {
+        if(!node->_uid) { node->_uid = ++_serial; }
+        _routeDirty = true;
+    }
+    virtual void onRemoveNode(T* node) override
+    {
+        _routeDirty = true;
+        if(!_subscription.empty()) { unsubscribeAll(node); }
+        if(_allocator && _allocator->owns(node)) { _allocator->destroy(node); }
+    }
+    /*! @brief Called after restore() relinks the tree */
+    virtual void onRestoreTree() {}
+
+    /// @name Deferral
+    /// @brief Override to defer reserveInsertNode, postMessage and postBroadcastMessage. Return true if deferred.
+    /// @{
+    virtual bool deferReserveInsertNode(T* /*node*/, T* /*parent*/) { return false; }
+    virtual bool deferPostMessage(const TaskMessage& /*m*/, goblib::Task* /*target*/) { return false; }
+    virtual bool deferPostBroadcastMessage(const TaskMessage& /*m*/, T* /*top*/) { return false; }
+    /// @}
+
     void deliverMessage();
 
+  private:
     TaskTree(const TaskTree&) = delete;
     TaskTree(TaskTree&&) = delete;
     TaskTree& operator=(const TaskTree&) = delete;
     TaskTree& operator=(TaskTree&&) = delete;
     
   private:
-    typename FamilyTree<T>::Compare is_kill = [](const T* t){ return t->isKill(); };
-    std::vector<TaskMessage> _message; // Undelivered message by post.
-    std::vector<TaskMessage> _broadcastMessage; // Undelivered message by post broadcast.
+    using Subscription = std::pair<const Task*, std::uint32_t>;
+    using SubscriptionIterator = typename std::vector<Subscription>::const_iterator;
+    using Target = std::pair<const Task*, std::size_t>;
+
+    static bool is_kill(const T* t) { return t->isKill(); }
+    static bool subscription_less(const Subscription& a, const Subscription& b)
+    {
+        return std::less<const Task*>()(a.first, b.first) || (a.first == b.first && a.second < b.second);
+    }
+    std::pair<SubscriptionIterator, SubscriptionIterator> subscriptionOf(const T* t) const
+    {
+        auto b = std::lower_bound(_subscription.begin(), _subscription.end(), Subscription(t, 0), subscription_less);
+        auto e = b;
+        while(e != _subscription.end() && e->first == t) { ++e; }
+        return std::make_pair(b, e);
+    }
+    void broadcastPass(T* p);
+    void buildRoutes();
+    void routePending();
+    void routeBroadcast(const TaskMessage& m, const T* top);
+    template<class F> void forEachRoute(const std::uint32_t msg, const T* top, F&& func) const;
+
+    MpscQueue<TaskMessage> _message; // Undelivered message by post.
+    MpscQueue<TaskMessage> _broadcastMessage; // Undelivered message by post broadcast.
+    std::atomic<std::size_t> _dropped, _droppedBroadcast; // Dropped since last deliverMessage.
+    std::size_t _lastDropped, _lastDroppedBroadcast; // Dropped until last deliverMessage.
+    std::vector<TaskMessage> _pending; // Broadcast messages delivering.
+    std::vector<Target> _targets; // Target and index of _pending, sorted by target.
+    std::vector<std::size_t> _active; // Indexes of _pending whose target is an ancestor of walking task.
+    std::size_t _unvisited; // Number of _targets not yet reached in broadcastPass.
+    std::vector<Subscription> _subscription; // Sorted subscriptions.
+
+    // Broadcast routing by subscription (Rebuilt if dirty)
+    using Route = std::pair<std::uint32_t, std::uint32_t>; // msg, preorder index
+    struct Event { std::uint32_t order, pending; T* task; }; // Delivery of _pending[pending] to task
+    std::vector<T*> _routeOrder; // Tasks in preorder (include root)
+    std::vector<std::uint32_t> _routeEnd; // End of subtree of each preorder index
+    std::vector<std::pair<const Task*, std::uint32_t>> _routeIndex; // Task and preorder index, sorted by task
+    std::vector<Route> _routes; // Subscribers, sorted
+    std::vector<std::uint32_t> _wildcard; // Preorder index of tasks without subscription
+    std::vector<Event> _events;
+    std::vector<std::uint32_t> _routeStack;
+    std::uint32_t _routing; // Depth of iterating the index
+    bool _routeDirty;
+    SlabAllocator* _allocator; // Allocator for createTask().
     bool _pause;
+
+    // Snapshot
+    struct SnapshotHeader
+    {
+        std::uint32_t magic, count, serial, pause;
+    };
+    struct SnapshotRecord
+    {
+        std::uint32_t uid;
+        std::int32_t parent; // Index of parent record (-1: root)
+        Task::PriorityType priority;
+        Task::StatusType status;
+        std::uint32_t type;
+        std::uint32_t payload; // Size of payload following the record
+        char tag[16];
+    };
+    struct Restoring
+    {
+        SnapshotRecord record;
+        const std::uint8_t* payload;
+        std::int32_t node; // Index of _nodes (-1: dropped)
+    };
+    constexpr static std::uint32_t SNAPSHOT_MAGIC = 0x50534B54; // "TKSP"
+
+    std::uint32_t _serial; // Last assigned uid.
+    std::vector<Restoring> _records;
+    std::vector<std::uint32_t> _uids; // Sorted uids in snapshot.
+    std::vector<std::pair<std::uint32_t, T*>> _live; // Sorted live tasks by uid.
+    std::vector<T*> _nodes;
+    std::vector<std::int32_t> _parents;
+    std::vector<T*> _created;
+    std::vector<std::int32_t> _depthStack;
+    SnapshotBuffer _scratch;
 };
 
+template<class T> constexpr std::uint32_t TaskTree<T>::SNAPSHOT_MAGIC;
+
+template<class T> void TaskTree<T>::snapshot(SnapshotBuffer& out)
+{
+    GOBLIB_TRACE_SCOPE("TaskTree::snapshot");
+    out.clear();
+    SnapshotHeader h{ SNAPSHOT_MAGIC, 0, _serial, _pause };
+    out.write(h);
+
+    std::int32_t count = 0;
+    this->visit_with_depth([this, &out, &count](T* t, const std::uint32_t depth)
+    {
+        if(_depthStack.size() <= depth) { _depthStack.resize(depth + 1); }
+        _depthStack[depth] = count;
+
+        const Task* task = static_cast<const Task*>(t);
+        SnapshotRecord r{ task->_uid, depth ? _depthStack[depth - 1] : -1, task->_priority, task->_status, task->snapshotType(), 0, {} };
+        std::memcpy(r.tag, task->_tag, sizeof(r.tag));
+        const std::size_t off = out.size();
+        out.write(r);
+        task->onSnapshot(out);
+        out.patch(off + offsetof(SnapshotRecord, payload), static_cast<std::uint32_t>(out.size() - off - sizeof(r)));
+        ++count;
+    });
+    out.patch(offsetof(SnapshotHeader, count), static_cast<std::uint32_t>(count));
+}
+
+template<class T> bool TaskTree<T>::restore(const SnapshotBuffer& in, const Factory& factory)
+{
+    GOBLIB_TRACE_SCOPE("TaskTree::restore");
+    assert(!this->reservedNodes() && "Restore with reserved nodes");
+
+    SnapshotReader reader(in);
+    SnapshotHeader h{};
+    if(!reader.read(h) || h.magic != SNAPSHOT_MAGIC) { return false; }
+
+    _records.clear();
+    _uids.clear();
+    for(std::uint32_t i = 0; i < h.count; ++i)
+    {
+        Restoring rs{ {}, nullptr, -1 };
+        if(!reader.read(rs.record)) { return false; }
+        rs.payload = reader.current();
+        if(!reader.skip(rs.record.payload) || rs.record.parent >= static_cast<std::int32_t>(i)) { return false; }
+        _records.push_back(rs);
+        _uids.push_back(rs.record.uid);
+    }
+    std::sort(_uids.begin(), _uids.end());
+
+    // Remove tasks that did not exist at the snapshot.
+    this->remove_if([this](const T* t)
+    {
+        return !std::binary_search(_uids.begin(), _uids.end(), static_cast<const Task*>(t)->_uid);
+    });
+
+    _live.clear();
+    this->visit([this](T* t) { _live.emplace_back(static_cast<Task*>(t)->_uid, t); });
+    std::sort(_live.begin(), _live.end(), [](const std::pair<std::uint32_t, T*>& a, const std::pair<std::uint32_t, T*>& b)
+    {
+        return a.first < b.first;
+    });
+
+    bool result = true;
+    _nodes.clear();
+    _parents.clear();
+    _created.clear();
+    for(auto& rs : _records)
+    {
+        const SnapshotRecord& r = rs.record;
+        // Descendants of dropped task are dropped.
+        if(r.parent >= 0 && _records[r.parent].node < 0) { result = false; continue; }
+
+        auto it = std::lower_bound(_live.begin(), _live.end(), r.uid, [](const std::pair<std::uint32_t, T*>& e, const std::uint32_t v)
+        {
+            return e.first < v;
+        });
+        T* t = nullptr;
+        if(it != _live.end() && it->first == r.uid)
+        {
+            t = it->second;
+            it->second = nullptr; // Relinked
+        }
+        if(!t)
+        {
+            char tag[sizeof(r.tag) + 1] = {};
+            std::memcpy(tag, r.tag, sizeof(r.tag));
+            t = factory ? factory(r.type, tag, r.priority) : nullptr;
+            if(!t) { result = false; continue; }
+            _created.push_back(t);
+        }
+
+        Task* task = static_cast<Task*>(t);
+        task->_uid = r.uid;
+        task->_priority = r.priority;
+        task->_status = r.status;
+        std::memcpy(task->_tag, r.tag, sizeof(task->_tag));
+        task->_tag[sizeof(task->_tag) - 1] = '\0';
+        SnapshotReader pr(rs.payload, r.payload);
+        result &= task->onRestore(pr);
+
+        rs.node = static_cast<std::int32_t>(_nodes.size());
+        _nodes.push_back(t);
+        _parents.push_back(r.parent >= 0 ? _records[r.parent].node : -1);
+    }
+
+    // Remove live tasks that are not relinked. (Descendants of dropped task)
+    if(!result)
+    {
+        this->remove_if([this](const T* t)
+        {
+            const std::uint32_t uid = static_cast<const Task*>(t)->_uid;
+            auto it = std::lower_bound(_live.begin(), _live.end(), uid, [](const std::pair<std::uint32_t, T*>& e, const std::uint32_t v)
+            {
+                return e.first < v;
+            });
+            return it != _live.end() && it->first == uid && it->second;
+        });
+    }
+
+    this->relink(_nodes.data(), _parents.data(), _nodes.size());
+    _serial = h.serial;
+    _pause = h.pause != 0;
+    for(auto& t : _created) { this->notifyInsert(t); }
+    _routeDirty = true;
+    onRestoreTree();
+    return result;
+}
+
 template<class T> void TaskTree<T>::deliverMessage()
 {
-    // broadcast from msg,target
-    for(auto& msg : _broadcastMessage)
+    GOBLIB_TRACE_SCOPE("TaskTree::deliverMessage");
+    _lastDropped = _dropped.exchange(0, std::memory_order_relaxed);
+    _lastDroppedBroadcast = _droppedBroadcast.exchange(0, std::memory_order_relaxed);
+
+    // Messages posted while delivering are delivered on next pump.
+    TaskMessage msg;
+
+    // broadcast from msg,target (All broadcast messages are delivered in one pass)
+    _pending.clear();
+    for(std::size_t n = _broadcastMessage.size(); n && _broadcastMessage.pop(msg); --n)
+    {
+        _pending.push_back(msg);
+    }
+    if(!_pending.empty())
     {
-        typename FamilyTree<T>::Callback f = [&msg](T* t)
+        if(!_subscription.empty()) { routePending(); }
+        else if(_pending.size() == 1)
         {
-            t->onReceive(msg);
-        };
-        this->callback(f, static_cast<T*>(msg.target));
+            auto& m = _pending.front();
+            this->visit_subtree([&m](T* t){ t->onReceive(m); }, static_cast<T*>(m.target));
+        }
+        else
+        {
+            _targets.clear();
+            for(std::size_t i = 0; i < _pending.size(); ++i) { _targets.emplace_back(_pending[i].target, i); }
+            std::stable_sort(_targets.begin(), _targets.end(), [](const Target& a, const Target& b)
+            {
+                return std::less<const Task*>()(a.first, b.first);
+            });
+            _active.clear();
+            _unvisited = _targets.size();
+            broadcastPass(this->root());
+        }
     }
-    _broadcastMessage.clear();
 
     // with destination
-    for(auto& msg : _message)
+    for(std::size_t n = _message.size(); n && _message.pop(msg); --n)
     {
         msg.target->onReceive(msg);
     }
-    _message.clear();
+}
+
+template<class T> void TaskTree<T>::broadcastPass(T* p)
+{
+    for(; p; p = this->nextSibling(p))
+    {
+        if(_active.empty() && !_unvisited) { return; } // Nothing to deliver any more.
+
+        // Activate broadcasts to p. _active is kept in posted order.
+        auto b = std::lower_bound(_targets.begin(), _targets.end(), Target(p, 0), [](const Target& a, const Target& v)
+        {
+            return std::less<const Task*>()(a.first, v.first);
+        });
+        auto e = b;
+        for(; e != _targets.end() && e->first == p; ++e)
+        {
+            _active.insert(std::upper_bound(_active.begin(), _active.end(), e->second), e->second);
+            --_unvisited;
+        }
+
+        for(auto& idx : _active) { p->onReceive(_pending[idx]); }
+
+        T* child = this->firstChild(p);
+        if(child) { broadcastPass(child); }
+
+        // Deactivate
+        for(; b != e; ++b) { _active.erase(std::lower_bound(_active.begin(), _active.end(), b->second)); }
+    }
+}
+
+template<class T> void TaskTree<T>::buildRoutes()
+{
+    GOBLIB_TRACE_SCOPE("TaskTree::buildRoutes");
+    _routeOrder.clear();
+    _routeEnd.clear();
+    _routeIndex.clear();
+    _routes.clear();
+    _wildcard.clear();
+    _routeStack.clear();
+
+    this->visit_with_depth([this](T* t, const std::uint32_t depth)
+    {
+        const std::uint32_t o = static_cast<std::uint32_t>(_routeOrder.size());
+        // Subtrees of deeper or same depth end here.
+        while(_routeStack.size() > depth) { _routeEnd[_routeStack.back()] = o; _routeStack.pop_back(); }
+        _routeStack.push_back(o);
+        _routeOrder.push_back(t);
+        _routeEnd.push_back(o + 1);
+        _routeIndex.emplace_back(static_cast<const Task*>(t), o);
+
+        auto r = subscriptionOf(t);
+        if(r.first == r.second) { _wildcard.push_back(o); }
+        for(; r.first != r.second; ++r.first) { _routes.emplace_back(r.first->second, o); }
+    }, this->root(), 0);
+    for(auto& o : _routeStack) { _routeEnd[o] = static_cast<std::uint32_t>(_routeOrder.size()); }
+
+    std::sort(_routeIndex.begin(), _routeIndex.end(), [](const std::pair<const Task*, std::uint32_t>& a, const std::pair<const Task*, std::uint32_t>& b)
+    {
+        return std::less<const Task*>()(a.first, b.first);
+    });
+    std::sort(_routes.begin(), _routes.end());
+    _routeDirty = false;
+}
+
+template<class T> template<class F> void TaskTree<T>::forEachRoute(const std::uint32_t msg, const T* top, F&& func) const
+{
+    auto it = std::lower_bound(_routeIndex.begin(), _routeIndex.end(), static_cast<const Task*>(top), [](const std::pair<const Task*, std::uint32_t>& a, const Task* v)
+    {
+        return std::less<const Task*>()(a.first, v);
+    });
+    if(it == _routeIndex.end() || it->first != top) { return; } // Not in tree
+    const std::uint32_t head = it->second, tail = _routeEnd[head];
+
+    // Merge subscribers of msg and tasks without subscription in [head, tail) in preorder.
+    auto s = std::lower_bound(_routes.begin(), _routes.end(), Route(msg, head));
+    auto se = std::lower_bound(s, _routes.end(), Route(msg, tail));
+    auto w = std::lower_bound(_wildcard.begin(), _wildcard.end(), head);
+    auto we = std::lower_bound(w, _wildcard.end(), tail);
+    while(s != se || w != we)
+    {
+        if(w == we || (s != se && s->second < *w)) { func((s++)->second); }
+        else { func(*w++); }
+    }
+}
+
+// Each task receives in posted order, tasks in preorder.
+template<class T> void TaskTree<T>::routePending()
+{
+    if(_routeDirty) { buildRoutes(); }
+    _events.clear();
+    for(std::size_t i = 0; i < _pending.size(); ++i)
+    {
+        const std::uint32_t pi = static_cast<std::uint32_t>(i);
+        forEachRoute(_pending[i].msg, static_cast<const T*>(_pending[i].target), [this, pi](const std::uint32_t o)
+        {
+            _events.push_back(Event{ o, pi, _routeOrder[o] });
+        });
+    }
+    if(_pending.size() > 1)
+    {
+        std::sort(_events.begin(), _events.end(), [](const Event& a, const Event& b)
+        {
+            return a.order < b.order || (a.order == b.order && a.pending < b.pending);
+        });
+    }
+    ++_routing;
+    for(auto& e : _events) { e.task->onReceive(_pending[e.pending]); }
+    --_routing;
+}
+
+template<class T> void TaskTree<T>::routeBroadcast(const TaskMessage& m, const T* top)
+{
+    if(_routeDirty) { buildRoutes(); }
+    ++_routing;
+    forEachRoute(m.msg, top, [this, &m](const std::uint32_t o) { _routeOrder[o]->onReceive(m); });
+    --_routing;
 }
 
 template<class T> void TaskTree<T>::print()
@@ -325,7 +848,7 @@ template<class T> void TaskTree<T>::print()
         printf("%*c[%12s]:%08x,%-5d\n", depth*4, ' ', c->tag(), c->status(), c->priority());
     };
     printf("TaskTree pause:%d size:%zu\n", _pause, this->size());
-    this->callback_with_depth(print_func);
+    this->visit_with_depth(print_func);
 }
 
 //
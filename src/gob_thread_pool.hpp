@@ -0,0 +1,197 @@
+/*!
+  Goblin Library
+
+  @file  gob_thread_pool.hpp
+  @brief Work-stealing thread pool for parallel-for.
+  @note Header only, so environments without std::thread are not affected unless included.
+*/
+#pragma once
+#ifndef GOBLIB_THREAD_POOL_HPP
+#define GOBLIB_THREAD_POOL_HPP
+
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <cassert>
+
+namespace goblib
+{
+
+/*!
+  @brief Work-stealing thread pool
+  @details run(jobs, func) calls func(index) for each index in [0, jobs) and blocks until all done.<br>
+  Indices are split into a range per thread. Each thread takes from front of own range,
+  and steals from back of the others when own range is empty. Caller thread also works as thread 0.
+*/
+class ThreadPool
+{
+  public:
+    /*!
+      @param threads Number of threads include caller. Less than or equal 1 is serial execution.
+    */
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency())
+            : _slot(new Slot[threads > 1 ? threads : 1]), _slots(threads > 1 ? threads : 1), _threads()
+            , _mutex(), _wake(), _done(), _generation(0), _remaining(0), _stop(false)
+            , _invoke(nullptr), _context(nullptr)
+    {
+        for(std::size_t i = 1; i < _slots; ++i) { _threads.emplace_back(&ThreadPool::worker, this, i); }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for(auto& th : _threads) { th.join(); }
+    }
+
+    /*! @brief Number of threads include caller */
+    GOBLIB_INLINE std::size_t threads() const { return _slots; }
+
+    /*!
+      @brief Call func(index) for index [0, jobs) on pool.
+      @warning Do not call run() from func.
+    */
+    template<class F> void run(const std::size_t jobs, F&& func)
+    {
+        if(!jobs) { return; }
+        if(_slots == 1 || jobs == 1)
+        {
+            for(std::size_t i = 0; i < jobs; ++i) { func(i); }
+            return;
+        }
+        assert(jobs <= UINT32_MAX && "Too many jobs");
+
+        using Func = typename std::remove_reference<F>::type;
+        _invoke = [](void* ctx, std::size_t idx) { (*static_cast<Func*>(ctx))(idx); };
+        _context = const_cast<void*>(static_cast<const void*>(&func));
+
+        // Split range to slots. (Publish _invoke, _context and _remaining by release)
+        _remaining.store(jobs, std::memory_order_relaxed);
+        std::size_t per = jobs / _slots, rem = jobs % _slots, b = 0;
+        for(std::size_t i = 0; i < _slots; ++i)
+        {
+            std::size_t e = b + per + (i < rem ? 1 : 0);
+            _slot[i].range.store(pack(b, e), std::memory_order_release);
+            b = e;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_generation;
+        }
+        _wake.notify_all();
+
+        work(0);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+  private:
+    // begin (upper 32bit) and end (lower 32bit) of job index range.
+    struct Slot
+    {
+        std::atomic<std::uint64_t> range;
+        Slot() : range(0) {}
+        // Avoid false sharing
+        char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+    };
+
+    GOBLIB_INLINE static std::uint64_t pack(std::size_t b, std::size_t e) { return (static_cast<std::uint64_t>(b) << 32) | e; }
+
+    // Take job from front of own slot.
+    bool pop(const std::size_t s, std::size_t& idx)
+    {
+        auto& r = _slot[s].range;
+        std::uint64_t v = r.load(std::memory_order_acquire);
+        while((v >> 32) < (v & 0xFFFFFFFFU))
+        {
+            if(r.compare_exchange_weak(v, v + (static_cast<std::uint64_t>(1) << 32), std::memory_order_acq_rel))
+            {
+                idx = static_cast<std::size_t>(v >> 32);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Take job from back of other slot.
+    bool steal(const std::size_t s, std::size_t& idx)
+    {
+        auto& r = _slot[s].range;
+        std::uint64_t v = r.load(std::memory_order_acquire);
+        while((v >> 32) < (v & 0xFFFFFFFFU))
+        {
+            if(r.compare_exchange_weak(v, v - 1, std::memory_order_acq_rel))
+            {
+                idx = static_cast<std::size_t>((v & 0xFFFFFFFFU) - 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(const std::size_t self)
+    {
+        std::size_t idx;
+        for(;;)
+        {
+            bool got = pop(self, idx);
+            for(std::size_t i = 1; !got && i < _slots; ++i) { got = steal((self + i) % _slots, idx); }
+            if(!got) { return; }
+
+            _invoke(_context, idx);
+            if(_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _done.notify_all();
+            }
+        }
+    }
+
+    void worker(const std::size_t self)
+    {
+        std::uint64_t seen = 0;
+        for(;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this, seen] { return _stop || _generation != seen; });
+                if(_stop) { return; }
+                seen = _generation;
+            }
+            work(self);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+  private:
+    std::unique_ptr<Slot[]> _slot;
+    std::size_t _slots;
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake;  // Signal to workers for new jobs.
+    std::condition_variable _done;  // Signal to caller for all jobs done.
+    std::uint64_t _generation;      // Incremented each run (guarded by _mutex).
+    std::atomic<std::size_t> _remaining;
+    bool _stop;
+    void (*_invoke)(void*, std::size_t);
+    void* _context;
+};
+
+//
+}
+#endif
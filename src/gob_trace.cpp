@@ -0,0 +1,123 @@
+/*!
+  Goblin Library
+
+  @file   gob_trace.cpp
+  @brief  Trace recorder that exports Chrome Trace Event JSON.
+*/
+#if defined(GOBLIB_ENABLE_PROFILE)
+
+#include "gob_trace.hpp"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace goblib { namespace profile {
+
+constexpr std::size_t TraceEvent::NAME_SIZE;
+constexpr std::size_t TraceRecorder::DEFAULT_CAPACITY;
+
+TraceRecorder& TraceRecorder::instance()
+{
+    static TraceRecorder r;
+    return r;
+}
+
+std::uint32_t TraceRecorder::threadId()
+{
+    static std::atomic<std::uint32_t> counter(0);
+    static thread_local std::uint32_t id = counter.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void TraceRecorder::start(const std::size_t capacity)
+{
+    stop();
+    if(capacity != _capacity)
+    {
+        _events.reset(capacity ? new TraceEvent[capacity] : nullptr);
+        _capacity = capacity;
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _recording.store(_capacity > 0, std::memory_order_release);
+}
+
+void TraceRecorder::complete(const char* name, const std::uint64_t start, const std::uint64_t end)
+{
+    if(!recording()) { return; }
+    std::size_t i = _count.fetch_add(1, std::memory_order_relaxed);
+    if(i >= _capacity) { return; }
+
+    TraceEvent& e = _events[i];
+    std::strncpy(e.name, name ? name : "", TraceEvent::NAME_SIZE);
+    e.name[TraceEvent::NAME_SIZE - 1] = '\0';
+    e.ts = start;
+    e.dur = end > start ? end - start : 0;
+    e.tid = threadId();
+}
+
+std::size_t TraceRecorder::size() const
+{
+    return std::min(_count.load(std::memory_order_acquire), _capacity);
+}
+
+std::size_t TraceRecorder::dropped() const
+{
+    std::size_t c = _count.load(std::memory_order_acquire);
+    return c > _capacity ? c - _capacity : 0;
+}
+
+void TraceRecorder::write(const Sink& sink) const
+{
+    const std::size_t sz = size();
+    std::uint64_t base = ~0ULL;
+    for(std::size_t i = 0; i < sz; ++i) { base = std::min(base, _events[i].ts); }
+
+    const char head[] = "{\"traceEvents\":[";
+    sink(head, sizeof(head) - 1);
+    char tmp[TraceEvent::NAME_SIZE * 2 + 128];
+    for(std::size_t i = 0; i < sz; ++i)
+    {
+        const TraceEvent& e = _events[i];
+        // Escape name
+        char name[TraceEvent::NAME_SIZE * 2];
+        char* d = name;
+        for(const char* s = e.name; *s; ++s)
+        {
+            char c = *s;
+            if(c == '"' || c == '\\') { *d++ = '\\'; *d++ = c; }
+            else if(static_cast<unsigned char>(c) >= 0x20) { *d++ = c; }
+        }
+        *d = '\0';
+
+        // Microseconds with nanoseconds fraction.
+        std::uint64_t ts = e.ts - base;
+        int len = std::snprintf(tmp, sizeof(tmp),
+                                "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%llu.%03u}",
+                                i ? "," : "", name, e.tid,
+                                static_cast<unsigned long long>(ts / 1000), static_cast<unsigned>(ts % 1000),
+                                static_cast<unsigned long long>(e.dur / 1000), static_cast<unsigned>(e.dur % 1000));
+        if(len > 0) { sink(tmp, std::min(static_cast<std::size_t>(len), sizeof(tmp) - 1)); }
+    }
+    const char tail[] = "],\"displayTimeUnit\":\"ns\"}";
+    sink(tail, sizeof(tail) - 1);
+}
+
+std::size_t TraceRecorder::write(char* buf, const std::size_t len) const
+{
+    std::size_t total = 0;
+    write([buf, len, &total](const char* s, std::size_t n)
+    {
+        if(total + 1 < len)
+        {
+            std::size_t c = std::min(n, len - 1 - total);
+            std::memcpy(buf + total, s, c);
+        }
+        total += n;
+    });
+    if(len) { buf[std::min(total, len - 1)] = '\0'; }
+    return total;
+}
+
+//
+}}
+#endif
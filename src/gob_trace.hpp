@@ -0,0 +1,136 @@
+/*!
+  Goblin Library
+
+  @file   gob_trace.hpp
+  @brief  Trace recorder that exports Chrome Trace Event JSON.
+  @attention To use them, you need to define GOBLIB_ENABLE_PROFILE.
+*/
+#pragma once
+#ifndef GOBLIB_TRACE_HPP
+#define GOBLIB_TRACE_HPP
+
+#if defined(GOBLIB_ENABLE_PROFILE)
+
+#include "gob_macro.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <functional>
+
+namespace goblib { namespace profile {
+
+/*! @brief Complete event (Time is nanoseconds of std::chrono::steady_clock) */
+struct TraceEvent
+{
+    constexpr static std::size_t NAME_SIZE = 32;
+    char name[NAME_SIZE];   //!< Copied, so the source need not be alive at export.
+    std::uint64_t ts;       //!< Start
+    std::uint64_t dur;      //!< Duration
+    std::uint32_t tid;      //!< Thread id (Assigned by TraceRecorder::threadId)
+};
+
+/*!
+  @brief Records scope events of all threads into fixed buffer.
+  @details Events are recorded only while recording (between start() and stop()).
+  Recording is lock-free (a slot is reserved by fetch_add), and events after the buffer is full are dropped.<br>
+  Export as Chrome Trace Event JSON that can be opened by chrome://tracing or Perfetto UI.
+  @warning Export and start() after stop() and scopes of other threads are finished.
+  @attention To use them, you need to define GOBLIB_ENABLE_PROFILE.
+*/
+class TraceRecorder
+{
+  public:
+    constexpr static std::size_t DEFAULT_CAPACITY = 16 * 1024;
+    /*! @brief Output function for export (data, length) */
+    using Sink = std::function<void(const char*, std::size_t)>;
+
+    static TraceRecorder& instance();
+
+    /// @name Recording
+    /// @{
+    /*! @brief Clear events and start recording. (Buffer is allocated if capacity changed) */
+    void start(const std::size_t capacity = DEFAULT_CAPACITY);
+    GOBLIB_INLINE void stop() { _recording.store(false, std::memory_order_release); }
+    GOBLIB_INLINE bool recording() const { return _recording.load(std::memory_order_relaxed); }
+
+    /*! @brief Record complete event */
+    void complete(const char* name, const std::uint64_t start, const std::uint64_t end);
+    /// @}
+
+    /// @name Property
+    /// @{
+    /*! @brief Number of recorded events */
+    std::size_t size() const;
+    GOBLIB_INLINE std::size_t capacity() const { return _capacity; }
+    /*! @brief Number of dropped events by full buffer */
+    std::size_t dropped() const;
+    GOBLIB_INLINE const TraceEvent& operator[](const std::size_t i) const { return _events[i]; }
+    /// @}
+
+    /// @name Export
+    /// @{
+    /*! @brief Write JSON to sink */
+    void write(const Sink& sink) const;
+    /*!
+      @brief Write JSON to memory buffer
+      @return Length of JSON. (Output is truncated if greater than or equal to len. Null-terminated if len > 0)
+    */
+    std::size_t write(char* buf, const std::size_t len) const;
+    /// @}
+
+    /// @name Time
+    /// @{
+    GOBLIB_INLINE static std::uint64_t now()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    /*! @brief Small id of this thread (Assigned on first use) */
+    static std::uint32_t threadId();
+    /// @}
+
+  private:
+    TraceRecorder() : _events(), _capacity(0), _count(0), _recording(false) {}
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  private:
+    std::unique_ptr<TraceEvent[]> _events;
+    std::size_t _capacity;
+    std::atomic<std::size_t> _count; // Reserved slots (May exceed capacity)
+    std::atomic<bool> _recording;
+};
+
+/*! @brief Record a complete event while alive (If recording at construct) */
+class TraceScope
+{
+  public:
+    explicit TraceScope(const char* name)
+            : _name(name), _start(TraceRecorder::instance().recording() ? TraceRecorder::now() : 0) {}
+    ~TraceScope()
+    {
+        if(_start) { TraceRecorder::instance().complete(_name, _start, TraceRecorder::now()); }
+    }
+
+  private:
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    const char* _name;
+    std::uint64_t _start;
+};
+
+/*! Trace scope. name is const char* (need not be literal) */
+#define GOBLIB_TRACE_SCOPE(name) goblib::profile::TraceScope GOBLIB_CONCAT(tr_,__LINE__)((name))
+
+//
+}}
+
+#else // defined(GOBLIB_ENABLE_PROFILE)
+
+#define GOBLIB_TRACE_SCOPE(name) /* Nop */
+
+#endif // defined(GOBLIB_ENABLE_PROFILE)
+#endif
@@ -11,6 +11,9 @@
 #include <cstdint>
 #include <type_traits> // std::std::is_same
 #include <functional> // std::function
+#include <utility> // std::forward
+#include <vector>
+#include <algorithm> // std::sort
 #include <cassert>
 
 #include "gob_macro.hpp"
@@ -74,6 +77,8 @@ struct Node
   @brief left-child, right-sibling representation of tree
   @tparam T type of node.
   @remark Also known as doubly chained tree, child-sibling representation, filial-heir chain.
+  @note Siblings are ordered by T < T. Siblings that are equivalent are ordered by insertion.
+  (A newly inserted node follows its equivalents, reserved nodes are in order of reservation)
 */
 template<class T> class FamilyTree
 {
@@ -81,7 +86,7 @@ template<class T> class FamilyTree
     static_assert(std::is_base_of<Node, T>::value ,"T must be derived from Node");
     static_assert(goblib::template_helper::can_determine_less<T>::value, "Cannot compare T < T ");
 
-    FamilyTree() : _root(), _reserve(nullptr) {}
+    FamilyTree() : _root(), _reserve(nullptr), _reserveTail(nullptr), _size(0), _reserved(0) {}
     virtual ~FamilyTree(){}
 
     /// @name Function type
@@ -102,28 +107,12 @@ template<class T> class FamilyTree
     GOBLIB_INLINE T* root() { return const_cast<T*>( static_cast<const FamilyTree&>(*this).root()); }
 
     /*! @brief Number of registered (exclude root) */
-    std::size_t size() const
-    {
-        T* top = static_cast<T*>(root()->_left);
-        std::size_t sz = 0;
-        if(top)
-        {
-            ConstCallback f = [&sz](const T*){ ++sz; };
-            callback(f, top);
-        }
-        return sz;
-    }
+    GOBLIB_INLINE std::size_t size() const { return _size; }
     /*! @brief Empry? */
     GOBLIB_INLINE bool empty() const { return root()->_left ? false : true; }
     
     /*! @brief Number of reserved for register */
-    std::size_t reservedNodes() const
-    {
-        std::size_t sz = 0;
-        auto p = _reserve;
-        while(p) { ++sz; p = static_cast<T*>(p->_right); }
-        return sz;
-    }
+    GOBLIB_INLINE std::size_t reservedNodes() const { return _reserved; }
     /// @}
 
     /// @name Callback
@@ -149,13 +138,33 @@ template<class T> class FamilyTree
     void callback(Callback func, U* start) const
     {
         static_assert(goblib::template_helper::is_callable<decltype(func), T*>::value, "func isnot callable.");
-        T* p = static_cast<T*>(start);
-        while(p)
-        {
-            func(p);
-            if(p->_left) { callback(func, static_cast<T*>(p->_left)); }
-            p = static_cast<T*>(p->_right);
-        }
+        visit(func, start);
+    }
+    /// @}
+
+    /// @name Visit
+    /// @brief Same order as callback(), but the functor is inlined and no std::function is constructed.
+    /// @note Traversal uses an explicit stack on the call stack, falling back to recursion only if it is exhausted.
+    /// @{
+    template<class F> GOBLIB_INLINE void visit(F&& func) { visit(std::forward<F>(func), root()); }
+    template<class F> GOBLIB_INLINE void visit(F&& func) const { visit(std::forward<F>(func), const_cast<T*>(root())); }
+
+    /*! @brief Visit start, siblings of start and their descendants */
+    template<class F, class U, typename std::enable_if<std::is_base_of<T, U>::value, std::nullptr_t>::type = nullptr>
+    void visit(F&& func, U* start) const
+    {
+        static_assert(goblib::template_helper::is_callable<F, T*>::value, "func isnot callable.");
+        auto f = [&func](T* p, const std::uint32_t) { func(p); };
+        _visit(f, static_cast<T*>(start), 0);
+    }
+
+    /*! @brief Visit top and its descendants (Siblings of top are not visited) */
+    template<class F, class U, typename std::enable_if<std::is_base_of<T, U>::value, std::nullptr_t>::type = nullptr>
+    void visit_subtree(F&& func, U* top) const
+    {
+        static_assert(goblib::template_helper::is_callable<F, T*>::value, "func isnot callable.");
+        func(static_cast<T*>(top));
+        if(top->_left) { visit(func, static_cast<T*>(top->_left)); }
     }
     /// @}
 
@@ -165,18 +174,27 @@ template<class T> class FamilyTree
       @brief Clear
       @attention Memory of nodes does not deallocate. 
     */
-    GOBLIB_INLINE void clear() { _root._left = _root._right = nullptr; }
+    GOBLIB_INLINE void clear() { _root._left = _root._right = nullptr; _size = 0; }
 
     /*! @brief Insert node */
     void insertNode(T* node, T* parent = nullptr);
     /*! @brief Remove node
       @attention Memory of node does not deallocate. 
     */
-    void removeNode(T* node) { removeNode(node, root()); }
+    void removeNode(T* node) { remove_if([node](const T* p) { return node == p; }); }
     /*! @brief Remove nodes if match condition
       @attention Memory of nodes does not deallocate. 
     */
-    GOBLIB_INLINE void removeNode_if(Compare func) {removeNode_if(func, root()); }
+    GOBLIB_INLINE void removeNode_if(Compare func) { remove_if(func); }
+    /*! @brief Remove nodes if match condition (Functor is inlined)
+      @attention Memory of nodes does not deallocate. 
+      @note Root is never removed.
+    */
+    template<class F> void remove_if(F&& func)
+    {
+        static_assert(goblib::template_helper::is_callable<F, T*>::value, "func isnot callable.");
+        root()->_left = _remove_if(func, static_cast<T*>(root()->_left));
+    }
 
     /*! @brief Does node exists in tree? */
     bool exists(T* node) { return exists(node, root()); }
@@ -185,7 +203,11 @@ template<class T> class FamilyTree
 
     /*! @brief Reserve node registration */
     void reserveInsertNode(T* node, T* parent = nullptr);
-    /*! @brief Insert nodes from nodes reserved */
+    /*!
+      @brief Insert nodes from nodes reserved
+      @details Reservations are grouped by parent, and each group is merged into the siblings at once.
+      onChain/onInsertNode are called in order of reservation after all groups are linked.
+    */
     void insertReservedNodes();
     /// @}
 
@@ -193,15 +215,36 @@ template<class T> class FamilyTree
     virtual void onInsertNode(T*) {}
     virtual void onRemoveNode(T*) {}
     
+    /// @name Link
+    /// @{
+    /*! @brief First child of node */
+    GOBLIB_INLINE static T* firstChild(const T* node) { return static_cast<T*>(node->_left); }
+    /*! @brief Next sibling of node */
+    GOBLIB_INLINE static T* nextSibling(const T* node) { return static_cast<T*>(node->_right); }
+    /// @}
+
+    /*! @brief Stable sort of sibling chain (natural merge sort) */
     T* sort(T* head);
-    void _sort(T* node, T*& sorted);
+    /*! @brief Stable merge of sorted sibling chains. a precedes b if equal. */
+    T* merge(T* a, T* b) { return _merge(a, b, [](T*){}); }
 
     T* removeNode(T* node, T* ptr)
     {
-        Compare f = [&node](T* p) { return node == p; };
-        return removeNode_if(f, ptr);
+        return _remove_if([node](const T* p) { return node == p; }, ptr);
     }
-    T* removeNode_if(Compare func, T* ptr);
+    T* removeNode_if(Compare func, T* ptr) { return _remove_if(func, ptr); }
+
+    /*!
+      @brief Relink all nodes in tree
+      @details nodes[i] becomes the last child of nodes[parents[i]] (root if parents[i] < 0). onChain/onInsertNode are not called.
+      @param nodes Nodes in preorder. Siblings must be in sorted order.
+      @param parents Index of parent in nodes (Must be less than own index)
+      @param n Number of nodes
+      @attention Nodes in tree that are not in nodes are unlinked without onRemoveNode.
+    */
+    void relink(T* const* nodes, const std::int32_t* parents, const std::size_t n);
+    /*! @brief Call onChain and onInsertNode of node linked by relink */
+    GOBLIB_INLINE void notifyInsert(T* node) { node->onChain(); onInsertNode(node); }
 
     /// @name Callback with depth
     /// @{
@@ -214,19 +257,41 @@ template<class T> class FamilyTree
     void callback_with_depth(CallbackWithDepth func, T* start = nullptr, std::uint32_t depth = 0) const
     {
         static_assert(goblib::template_helper::is_callable<decltype(func), T*, const std::uint32_t>::value, "func isnot callable.");
-        T* p = static_cast<T*>(start ? start : root()->_left);
-        while(p)
-        {
-            func(p, depth);
-            if(p->_left) { callback_with_depth(func, static_cast<T*>(p->_left), depth + 1); }
-            p = static_cast<T*>(p->_right);
-        }
+        visit_with_depth(func, start, depth);
+    }
+
+    /*! @brief Same as callback_with_depth, but the functor is inlined */
+    template<class F> void visit_with_depth(F&& func, T* start = nullptr, const std::uint32_t depth = 0) const
+    {
+        static_assert(goblib::template_helper::is_callable<F, T*, const std::uint32_t>::value, "func isnot callable.");
+        _visit(func, static_cast<T*>(start ? start : root()->_left), depth);
     }
     /// @}
 
+    /*! @brief Depth of the explicit stack used by visit */
+    constexpr static std::size_t VISIT_STACK_DEPTH = 16;
+
+    template<class F> void _visit(F& func, T* start, std::uint32_t depth) const;
+    template<class F> T* _remove_if(F&& func, T* head);
+    template<class F> T* _merge(T* a, T* b, F&& func);
+    static T* _cutRun(T* head);
+
   private:
+    // Reserved node and its parent. (Work of insertReservedNodes)
+    struct Reserved
+    {
+        Node* parent;
+        T* node;
+        std::uint32_t order; // Order of reservation
+        std::uint32_t group; // Order of the first reservation for the parent
+    };
+
     T _root;        //!< Root is a persistent object and has no siblibng.
     T* _reserve;    //!< left is parent, right is next reserved node.
+    T* _reserveTail;        //!< Tail of _reserve.
+    std::size_t _size;      //!< Number of nodes in tree (exclude root).
+    std::size_t _reserved;  //!< Number of nodes in _reserve.
+    std::vector<Reserved> _work; //!< Reused by insertReservedNodes. (Not shrunk)
 };
 
 template<class T> void FamilyTree<T>::insertNode(T* node, T* parent)
@@ -237,15 +302,9 @@ template<class T> void FamilyTree<T>::insertNode(T* node, T* parent)
 
     if(!parent) { parent = root(); }
 
-    if(parent->_left)
-    {
-        node->_right = parent->_left;
-        parent->_left = sort(node);
-    }
-    else
-    {
-        parent->_left = node;
-    }
+    node->_right = nullptr;
+    parent->_left = merge(static_cast<T*>(parent->_left), node);
+    ++_size;
 
     node->onChain();
     onInsertNode(node);
@@ -258,67 +317,183 @@ template<class T> void FamilyTree<T>::reserveInsertNode(T* node, T* parent)
     // node->_left is node's parent(Temporarily stored) (=>*1)
     node->_left = parent ? parent : root();
     node->_right = nullptr;
+    ++_reserved;
 
     if(!_reserve)
     {
-        _reserve = node;
+        _reserve = _reserveTail = node;
         return;
     }
 
     // Connect to tail of _reserve right.
-    auto p = _reserve->rightTail();;
-    p->_right = node;
+    _reserveTail->_right = node;
+    _reserveTail = node;
 }
 
 template<class T> void FamilyTree<T>::insertReservedNodes()
 {
+    // Nodes reserved in onChain/onInsertNode are inserted by next loop.
     while(_reserve)
     {
-        T* next = static_cast<T*>(_reserve->_right);
-        T* parent = static_cast<T*>(_reserve->_left ? _reserve->_left : root()); // (=>*1)
+        T* p = _reserve;
+        _reserve = _reserveTail = nullptr;
+        _reserved = 0;
+
+        // Use _work from base, because onChain/onInsertNode may call this again.
+        const std::size_t base = _work.size();
+        bool single = true; // All reservations for the same parent?
+        for(std::uint32_t i = 0; p; ++i)
+        {
+            Node* parent = p->_left ? p->_left : root(); // (=>*1)
+            single = single && (_work.size() == base || _work[base].parent == parent);
+            _work.push_back({ parent, p, i, i });
+            T* next = static_cast<T*>(p->_right);
+            p->_left = p->_right = nullptr; // Parent may be reserved too, so unlink all before linking.
+            p = next;
+        }
+        const auto first = _work.begin() + base;
+        const std::size_t num = _work.size() - base;
 
-        _reserve->_left = _reserve->_right = nullptr;
-        insertNode(_reserve, parent);
+        // Bucket by parent. Buckets in order of the first reservation, nodes in order of reservation.
+        if(!single)
+        {
+            std::sort(first, _work.end(), [](const Reserved& a, const Reserved& b)
+                      { return a.parent != b.parent ? std::less<Node*>()(a.parent, b.parent) : a.order < b.order; });
+            for(auto it = first + 1; it != _work.end(); ++it)
+            {
+                if(it->parent == (it - 1)->parent) { it->group = (it - 1)->group; }
+            }
+            std::sort(first, _work.end(), [](const Reserved& a, const Reserved& b)
+                      { return a.group != b.group ? a.group < b.group : a.order < b.order; });
+        }
 
-        _reserve = next;
+        // Merge each sorted bucket into siblings in a single pass.
+        for(auto it = first; it != _work.end();)
+        {
+            Node* parent = it->parent;
+            T* head = it->node;
+            T* tail = head;
+            for(++it; it != _work.end() && it->parent == parent; ++it)
+            {
+                tail->_right = it->node;
+                tail = it->node;
+            }
+            parent->_left = merge(static_cast<T*>(parent->_left), sort(head));
+        }
+        _size += num;
+
+        if(!single)
+        {
+            std::sort(first, _work.end(), [](const Reserved& a, const Reserved& b) { return a.order < b.order; });
+        }
+        // By index, _work may grow in callbacks.
+        for(std::size_t i = 0; i < num; ++i)
+        {
+            T* n = _work[base + i].node;
+            n->onChain();
+            onInsertNode(n);
+        }
+        _work.erase(_work.begin() + base, _work.end());
     }
 }
 
-template<class T> T* FamilyTree<T>::removeNode_if(Compare func, T* ptr)
+template<class T> void FamilyTree<T>::relink(T* const* nodes, const std::int32_t* parents, const std::size_t n)
 {
-    static_assert(goblib::template_helper::is_callable<decltype(func), T*>::value, "func isnot callable");
-    if(!ptr){ return nullptr; }
+    _root._left = nullptr;
+    for(std::size_t i = 0; i < n; ++i) { nodes[i]->_left = nodes[i]->_right = nullptr; }
 
-    //    if(!func(ptr))
+    // Push front in reverse order keeps the order of siblings.
+    for(std::size_t i = n; i-- > 0;)
     {
-        ptr->_left  = removeNode_if(func, static_cast<T*>(ptr->_left));
-        ptr->_right = removeNode_if(func, static_cast<T*>(ptr->_right));
-        //  return ptr;
+        assert(parents[i] < static_cast<std::int32_t>(i) && "Parent must precede child");
+        Node* parent = parents[i] < 0 ? static_cast<Node*>(root()) : nodes[parents[i]];
+        nodes[i]->_right = parent->_left;
+        parent->_left = nodes[i];
     }
-    if(!func(ptr)) { return ptr; }
+    _size = n;
+}
 
-    auto left = ptr->template left<T>();
-    auto right = ptr->template right<T>();
+template<class T> template<class F> void FamilyTree<T>::_visit(F& func, T* start, std::uint32_t depth) const
+{
+    // Siblings waiting for their elder's descendants to be visited.
+    struct Pending { T* node; std::uint32_t depth; };
+    Pending stack[VISIT_STACK_DEPTH];
+    std::size_t sp = 0;
 
-    ptr->onUnchain();
-    onRemoveNode(ptr);
+    T* p = start;
+    while(p)
+    {
+        func(p, depth);
+        T* child = static_cast<T*>(p->_left);
+        T* next = static_cast<T*>(p->_right);
+        if(child)
+        {
+            if(next)
+            {
+                // Stack exhausted (very deep tree), descend by recursion.
+                if(sp >= VISIT_STACK_DEPTH)
+                {
+                    _visit(func, child, depth + 1);
+                    p = next;
+                    continue;
+                }
+                stack[sp++] = { next, depth };
+            }
+            p = child;
+            ++depth;
+        }
+        else if(next)
+        {
+            p = next;
+        }
+        else if(sp)
+        {
+            --sp;
+            p = stack[sp].node;
+            depth = stack[sp].depth;
+        }
+        else
+        {
+            p = nullptr;
+        }
+    }
+}
 
-    // Has no children.
-    if(!left)
+template<class T> template<class F> T* FamilyTree<T>::_remove_if(F&& func, T* head)
+{
+    // Children first. Recursion depth is bounded by depth of tree, not by number of siblings.
+    for(Node* p = head; p; p = p->_right)
     {
-        return static_cast<T*>(right);
+        if(p->_left) { p->_left = _remove_if(func, static_cast<T*>(p->_left)); }
     }
-    // Has no siblings.
-    else if(!right)
+
+    // Unlink matched nodes. Their children are connected to this sibling chain.
+    Node* first = head;
+    Node** link = &first;
+    Node* promoted = nullptr;
+    Node** ptail = &promoted;
+    while(*link)
     {
-        return static_cast<T*>(left);
+        T* p = static_cast<T*>(*link);
+        if(!func(p)) { link = &p->_right; continue; }
+
+        *link = p->_right;
+        if(p->_left)
+        {
+            *ptail = p->_left;
+            ptail = &((*ptail)->rightTail()->_right);
+        }
+        p->_left = p->_right = nullptr;
+        --_size;
+
+        p->onUnchain();
+        onRemoveNode(p);
     }
 
-    // Connect child to parent's siblings.
-    T* tail = static_cast<T*>(right->rightTail());
-    tail->_right = left;
+    if(!promoted) { return static_cast<T*>(first); }
 
-    return sort(static_cast<T*>(right));
+    // Connect children to parent's siblings.
+    return merge(static_cast<T*>(first), sort(static_cast<T*>(promoted)));
 }
 
 template<class T> bool FamilyTree<T>::exists(T* node, T* start)
@@ -335,34 +510,62 @@ template<class T> bool FamilyTree<T>::exists(T* node, T* start)
 
 template<class T> T* FamilyTree<T>::sort(T* head)
 {
-    T* cur = head;
-    T* sorted = nullptr;
-    while(cur)
+    // Merge adjacent ascending runs until one run remains.
+    // A chain of k sorted chains costs O(n log k), already sorted chain costs O(n).
+    while(head && head->_right)
     {
-        T* next = static_cast<T*>(cur->_right);
-        _sort(cur, sorted);
-        cur = next;
+        Node* out = nullptr;
+        Node** otail = &out;
+        std::size_t runs = 0;
+        T* p = head;
+        while(p)
+        {
+            T* a = p;
+            p = _cutRun(a);
+            T* b = p;
+            if(b) { p = _cutRun(b); }
+            *otail = merge(a, b);
+            while(*otail) { otail = &(*otail)->_right; }
+            ++runs;
+        }
+        head = static_cast<T*>(out);
+        if(runs <= 1) { break; }
     }
-    return sorted;
+    return head;
 }
 
-template<class T> void FamilyTree<T>::_sort(T* node, T*& sorted)
+template<class T> T* FamilyTree<T>::_cutRun(T* head)
 {
-    if(!sorted || !(*sorted < *node)) // *sorted >= *node
-    {
-        node->_right = sorted;
-        sorted = node;
-    }
-    else
+    T* p = head;
+    while(p->_right && !(*static_cast<T*>(p->_right) < *p)) { p = static_cast<T*>(p->_right); }
+    T* next = static_cast<T*>(p->_right);
+    p->_right = nullptr;
+    return next;
+}
+
+template<class T> template<class F> T* FamilyTree<T>::_merge(T* a, T* b, F&& func)
+{
+    // func is called with each node taken from b.
+    Node* head = nullptr;
+    Node** tail = &head;
+    while(a && b)
     {
-        T* cur = sorted;
-        while(cur->_right &&(*(static_cast<T*>(cur->_right)) < *node))
+        if(*b < *a)
+        {
+            *tail = b;
+            func(b);
+            b = static_cast<T*>(b->_right);
+        }
+        else
         {
-            cur = static_cast<T*>(cur->_right);
+            *tail = a;
+            a = static_cast<T*>(a->_right);
         }
-        node->_right = static_cast<T*>(cur->_right);
-        cur->_right = node;
+        tail = &(*tail)->_right;
     }
+    *tail = a ? a : b;
+    while(b) { func(b); b = static_cast<T*>(b->_right); }
+    return static_cast<T*>(head);
 }
 
 //
@@ -11,6 +11,7 @@
 #include "gob_macro.hpp"
 #include "gob_math.hpp"
 #include "gob_fixed_point_number.hpp"
+#include "gob_fixed_point_math.hpp"
 #include "gob_utility.hpp"
 #include "gob_point2d.hpp"
 
@@ -21,6 +22,9 @@
 
 
 namespace goblib { namespace shape2d {
+
+template<typename T> class Vector2Array;
+
 /*!
   Vector2
   @brief 2D Vector
@@ -102,7 +106,7 @@ template<typename T> class Vector2
     /// @{
     GOBLIB_INLINE T length() const
     {
-        return std::sqrt(dot(*this));
+        return goblib::math::sqrt(dot(*this));
     }
     GOBLIB_INLINE constexpr T lengthSq() const
     {
@@ -120,7 +124,7 @@ template<typename T> class Vector2
 
     GOBLIB_INLINE GOBLIB_CONSTEXPR_GCC T angle() const
     {
-        return std::atan2(_y, _x);
+        return goblib::math::atan2(_y, _x);
     }
     GOBLIB_INLINE T angle(const Vector2<T>& v) const
     {
@@ -170,12 +174,12 @@ template<typename T> class Vector2
     GOBLIB_INLINE void truncate(const T len)
     {
         auto a = angle();
-        _x = len * std::cos(a);
-        _y = len * std::sin(a);
+        _x = len * goblib::math::cos(a);
+        _y = len * goblib::math::sin(a);
     }
     GOBLIB_INLINE constexpr Vector2<T> truncateV(const T len) const
     {
-        return Vector2<T>(len * std::cos(angle()), len * std::sin(angle()));
+        return Vector2<T>(len * goblib::math::cos(angle()), len * goblib::math::sin(angle()));
     }
     
     GOBLIB_INLINE void clamp(const T minl, const T maxl)
@@ -283,6 +287,7 @@ template<typename T> class Vector2
     static const Vector2<T> ZERO_VECTOR;
     
   private:
+    friend class Vector2Array<T>;
     T _x, _y;
     constexpr static T VECTOR2_EPSILON = std::numeric_limits<T>::epsilon();
 };
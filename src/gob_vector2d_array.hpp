@@ -0,0 +1,472 @@
+/*!
+  Goblin Library
+
+  @file   gob_vector2d_array.hpp
+  @brief  Structure-of-arrays container of 2D vectors with batch operations.
+*/
+#pragma once
+#ifndef GOBLIB_VECTOR2D_ARRAY_HPP
+#define GOBLIB_VECTOR2D_ARRAY_HPP
+
+#include "gob_macro.hpp"
+#include "gob_fixed_point_number.hpp"
+#include "gob_fixed_point_math.hpp"
+#include "gob_utility.hpp"
+#include "gob_vector2d.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <cassert>
+
+/// @cond
+#if !defined(GOBLIB_VECTOR2_ARRAY_NO_SIMD)
+# if defined(__AVX__)
+#   define GOBLIB_VECTOR2_ARRAY_AVX
+#   include <immintrin.h>
+# elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define GOBLIB_VECTOR2_ARRAY_SSE
+#   include <xmmintrin.h>
+# elif defined(__ARM_NEON)
+#   define GOBLIB_VECTOR2_ARRAY_NEON
+#   include <arm_neon.h>
+# endif
+#endif
+/// @endcond
+
+namespace goblib { namespace shape2d {
+
+/// @cond
+namespace detail
+{
+// Scalar kernels. (Return processed count)
+template<typename T, bool SIMD> struct Vector2Kernel
+{
+    static GOBLIB_INLINE std::size_t add(T*, T*, const T*, const T*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t offset(T*, T*, const T, const T, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t scale(T*, T*, const T, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t fma(T*, T*, const T*, const T*, const T, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t dot(T*, const T*, const T*, const T*, const T*, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t distanceSq(T*, const T*, const T*, const T, const T, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t normalize(T*, T*, const T, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t resize(T*, T*, const T, const T, const T, const std::size_t) { return 0; }
+    static GOBLIB_INLINE std::size_t minimum(T&, const T*, const std::size_t) { return 0; }
+};
+
+#if defined(GOBLIB_VECTOR2_ARRAY_AVX) || defined(GOBLIB_VECTOR2_ARRAY_SSE) || defined(GOBLIB_VECTOR2_ARRAY_NEON)
+constexpr bool vector2_simd = true;
+#else
+constexpr bool vector2_simd = false;
+#endif
+
+#if defined(GOBLIB_VECTOR2_ARRAY_AVX)
+using vf32 = __m256;
+constexpr std::size_t LANES = 8;
+GOBLIB_INLINE vf32 load(const float* p) { return _mm256_loadu_ps(p); }
+GOBLIB_INLINE void store(float* p, const vf32 v) { _mm256_storeu_ps(p, v); }
+GOBLIB_INLINE vf32 splat(const float v) { return _mm256_set1_ps(v); }
+GOBLIB_INLINE vf32 add(const vf32 a, const vf32 b) { return _mm256_add_ps(a, b); }
+GOBLIB_INLINE vf32 sub(const vf32 a, const vf32 b) { return _mm256_sub_ps(a, b); }
+GOBLIB_INLINE vf32 mul(const vf32 a, const vf32 b) { return _mm256_mul_ps(a, b); }
+GOBLIB_INLINE vf32 div(const vf32 a, const vf32 b) { return _mm256_div_ps(a, b); }
+GOBLIB_INLINE vf32 sqrt(const vf32 a) { return _mm256_sqrt_ps(a); }
+GOBLIB_INLINE vf32 min(const vf32 a, const vf32 b) { return _mm256_min_ps(a, b); }
+GOBLIB_INLINE vf32 max(const vf32 a, const vf32 b) { return _mm256_max_ps(a, b); }
+GOBLIB_INLINE vf32 less(const vf32 a, const vf32 b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+GOBLIB_INLINE vf32 select(const vf32 m, const vf32 a, const vf32 b) { return _mm256_blendv_ps(b, a, m); }
+GOBLIB_INLINE float hmin(const vf32 v)
+{
+    __m128 m = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+}
+
+#elif defined(GOBLIB_VECTOR2_ARRAY_SSE)
+using vf32 = __m128;
+constexpr std::size_t LANES = 4;
+GOBLIB_INLINE vf32 load(const float* p) { return _mm_loadu_ps(p); }
+GOBLIB_INLINE void store(float* p, const vf32 v) { _mm_storeu_ps(p, v); }
+GOBLIB_INLINE vf32 splat(const float v) { return _mm_set1_ps(v); }
+GOBLIB_INLINE vf32 add(const vf32 a, const vf32 b) { return _mm_add_ps(a, b); }
+GOBLIB_INLINE vf32 sub(const vf32 a, const vf32 b) { return _mm_sub_ps(a, b); }
+GOBLIB_INLINE vf32 mul(const vf32 a, const vf32 b) { return _mm_mul_ps(a, b); }
+GOBLIB_INLINE vf32 div(const vf32 a, const vf32 b) { return _mm_div_ps(a, b); }
+GOBLIB_INLINE vf32 sqrt(const vf32 a) { return _mm_sqrt_ps(a); }
+GOBLIB_INLINE vf32 min(const vf32 a, const vf32 b) { return _mm_min_ps(a, b); }
+GOBLIB_INLINE vf32 max(const vf32 a, const vf32 b) { return _mm_max_ps(a, b); }
+GOBLIB_INLINE vf32 less(const vf32 a, const vf32 b) { return _mm_cmplt_ps(a, b); }
+GOBLIB_INLINE vf32 select(const vf32 m, const vf32 a, const vf32 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+GOBLIB_INLINE float hmin(const vf32 v)
+{
+    __m128 m = _mm_min_ps(v, _mm_movehl_ps(v, v));
+    m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+}
+
+#elif defined(GOBLIB_VECTOR2_ARRAY_NEON)
+using vf32 = float32x4_t;
+constexpr std::size_t LANES = 4;
+GOBLIB_INLINE vf32 load(const float* p) { return vld1q_f32(p); }
+GOBLIB_INLINE void store(float* p, const vf32 v) { vst1q_f32(p, v); }
+GOBLIB_INLINE vf32 splat(const float v) { return vdupq_n_f32(v); }
+GOBLIB_INLINE vf32 add(const vf32 a, const vf32 b) { return vaddq_f32(a, b); }
+GOBLIB_INLINE vf32 sub(const vf32 a, const vf32 b) { return vsubq_f32(a, b); }
+GOBLIB_INLINE vf32 mul(const vf32 a, const vf32 b) { return vmulq_f32(a, b); }
+# if defined(__aarch64__)
+GOBLIB_INLINE vf32 div(const vf32 a, const vf32 b) { return vdivq_f32(a, b); }
+GOBLIB_INLINE vf32 sqrt(const vf32 a) { return vsqrtq_f32(a); }
+GOBLIB_INLINE float hmin(const vf32 v) { return vminvq_f32(v); }
+# else
+// ARMv7 has no division and square root. (Estimate and Newton-Raphson twice)
+GOBLIB_INLINE vf32 div(const vf32 a, const vf32 b)
+{
+    vf32 r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    return vmulq_f32(a, r);
+}
+GOBLIB_INLINE vf32 sqrt(const vf32 a)
+{
+    vf32 r = vrsqrteq_f32(a);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+    return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0.0f)), a, vmulq_f32(a, r)); // sqrt(0) is 0
+}
+GOBLIB_INLINE float hmin(const vf32 v)
+{
+    float32x2_t m = vpmin_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpmin_f32(m, m), 0);
+}
+# endif
+GOBLIB_INLINE vf32 min(const vf32 a, const vf32 b) { return vminq_f32(a, b); }
+GOBLIB_INLINE vf32 max(const vf32 a, const vf32 b) { return vmaxq_f32(a, b); }
+GOBLIB_INLINE uint32x4_t less(const vf32 a, const vf32 b) { return vcltq_f32(a, b); }
+GOBLIB_INLINE vf32 select(const uint32x4_t m, const vf32 a, const vf32 b) { return vbslq_f32(m, a, b); }
+#endif
+
+#if defined(GOBLIB_VECTOR2_ARRAY_AVX) || defined(GOBLIB_VECTOR2_ARRAY_SSE) || defined(GOBLIB_VECTOR2_ARRAY_NEON)
+// SIMD kernels for float. (Same operation order as Vector2<float>)
+template<> struct Vector2Kernel<float, true>
+{
+    static std::size_t add(float* xs, float* ys, const float* bx, const float* by, const std::size_t n)
+    {
+        std::size_t i = 0;
+        for(; i + LANES <= n; i += LANES)
+        {
+            store(xs + i, detail::add(load(xs + i), load(bx + i)));
+            store(ys + i, detail::add(load(ys + i), load(by + i)));
+        }
+        return i;
+    }
+    static std::size_t offset(float* xs, float* ys, const float ox, const float oy, const std::size_t n)
+    {
+        const vf32 vx = splat(ox), vy = splat(oy);
+        std::size_t i = 0;
+        for(; i + LANES <= n; i += LANES)
+        {
+            store(xs + i, detail::add(load(xs + i), vx));
+            store(ys + i, detail::add(load(ys + i), vy));
+        }
+        return i;
+    }
+    static std::size_t scale(float* xs, float* ys, const float s, const std::size_t n)
+    {
+        const vf32 vs = splat(s);
+        std::size_t i = 0;
+        for(; i + LANES <= n; i += LANES)
+        {
+            store(xs + i, mul(load(xs + i), vs));
+            store(ys + i, mul(load(ys + i), vs));
+        }
+        return i;
+    }
+    static std::size_t fma(float* xs, float* ys, const float* bx, const float* by, const float s, const std::size_t n)
+    {
+        const vf32 vs = splat(s);
+        std::size_t i = 0;
+        for(; i + LANES <= n; i += LANES)
+        {
+            store(xs + i, detail::add(load(xs + i), mul(load(bx + i), vs)));
+            store(ys + i, detail::add(load(ys + i), mul(load(by + i), vs)));
+        }
+        return i;
+    }
+    static std::size_t dot(float* out, const float* ax, const float* ay, const float* bx, const float* by, const std::size_t n)
+    {
+        std::size_t i = 0;
+        for(; i + LANES <= n; i += LANES)
+        {
+            store(out + i, detail::add(mul(load(ax + i), load(bx + i)), mul(load(ay + i), load(by + i))));
+        }
+        return i;
+    }
+    static std::size_t distanceSq(float* out, const float* xs, const float* ys, const float px, const float py, const std::size_t n)
+    {
+        const vf32 vx = splat(px), vy = splat(py);
+        std::size_t i = 0;
+        for(; i + LANES <= n; i += LANES)
+        {
+            const vf32 dx = sub(vx, load(xs + i)), dy = sub(vy, load(ys + i));
+            store(out + i, detail::add(mul(dx, dx), mul(dy, dy)));
+        }
+        return i;
+    }
+    static std::size_t normalize(float* xs, float* ys, const float eps, const std::size_t n)
+    {
+        const vf32 veps = splat(eps), one = splat(1.0f);
+        std::size_t i = 0;
+        for(; i + LANES <= n; i += LANES)
+        {
+            const vf32 x = load(xs + i), y = load(ys + i);
+            const vf32 l = detail::sqrt(detail::add(mul(x, x), mul(y, y)));
+            const auto m = less(l, veps);
+            const vf32 inv = div(one, select(m, one, l));
+            store(xs + i, select(m, x, mul(x, inv)));
+            store(ys + i, select(m, y, mul(y, inv)));
+        }
+        return i;
+    }
+    static std::size_t resize(float* xs, float* ys, const float minl, const float maxl, const float eps, const std::size_t n)
+    {
+        const vf32 veps = splat(eps), vmin = splat(minl), vmax = splat(maxl), one = splat(1.0f), zero = splat(0.0f);
+        std::size_t i = 0;
+        for(; i + LANES <= n; i += LANES)
+        {
+            const vf32 x = load(xs + i), y = load(ys + i);
+            const vf32 l = detail::sqrt(detail::add(mul(x, x), mul(y, y)));
+            const vf32 t = detail::min(detail::max(l, vmin), vmax);
+            const auto m = less(l, veps);
+            const vf32 f = div(t, select(m, one, l));
+            store(xs + i, select(m, t, mul(x, f)));
+            store(ys + i, select(m, zero, mul(y, f)));
+        }
+        return i;
+    }
+    static std::size_t minimum(float& result, const float* v, const std::size_t n)
+    {
+        if(n < LANES) { return 0; }
+        vf32 m = load(v);
+        std::size_t i = LANES;
+        for(; i + LANES <= n; i += LANES) { m = detail::min(m, load(v + i)); }
+        result = hmin(m);
+        return i;
+    }
+};
+#endif
+//
+}
+/// @endcond
+
+/*!
+  @brief Structure-of-arrays container of Vector2
+  @details X and Y are stored in separate contiguous arrays, and the operations are applied to all elements.
+  float uses AVX, SSE or NEON if available, others use scalar operations.<br>
+  add, scale, fma, dot, lengthSq, distanceSq and normalize are computed in the same order as Vector2, so the results are identical
+  (except ARMv7 NEON, which estimates division and square root).
+  truncate and clamp scale by len / length() instead of cos/sin of angle(), so they may differ from Vector2 in the last bits.
+  @tparam T coordinate type
+  @note Define GOBLIB_VECTOR2_ARRAY_NO_SIMD to disable SIMD.
+*/
+template<typename T> class Vector2Array
+{
+    static_assert(goblib::is_fixed_point_number<T>::value || std::is_arithmetic<T>::value, "T must be arithmetic type");
+    using kernel = detail::Vector2Kernel<T, detail::vector2_simd && std::is_same<T, float>::value>;
+
+  public:
+    using pos_type = T;
+    using vector_type = Vector2<T>;
+    constexpr static std::size_t npos = ~static_cast<std::size_t>(0); //!< Not found.
+
+    /// @name Constructor
+    /// @{
+    Vector2Array() : _xs(), _ys() {}
+    explicit Vector2Array(const std::size_t n) : _xs(n, T(0)), _ys(n, T(0)) {}
+    /// @}
+
+    /// @name Property
+    /// @{
+    GOBLIB_INLINE std::size_t size() const { return _xs.size(); }
+    GOBLIB_INLINE bool empty() const { return _xs.empty(); }
+    GOBLIB_INLINE T* xs() { return _xs.data(); }
+    GOBLIB_INLINE const T* xs() const { return _xs.data(); }
+    GOBLIB_INLINE T* ys() { return _ys.data(); }
+    GOBLIB_INLINE const T* ys() const { return _ys.data(); }
+    GOBLIB_INLINE Vector2<T> operator[](const std::size_t i) const { return Vector2<T>(_xs[i], _ys[i]); }
+    /// @}
+
+    /// @name Modify
+    /// @{
+    void reserve(const std::size_t n) { _xs.reserve(n); _ys.reserve(n); }
+    void resize(const std::size_t n) { _xs.resize(n, T(0)); _ys.resize(n, T(0)); }
+    void clear() { _xs.clear(); _ys.clear(); }
+    void push_back(const Vector2<T>& v) { _xs.push_back(v.x()); _ys.push_back(v.y()); }
+    GOBLIB_INLINE void set(const std::size_t i, const Vector2<T>& v) { _xs[i] = v.x(); _ys[i] = v.y(); }
+    /// @}
+
+    /// @name Batch operation
+    /// @{
+    /*! @brief this[i] += v[i] */
+    void add(const Vector2Array<T>& v)
+    {
+        assert(v.size() == size() && "Size mismatch");
+        const std::size_t n = size();
+        T* xp = xs(); T* yp = ys();
+        for(std::size_t i = kernel::add(xp, yp, v.xs(), v.ys(), n); i < n; ++i)
+        {
+            xp[i] += v._xs[i];
+            yp[i] += v._ys[i];
+        }
+    }
+    /*! @brief this[i] += v */
+    void add(const Vector2<T>& v)
+    {
+        const std::size_t n = size();
+        T* xp = xs(); T* yp = ys();
+        const T ox = v.x(), oy = v.y();
+        for(std::size_t i = kernel::offset(xp, yp, ox, oy, n); i < n; ++i)
+        {
+            xp[i] += ox;
+            yp[i] += oy;
+        }
+    }
+    /*! @brief this[i] *= s */
+    void scale(const T s)
+    {
+        const std::size_t n = size();
+        T* xp = xs(); T* yp = ys();
+        for(std::size_t i = kernel::scale(xp, yp, s, n); i < n; ++i)
+        {
+            xp[i] *= s;
+            yp[i] *= s;
+        }
+    }
+    /*! @brief this[i] += v[i] * s (e.g. position += velocity * dt) */
+    void fma(const Vector2Array<T>& v, const T s)
+    {
+        assert(v.size() == size() && "Size mismatch");
+        const std::size_t n = size();
+        T* xp = xs(); T* yp = ys();
+        for(std::size_t i = kernel::fma(xp, yp, v.xs(), v.ys(), s, n); i < n; ++i)
+        {
+            xp[i] += v._xs[i] * s;
+            yp[i] += v._ys[i] * s;
+        }
+    }
+    /*!
+      @brief Normalize all vectors
+      @note Vectors whose length is less than VECTOR2_EPSILON are left as they are.
+    */
+    void normalize()
+    {
+        const std::size_t n = size();
+        T* xp = xs(); T* yp = ys();
+        const T eps = Vector2<T>::VECTOR2_EPSILON;
+        for(std::size_t i = kernel::normalize(xp, yp, eps, n); i < n; ++i)
+        {
+            const T l = static_cast<T>(goblib::math::sqrt((xp[i] * xp[i]) + (yp[i] * yp[i])));
+            if(l < eps) { continue; }
+            const T inv = static_cast<T>(1) / l;
+            xp[i] *= inv;
+            yp[i] *= inv;
+        }
+    }
+    /*!
+      @brief Set length of all vectors to len, keep direction
+      @note Vectors whose length is less than VECTOR2_EPSILON become (len, 0) as Vector2::truncate.
+    */
+    GOBLIB_INLINE void truncate(const T len) { resizeLength(len, len); }
+    /*! @brief Clamp length of all vectors to [minl, maxl] */
+    GOBLIB_INLINE void clamp(const T minl, const T maxl) { resizeLength(minl, maxl); }
+    /// @}
+
+    /// @name Batch calculation
+    /// @note out must have size() elements.
+    /// @{
+    /*! @brief out[i] = this[i].dot(v[i]) */
+    void dot(const Vector2Array<T>& v, T* out) const
+    {
+        assert(v.size() == size() && "Size mismatch");
+        const std::size_t n = size();
+        const T* xp = xs(); const T* yp = ys();
+        for(std::size_t i = kernel::dot(out, xp, yp, v.xs(), v.ys(), n); i < n; ++i)
+        {
+            out[i] = (xp[i] * v._xs[i]) + (yp[i] * v._ys[i]);
+        }
+    }
+    /*! @brief out[i] = this[i].lengthSq() */
+    GOBLIB_INLINE void lengthSq(T* out) const { dot(*this, out); }
+    /*! @brief out[i] = this[i].distanceSq(p) */
+    GOBLIB_INLINE void distanceSq(const Vector2<T>& p, T* out) const { distanceSqRange(p, out, 0, size()); }
+    /*!
+      @brief Index of the nearest vector from p
+      @param p Point
+      @param[out] distSq Squared distance of nearest if not nullptr
+      @retval npos Empty
+      @note Returns the lowest index if there are multiple nearest.
+    */
+    std::size_t nearest(const Vector2<T>& p, T* distSq = nullptr) const
+    {
+        constexpr std::size_t BLOCK = 256;
+        T buf[BLOCK];
+        std::size_t idx = npos;
+        T best = std::numeric_limits<T>::max();
+        for(std::size_t base = 0; base < size(); base += BLOCK)
+        {
+            const std::size_t n = std::min(BLOCK, size() - base);
+            distanceSqRange(p, buf, base, n);
+            T bmin = buf[0];
+            for(std::size_t i = kernel::minimum(bmin, buf, n); i < n; ++i) { bmin = std::min(bmin, buf[i]); }
+            if(idx != npos && !(bmin < best)) { continue; }
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                if(buf[i] == bmin) { idx = base + i; best = bmin; break; }
+            }
+        }
+        if(distSq && idx != npos) { *distSq = best; }
+        return idx;
+    }
+    /// @}
+
+  private:
+    void resizeLength(const T minl, const T maxl)
+    {
+        const std::size_t n = size();
+        T* xp = xs(); T* yp = ys();
+        const T eps = Vector2<T>::VECTOR2_EPSILON;
+        for(std::size_t i = kernel::resize(xp, yp, minl, maxl, eps, n); i < n; ++i)
+        {
+            const T l = static_cast<T>(goblib::math::sqrt((xp[i] * xp[i]) + (yp[i] * yp[i])));
+            const T t = std::min(std::max(l, minl), maxl);
+            if(l < eps)
+            {
+                xp[i] = t;
+                yp[i] = static_cast<T>(0);
+                continue;
+            }
+            const T f = t / l;
+            xp[i] *= f;
+            yp[i] *= f;
+        }
+    }
+    void distanceSqRange(const Vector2<T>& p, T* out, const std::size_t base, const std::size_t n) const
+    {
+        const T* xp = xs() + base; const T* yp = ys() + base;
+        const T px = p.x(), py = p.y();
+        for(std::size_t i = kernel::distanceSq(out, xp, yp, px, py, n); i < n; ++i)
+        {
+            const T dx = px - xp[i], dy = py - yp[i];
+            out[i] = (dx * dx) + (dy * dy);
+        }
+    }
+
+    std::vector<T> _xs, _ys;
+};
+
+template<typename T> constexpr std::size_t Vector2Array<T>::npos;
+
+//
+}}
+#endif